@@ -1,60 +1,83 @@
 #version 330 core
+// 特性由 ShaderVariants 在 #version 之后以 #define 注入 (见 Shader.h 的 ShaderFeature)
+#if defined(HAS_NORMALS) && !defined(FLAT) && !defined(WIREFRAME)
+#define VERTEX_NORMALS
+#endif
+
 out vec4 FragColor;
 
 // 从顶点着色器接收
 in vec3 FragPos;
+#ifdef VERTEX_NORMALS
 in vec3 Normal;
+#endif
 
-// 从 C++ 接收
-uniform vec3 viewPos; // 摄像机位置
-uniform vec3 lightPos; // 光源位置
-uniform bool u_hasNormals; // 原模型是否包含法线信息
-uniform vec3 lightColor; // 光源颜色
-
+// 每帧数据 (由 C++ 每帧上传一次 UBO)
+layout (std140) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection; // projection * view
+    vec4 viewPos;    // 摄像机位置
+    vec4 lightPos;   // 光源位置
+    vec4 lightColor; // 光源颜色
+};
 
+// 材质和光照参数 (编译期常量, 可以用 #define 覆盖)
+#ifndef SHININESS
+#define SHININESS 128.0
+#endif
+#ifndef AMBIENT_STRENGTH
+#define AMBIENT_STRENGTH 0.3
+#endif
+#ifndef SPECULAR_STRENGTH
+#define SPECULAR_STRENGTH 0.5
+#endif
+const vec3 objectColor = vec3(0.7, 0.7, 0.7);
+const vec3 wireframeColor = vec3(0.9, 0.9, 0.3);
 
 void main()
 {
-    vec3 norm; // 最终要使用的法线
-
+#ifdef WIREFRAME
+    FragColor = vec4(wireframeColor, 1.0);
+#else
     // ---------------------------------
     // !!          核心逻辑         !!
     // ---------------------------------
-    if (u_hasNormals)
-    {
-        // 1. 模型有法线：使用 VBO 传来的法线 (平滑着色)
-        norm = normalize(Normal);
-    }
-    else
-    {
-        // 2. 模型没有法线：自己计算 (平面着色)
-        vec3 dFdx_pos = dFdx(FragPos);
-        vec3 dFdy_pos = dFdy(FragPos);
-        norm = normalize(cross(dFdx_pos, dFdy_pos));
-    }
+#ifdef VERTEX_NORMALS
+    // 1. 模型有法线 (源文件自带或加载时生成)：使用 VBO 传来的法线 (平滑着色)
+    vec3 norm = normalize(Normal);
+#else
+    // 2. 模型没有法线 (--flat 关闭了法线生成) 或按面着色：自己计算 (平面着色)
+    vec3 norm = normalize(cross(dFdx(FragPos), dFdy(FragPos)));
+#endif
     // ---------------------------------
 
 
     //  Blinn-Phong 光照
-    vec3 objectColor = vec3(0.7, 0.7, 0.7); 
+    vec3 viewDir = normalize(viewPos.xyz - FragPos);
+#ifdef HEADLIGHT
+    // 头灯: 光线方向就是视线方向, 半程向量也相同
+    vec3 lightDir = viewDir;
+    vec3 halfwayDir = viewDir;
+#else
+    vec3 lightDir = normalize(lightPos.xyz - FragPos);
+    vec3 halfwayDir = normalize(lightDir + viewDir);
+#endif
 
     // 环境光
-    float ambientStrength = 0.3;
-    vec3 ambient = ambientStrength * lightColor;
+    vec3 ambient = AMBIENT_STRENGTH * lightColor.rgb;
 
     // 漫反射
-    vec3 lightDir = normalize(lightPos - FragPos);
     float diff = max(dot(norm, lightDir), 0.0);
-    vec3 diffuse = diff * lightColor;
+    vec3 diffuse = diff * lightColor.rgb;
 
     // 镜面反射
-    float specularStrength = 0.5;
-    vec3 viewDir = normalize(viewPos - FragPos);
-    vec3 halfwayDir = normalize(lightDir + viewDir);
-    float spec = pow(max(dot(norm, halfwayDir), 0.0), 128.0);
-    vec3 specular = specularStrength * spec * lightColor;
-    
+    float spec = pow(max(dot(norm, halfwayDir), 0.0), SHININESS);
+    vec3 specular = SPECULAR_STRENGTH * spec * lightColor.rgb;
+
     // 最终颜色
     vec3 result = (ambient + diffuse + specular) * objectColor;
     FragColor = vec4(result, 1.0);
+#endif
 }
\ No newline at end of file
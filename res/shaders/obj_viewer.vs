@@ -1,25 +1,64 @@
 #version 330 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
+// 特性由 ShaderVariants 在 #version 之后以 #define 注入 (见 Shader.h 的 ShaderFeature)
+#if defined(HAS_NORMALS) && !defined(FLAT) && !defined(WIREFRAME)
+#define VERTEX_NORMALS
+#endif
+
+layout (location = 0) in vec3 aPos;       // 压缩顶点时为包围盒内的 unorm16
+layout (location = 1) in vec3 aNormal;    // 压缩顶点时 xy 为八面体编码
 layout (location = 2) in vec2 aTexCoords;
 
+// 每实例属性 (实例化绘制, 见 InstanceData.h)
+layout (location = 3) in mat4 aModel;       // 模型矩阵, 占用 location 3..6
+layout (location = 7) in vec4 aQuantOffset; // 压缩顶点的反量化参数 (未压缩时 offset = 0, scale = 1)
+layout (location = 8) in vec4 aQuantScale;
+layout (location = 9) in mat3 aNormalMatrix; // 法线矩阵 (model的逆转置矩阵), 在 CPU 上每实例算一次, 占用 location 9..11
+
 // 输出到片元着色器
 out vec3 FragPos;
+#ifdef VERTEX_NORMALS
 out vec3 Normal;
+#endif
 // out vec2 TexCoords; //暂时不用，但先留着
 
-// MVP 矩阵
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// 每帧数据 (由 C++ 每帧上传一次 UBO)
+layout (std140) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection; // projection * view
+    vec4 viewPos;    // 摄像机位置
+    vec4 lightPos;   // 光源位置
+    vec4 lightColor; // 光源颜色
+};
+
+#ifdef OCT_NORMALS
+// 八面体法线解码 (压缩顶点)
+vec3 octDecode(vec2 e)
+{
+    vec3 v = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+    if (v.z < 0.0)
+        v.xy = (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+    return normalize(v);
+}
+#endif
 
 void main()
 {
+    // 反量化
+    vec3 position = aQuantOffset.xyz + aPos * aQuantScale.xyz;
+
     // 在世界空间中计算片元位置和法线
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    // 使用法线矩阵 (model的逆转置矩阵) 来变换法线
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    vec4 worldPos = aModel * vec4(position, 1.0);
+    FragPos = worldPos.xyz;
+#ifdef VERTEX_NORMALS
+#ifdef OCT_NORMALS
+    Normal = aNormalMatrix * octDecode(aNormal.xy);
+#else
+    Normal = aNormalMatrix * aNormal;
+#endif
+#endif
     
     // 最终的裁剪空间位置
-    gl_Position = projection * view * vec4(FragPos, 1.0);
+    gl_Position = viewProjection * worldPos;
 }
\ No newline at end of file
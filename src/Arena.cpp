@@ -0,0 +1,35 @@
+#include "Arena.h"
+#include <algorithm>
+#include <cstdint>
+
+void* Arena::allocate(size_t bytes, size_t alignment) {
+    uintptr_t aligned = ((uintptr_t)cursor + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    if (!cursor || aligned + bytes > (uintptr_t)limit) {
+        // 超出预留时块按已有总量的一半增长, 块数保持在对数级
+        newBlock(std::max({ bytes + alignment, blockBytes, reserved / 2 }));
+        aligned = ((uintptr_t)cursor + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    }
+    cursor = (char*)(aligned + bytes);
+    allocated += bytes;
+    return (void*)aligned;
+}
+
+void Arena::reserve(size_t bytes) {
+    if (cursor && (size_t)(limit - cursor) >= bytes) return;
+    newBlock(std::max(bytes, blockBytes));
+}
+
+void Arena::release() {
+    for (void* block : blocks) ::operator delete(block);
+    blocks.clear();
+    cursor = limit = nullptr;
+    allocated = reserved = 0;
+}
+
+void Arena::newBlock(size_t bytes) {
+    char* block = (char*)::operator new(bytes);
+    blocks.push_back(block);
+    cursor = block;
+    limit = block + bytes;
+    reserved += bytes;
+}
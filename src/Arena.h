@@ -0,0 +1,74 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// 单调分配器: 从大块内存中顺序切分, 单个对象不释放, release 时整体归还
+// 用于解析时的临时数组 (容量事先算准, 不会反复扩容), 一个 Arena 只在一个线程中分配
+class Arena {
+public:
+    explicit Arena(size_t blockBytes = 64 * 1024) : blockBytes(blockBytes) {}
+    ~Arena() { release(); }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // 分配 bytes 字节; 当前块放不下时新开一块 (不小于 blockBytes 和已有块总量的一半)
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+    // 保证接下来 bytes 字节 (每次分配另加对齐余量) 只占用一个块
+    void reserve(size_t bytes);
+
+    // 归还全部块
+    void release();
+
+    size_t bytesAllocated() const { return allocated; }  // 已切分出去的字节数
+    size_t bytesReserved() const { return reserved; }    // 全部块的字节数
+    size_t blockCount() const { return blocks.size(); }
+
+private:
+    std::vector<void*> blocks;
+    char* cursor = nullptr;
+    char* limit = nullptr;
+    size_t blockBytes;
+    size_t allocated = 0, reserved = 0;
+
+    void newBlock(size_t bytes);
+};
+
+// 标准容器用的分配器适配: arena 为空时退回全局 new/delete;
+// 拷贝, 移动, 交换时分配器随容器一起传递, 容器始终在创建它的 Arena 中分配
+template <typename T>
+struct ArenaAllocator {
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    Arena* arena = nullptr;
+
+    ArenaAllocator() = default;
+    ArenaAllocator(Arena* arena) : arena(arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t count) {
+        if (arena) return (T*)arena->allocate(count * sizeof(T), alignof(T));
+        return (T*)::operator new(count * sizeof(T));
+    }
+    void deallocate(T* p, size_t) {
+        if (!arena) ::operator delete(p);
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena == b.arena; }
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena != b.arena; }
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+#endif
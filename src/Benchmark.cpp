@@ -0,0 +1,455 @@
+#include "Benchmark.h"
+#include <GLFW/glfw3.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include "Scene.h"
+#include "Shader.h"
+#include "FrameUniforms.h"
+#include "SyntheticMesh.h"
+
+namespace {
+
+// GPU 计时查询的环形缓冲: 每帧读取 QUERY_RING 帧之前的结果,
+// GPU 落后不超过 QUERY_RING 帧时读取不会等待 (超过时等待, 同时限制了排队的帧数)
+const int QUERY_RING = 4;
+
+// 测拾取吞吐量的射线网格 (每个方向的射线数), 从第一帧的相机位置穿过视野
+const int PICK_RAY_GRID = 512;
+
+struct TimingStats {
+    double mean = 0.0, p50 = 0.0, p90 = 0.0, p99 = 0.0, max = 0.0;
+};
+
+struct ModelResult {
+    std::string name;
+    std::string path;
+    bool loaded = false;
+    size_t triangles = 0;
+    size_t vertices = 0;
+    double loadMs = 0.0;
+    double normalsMs = 0.0;     // 其中生成法线的时间 (源文件没有法线时)
+    TimingStats cpuMs;          // 每帧 CPU 提交时间 (裁剪 + 绘制调用)
+    TimingStats gpuMs;          // 每帧 GPU 时间 (GL_TIME_ELAPSED)
+    double wallMsPerFrame = 0.0;
+    double drawnTriangles = 0.0; // 平均每帧
+    size_t meshlets = 0;
+    double culledMeshlets = 0.0; // 平均每帧被剔除的 meshlet (视锥 + 背面)
+    double trianglesPerSecond = 0.0;    // 按墙钟时间
+    double gpuTrianglesPerSecond = 0.0; // 按 GPU 时间
+    MeshMemoryStats memory;             // 绘制前 (LOD 已上传) 的内存统计
+    double pickBvhMs = 0.0;             // 拾取 BVH 的构建时间 (后台, 不计入 loadMs)
+    double pickRaysPerSecond = 0.0;     // 最近命中查询, 多线程
+    size_t pickBvhBytes = 0;
+};
+
+// 最近秩分位数
+TimingStats computeStats(std::vector<double> samples) {
+    TimingStats stats;
+    if (samples.empty()) return stats;
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double p) {
+        size_t rank = (size_t)std::ceil(p * (double)samples.size());
+        return samples[std::min(samples.size(), std::max<size_t>(rank, 1)) - 1];
+    };
+    double sum = 0.0;
+    for (double sample : samples) sum += sample;
+    stats.mean = sum / (double)samples.size();
+    stats.p50 = percentile(0.50);
+    stats.p90 = percentile(0.90);
+    stats.p99 = percentile(0.99);
+    stats.max = samples.back();
+    return stats;
+}
+
+// 隐藏窗口的上下文: 依次尝试 EGL, 原生 (GLX/WGL), OSMesa; 每种先 4.3 再 3.3
+GLFWwindow* createHeadlessContext() {
+    bool initialized = glfwInit() != 0;
+#ifdef GLFW_PLATFORM_NULL
+    if (!initialized) {
+        // 没有 X11/Wayland 显示器 (CI 机器): GLFW 3.4 的 null 平台, 只能创建 OSMesa 上下文
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+        initialized = glfwInit() != 0;
+    }
+#endif
+    if (!initialized) return nullptr;
+
+    const int apis[] = { GLFW_EGL_CONTEXT_API, GLFW_NATIVE_CONTEXT_API, GLFW_OSMESA_CONTEXT_API };
+    const int versions[][2] = { { 4, 3 }, { 3, 3 } };
+    for (int api : apis) {
+        for (const int* version : versions) {
+            glfwDefaultWindowHints();
+            glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, api);
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, version[0]);
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, version[1]);
+            glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+            GLFWwindow* window = glfwCreateWindow(16, 16, "OBJ Viewer Benchmark", NULL, NULL);
+            if (window != NULL) return window;
+        }
+    }
+    return nullptr;
+}
+
+// 离屏渲染目标 (颜色 + 深度 renderbuffer)
+class OffscreenTarget {
+public:
+    GLuint FBO = 0, colorBuffer = 0, depthBuffer = 0;
+
+    OffscreenTarget() = default;
+    OffscreenTarget(const OffscreenTarget&) = delete;
+    OffscreenTarget& operator=(const OffscreenTarget&) = delete;
+
+    ~OffscreenTarget() {
+        if (FBO != 0) glDeleteFramebuffers(1, &FBO);
+        if (colorBuffer != 0) glDeleteRenderbuffers(1, &colorBuffer);
+        if (depthBuffer != 0) glDeleteRenderbuffers(1, &depthBuffer);
+    }
+
+    bool create(int width, int height) {
+        glGenFramebuffers(1, &FBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+
+        glGenRenderbuffers(1, &colorBuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+
+        glGenRenderbuffers(1, &depthBuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+
+        bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        return complete;
+    }
+};
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 固定的相机路径, t in [0, 1): 前半段以 20 度仰角环绕一周, 后半段推近到一半距离再拉远到两倍
+void cameraAt(float t, const glm::vec3& center, float distance, glm::vec3& position) {
+    float yaw = 0.0f;
+    if (t < 0.5f) {
+        yaw = glm::radians(360.0f) * (t / 0.5f);
+    } else {
+        float u = (t - 0.5f) / 0.5f;
+        distance *= std::exp2(-std::sin(glm::radians(360.0f) * u));
+    }
+    float pitch = glm::radians(20.0f);
+    position = center + distance * glm::vec3(std::cos(yaw) * std::cos(pitch), std::sin(pitch), std::sin(yaw) * std::cos(pitch));
+}
+
+ModelResult benchmarkModel(const std::string& name, const std::string& path, const BenchmarkOptions& options,
+                           ShaderVariants& shaders, FrameUniformBuffer& frameUniforms, const OffscreenTarget& target) {
+    ModelResult result;
+    result.name = name;
+    result.path = path;
+
+    // 加载时间包括解析和上传 (glFinish 等上传完成)
+    auto loadStart = std::chrono::steady_clock::now();
+    std::unique_ptr<Mesh> mesh = std::make_unique<Mesh>(path, options.loadOptions);
+    glFinish();
+    result.loadMs = millisecondsSince(loadStart);
+    if (!mesh->loaded) return result;
+    result.loaded = true;
+    result.triangles = mesh->indexCount / 3;
+    result.vertices = mesh->vertexCount;
+    result.normalsMs = mesh->normalsMs;
+    result.meshlets = mesh->meshlets.size();
+
+    // 相机距离: 包围球正好占满垂直视野再留一点边
+    const float fovY = glm::radians(45.0f);
+    glm::vec3 center = mesh->bounds.center();
+    float radius = std::max(glm::length(mesh->bounds.extent()) * 0.5f, 1e-4f);
+    float distance = radius / std::sin(fovY * 0.5f) * 1.1f;
+
+    Scene scene;
+    scene.meshletCulling = options.meshletCulling;
+    size_t meshId = scene.addMesh(std::move(mesh));
+    scene.addInstance(meshId, glm::mat4(1.0f));
+
+    // 开启 LOD 时等后台生成完成 (Draw 中取回), 每次运行测的都是完整的 LOD 链
+    while (scene.meshes[meshId]->lodsPending()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        scene.Draw(shaders, SHADER_HEADLIGHT, SceneView());
+    }
+    // 拾取 BVH 同样在后台构建
+    while (scene.meshes[meshId]->pickBvhPending()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        scene.Draw(shaders, SHADER_HEADLIGHT, SceneView());
+    }
+    result.memory = scene.meshes[meshId]->memoryStats();
+
+    const TriangleBvh& pickBvh = scene.meshes[meshId]->pickBvh;
+    if (!pickBvh.empty()) {
+        result.pickBvhMs = scene.meshes[meshId]->pickBvhMs;
+        result.pickBvhBytes = pickBvh.memoryBytes();
+
+        // 第一帧的视野中均匀分布的射线, 从近平面到远平面
+        glm::vec3 cameraPos;
+        cameraAt(0.0f, center, distance, cameraPos);
+        float cameraDistance = glm::length(cameraPos - center);
+        glm::mat4 view = glm::lookAt(cameraPos, center, glm::vec3(0.0f, 1.0f, 0.0f));
+        glm::mat4 projection = glm::perspective(fovY, (float)options.width / (float)options.height,
+                                                cameraDistance * 0.01f, cameraDistance + radius * 2.0f);
+        glm::mat4 toWorld = glm::inverse(projection * view);
+        std::vector<Ray> rays((size_t)PICK_RAY_GRID * PICK_RAY_GRID);
+        for (int y = 0; y < PICK_RAY_GRID; ++y) {
+            for (int x = 0; x < PICK_RAY_GRID; ++x) {
+                float ndcX = ((float)x + 0.5f) / (float)PICK_RAY_GRID * 2.0f - 1.0f;
+                float ndcY = ((float)y + 0.5f) / (float)PICK_RAY_GRID * 2.0f - 1.0f;
+                glm::vec4 nearPoint = toWorld * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+                glm::vec4 farPoint = toWorld * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+                Ray& ray = rays[(size_t)y * PICK_RAY_GRID + x];
+                ray.origin = glm::vec3(nearPoint) / nearPoint.w;
+                ray.direction = glm::vec3(farPoint) / farPoint.w - ray.origin;
+                ray.tMax = 1.0f;
+            }
+        }
+        std::vector<RayHit> hits(rays.size());
+        auto pickStart = std::chrono::steady_clock::now();
+        pickBvh.intersect(rays.data(), hits.data(), rays.size(), options.loadOptions.threads);
+        double pickMs = millisecondsSince(pickStart);
+        result.pickRaysPerSecond = pickMs > 0.0 ? (double)rays.size() / (pickMs / 1000.0) : 0.0;
+    }
+
+    GLuint queries[QUERY_RING];
+    glGenQueries(QUERY_RING, queries);
+
+    std::vector<double> cpuSamples, gpuSamples;
+    cpuSamples.reserve(options.frames);
+    gpuSamples.reserve(options.frames);
+    double drawn = 0.0, culledMeshlets = 0.0;
+    auto readQuery = [&](int frame) {
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(queries[frame % QUERY_RING], GL_QUERY_RESULT, &nanoseconds);
+        if (frame >= options.warmupFrames) gpuSamples.push_back((double)nanoseconds / 1.0e6);
+    };
+
+    int totalFrames = options.warmupFrames + options.frames;
+    auto wallStart = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < totalFrames; ++frame) {
+        bool record = frame >= options.warmupFrames;
+        if (frame == options.warmupFrames) {
+            glFinish();
+            wallStart = std::chrono::steady_clock::now();
+        }
+        if (frame >= QUERY_RING) readQuery(frame - QUERY_RING);
+
+        float t = record ? (float)(frame - options.warmupFrames) / (float)options.frames : 0.0f;
+        glm::vec3 cameraPos;
+        cameraAt(t, center, distance, cameraPos);
+        float cameraDistance = glm::length(cameraPos - center);
+        glm::mat4 view = glm::lookAt(cameraPos, center, glm::vec3(0.0f, 1.0f, 0.0f));
+        glm::mat4 projection = glm::perspective(fovY, (float)options.width / (float)options.height,
+                                                cameraDistance * 0.01f, cameraDistance + radius * 2.0f);
+
+        auto cpuStart = std::chrono::steady_clock::now();
+        glBeginQuery(GL_TIME_ELAPSED, queries[frame % QUERY_RING]);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, target.FBO);
+        glViewport(0, 0, options.width, options.height);
+        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        FrameUniforms frameData;
+        frameData.view = view;
+        frameData.projection = projection;
+        frameData.viewProjection = projection * view;
+        frameData.viewPos = glm::vec4(cameraPos, 1.0f);
+        frameData.lightPos = glm::vec4(cameraPos, 1.0f);
+        frameData.lightColor = glm::vec4(1.0f);
+        frameUniforms.update(frameData);
+
+        SceneView sceneView;
+        sceneView.viewProjection = projection * view;
+        sceneView.cameraPos = cameraPos;
+        sceneView.pixelsPerUnit = projection[1][1] * (float)options.height * 0.5f;
+        scene.Draw(shaders, SHADER_HEADLIGHT, sceneView); // 光源在摄像机位置
+
+        glEndQuery(GL_TIME_ELAPSED);
+        glFlush();
+        if (record) {
+            cpuSamples.push_back(millisecondsSince(cpuStart));
+            drawn += (double)scene.drawnTriangles;
+            culledMeshlets += (double)(scene.frustumCulledMeshlets + scene.backfaceCulledMeshlets);
+        }
+    }
+    glFinish();
+    double wallMs = millisecondsSince(wallStart);
+    for (int frame = std::max(totalFrames - QUERY_RING, 0); frame < totalFrames; ++frame) readQuery(frame);
+    glDeleteQueries(QUERY_RING, queries);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    result.cpuMs = computeStats(cpuSamples);
+    result.gpuMs = computeStats(gpuSamples);
+    result.wallMsPerFrame = options.frames > 0 ? wallMs / (double)options.frames : 0.0;
+    result.drawnTriangles = options.frames > 0 ? drawn / (double)options.frames : 0.0;
+    result.culledMeshlets = options.frames > 0 ? culledMeshlets / (double)options.frames : 0.0;
+    result.trianglesPerSecond = wallMs > 0.0 ? drawn / (wallMs / 1000.0) : 0.0;
+    double gpuTotalMs = 0.0;
+    for (double sample : gpuSamples) gpuTotalMs += sample;
+    result.gpuTrianglesPerSecond = gpuTotalMs > 0.0 ? drawn / (gpuTotalMs / 1000.0) : 0.0;
+    return result;
+}
+
+std::string jsonString(const std::string& value) {
+    std::string out = "\"";
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if ((unsigned char)c < 0x20) {
+            out += ' ';
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+void writeStats(std::ostream& out, const char* name, const TimingStats& stats) {
+    out << "      " << jsonString(name) << ": { \"mean\": " << stats.mean << ", \"p50\": " << stats.p50
+        << ", \"p90\": " << stats.p90 << ", \"p99\": " << stats.p99 << ", \"max\": " << stats.max << " },\n";
+}
+
+void writeJson(std::ostream& out, const BenchmarkOptions& options, const std::vector<ModelResult>& results,
+               const std::string& vendor, const std::string& renderer, const std::string& version) {
+    out << "{\n";
+    out << "  \"vendor\": " << jsonString(vendor) << ",\n";
+    out << "  \"renderer\": " << jsonString(renderer) << ",\n";
+    out << "  \"version\": " << jsonString(version) << ",\n";
+    out << "  \"width\": " << options.width << ",\n";
+    out << "  \"height\": " << options.height << ",\n";
+    out << "  \"frames\": " << options.frames << ",\n";
+    out << "  \"packed\": " << (options.loadOptions.packVertices ? "true" : "false") << ",\n";
+    out << "  \"meshlet_culling\": " << (options.meshletCulling ? "true" : "false") << ",\n";
+    out << "  \"host_retention\": " << jsonString(hostRetentionName(options.loadOptions.retention)) << ",\n";
+    out << "  \"models\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const ModelResult& r = results[i];
+        out << "    {\n";
+        out << "      \"name\": " << jsonString(r.name) << ",\n";
+        out << "      \"path\": " << jsonString(r.path) << ",\n";
+        out << "      \"loaded\": " << (r.loaded ? "true" : "false") << ",\n";
+        out << "      \"triangles\": " << r.triangles << ",\n";
+        out << "      \"vertices\": " << r.vertices << ",\n";
+        out << "      \"load_ms\": " << r.loadMs << ",\n";
+        out << "      \"normals_ms\": " << r.normalsMs << ",\n";
+        writeStats(out, "cpu_ms", r.cpuMs);
+        writeStats(out, "gpu_ms", r.gpuMs);
+        out << "      \"wall_ms_per_frame\": " << r.wallMsPerFrame << ",\n";
+        out << "      \"drawn_triangles_per_frame\": " << r.drawnTriangles << ",\n";
+        out << "      \"meshlets\": " << r.meshlets << ",\n";
+        out << "      \"culled_meshlets_per_frame\": " << r.culledMeshlets << ",\n";
+        out << "      \"triangles_per_second\": " << r.trianglesPerSecond << ",\n";
+        out << "      \"gpu_triangles_per_second\": " << r.gpuTrianglesPerSecond << ",\n";
+        out << "      \"host_bytes\": " << r.memory.hostBytes << ",\n";
+        out << "      \"retained_bytes\": " << r.memory.retainedBytes << ",\n";
+        out << "      \"gpu_bytes\": " << r.memory.gpuBytes << ",\n";
+        out << "      \"parse_scratch_peak_bytes\": " << r.memory.parseScratchPeakBytes << ",\n";
+        out << "      \"pick_bvh_build_ms\": " << r.pickBvhMs << ",\n";
+        out << "      \"pick_rays_per_second\": " << r.pickRaysPerSecond << ",\n";
+        out << "      \"pick_bvh_bytes\": " << r.pickBvhBytes << "\n";
+        out << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+} // namespace
+
+int runBenchmark(const BenchmarkOptions& options) {
+    GLFWwindow* window = createHeadlessContext();
+    if (window == NULL) {
+        std::cerr << "ERROR::BENCHMARK::Could not create an offscreen OpenGL context" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cerr << "ERROR::BENCHMARK::Failed to initialize GLAD" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+
+    std::string vendor = (const char*)glGetString(GL_VENDOR);
+    std::string renderer = (const char*)glGetString(GL_RENDERER);
+    std::string version = (const char*)glGetString(GL_VERSION);
+    std::cout << "Benchmark context: " << renderer << " (" << version << ")" << std::endl;
+
+    // 要测试的模型: 指定的 OBJ, 再加上生成的球面网格 (文件已存在时直接复用, 内容是确定的)
+    std::vector<std::pair<std::string, std::string>> models;
+    for (const std::string& path : options.models) {
+        models.emplace_back(std::filesystem::path(path).filename().string(), path);
+    }
+    std::filesystem::path syntheticDir = options.syntheticDir;
+    if (syntheticDir.empty()) {
+        std::error_code error;
+        syntheticDir = std::filesystem::temp_directory_path(error);
+    }
+    for (size_t triangles : options.syntheticTriangles) {
+        std::string name = "sphere_" + std::to_string(triangles) + ".obj";
+        std::string path = (syntheticDir / ("objviewer_bench_" + name)).string();
+        if (!std::filesystem::exists(path) && writeSphereObj(path, triangles) == 0) continue;
+        models.emplace_back(name, path);
+    }
+
+    int exitCode = 0;
+    {
+        glEnable(GL_DEPTH_TEST);
+        ShaderVariants shaders(options.vertexShaderPath, options.fragmentShaderPath);
+        FrameUniformBuffer frameUniforms;
+        OffscreenTarget target;
+        if (!target.create(options.width, options.height)) {
+            std::cerr << "ERROR::BENCHMARK::Offscreen framebuffer is incomplete" << std::endl;
+            exitCode = -1;
+        }
+
+        std::vector<ModelResult> results;
+        for (size_t i = 0; i < models.size() && exitCode == 0; ++i) {
+            ModelResult result = benchmarkModel(models[i].first, models[i].second, options, shaders, frameUniforms, target);
+            if (!result.loaded) {
+                std::cerr << "ERROR::BENCHMARK::Failed to load model: " << result.path << std::endl;
+                exitCode = 1;
+            } else {
+                std::cout << "  " << result.name << ": " << result.triangles << " tris, load " << result.loadMs
+                          << " ms, cpu p50 " << result.cpuMs.p50 << " ms, gpu p50 " << result.gpuMs.p50
+                          << " ms (p99 " << result.gpuMs.p99 << "), " << result.trianglesPerSecond / 1.0e6
+                          << " Mtris/s, host " << (double)result.memory.hostBytes / (1024.0 * 1024.0) << " MB, gpu "
+                          << (double)result.memory.gpuBytes / (1024.0 * 1024.0) << " MB, parse peak "
+                          << (double)result.memory.parseScratchPeakBytes / (1024.0 * 1024.0) << " MB, pick BVH "
+                          << result.pickBvhMs << " ms, " << result.pickRaysPerSecond / 1.0e6 << " Mrays/s" << std::endl;
+            }
+            results.push_back(result);
+        }
+
+        if (!options.outputPath.empty()) {
+            std::ofstream out(options.outputPath, std::ios::trunc);
+            if (out.is_open()) {
+                writeJson(out, options, results, vendor, renderer, version);
+                std::cout << "Wrote benchmark results: " << options.outputPath << std::endl;
+            } else {
+                std::cerr << "ERROR::BENCHMARK::Could not write results: " << options.outputPath << std::endl;
+                exitCode = -1;
+            }
+        } else {
+            writeJson(std::cout, options, results, vendor, renderer, version);
+        }
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return exitCode;
+}
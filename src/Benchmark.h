@@ -0,0 +1,30 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "Mesh.h"
+
+// 无窗口基准测试的参数
+struct BenchmarkOptions {
+    std::string outputPath;                 // JSON 结果, 为空时只打印
+    std::string vertexShaderPath;
+    std::string fragmentShaderPath;
+    std::vector<std::string> models;        // 依次测试的 OBJ 文件
+    std::vector<size_t> syntheticTriangles; // 另外生成的球面网格 (三角形数)
+    std::string syntheticDir;               // 生成文件的目录, 为空时用系统临时目录
+    int width = 1280;
+    int height = 720;
+    int warmupFrames = 10;
+    int frames = 240;                       // 每个模型记录的帧数
+    MeshLoadOptions loadOptions;
+    bool meshletCulling = true;             // Scene::meshletCulling
+};
+
+// 无窗口渲染到 FBO, 按固定的相机路径 (环绕一周, 再推近拉远) 逐个模型绘制,
+// 统计加载时间, 每帧 CPU/GPU 时间的分位数和三角形吞吐量.
+// 上下文优先用 GLFW 的隐藏窗口 + EGL; 没有显示器时退回 GLFW 3.4 的 null 平台 + OSMesa.
+// 返回进程退出码
+int runBenchmark(const BenchmarkOptions& options);
+#endif
@@ -0,0 +1,86 @@
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+#include <glm/glm.hpp>
+#include <cfloat>
+#include <cmath>
+
+// 轴对齐包围盒
+struct Aabb {
+    glm::vec3 min = glm::vec3(FLT_MAX);
+    glm::vec3 max = glm::vec3(-FLT_MAX);
+
+    bool valid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+    glm::vec3 center() const { return (min + max) * 0.5f; }
+    glm::vec3 extent() const { return max - min; }
+
+    void grow(const glm::vec3& p) {
+        min = glm::min(min, p);
+        max = glm::max(max, p);
+    }
+    void grow(const Aabb& b) {
+        min = glm::min(min, b.min);
+        max = glm::max(max, b.max);
+    }
+};
+
+// 变换后的包围盒 (中心 + 半边长, 用矩阵元素的绝对值展开, 不必变换 8 个角点)
+inline Aabb transformAabb(const Aabb& box, const glm::mat4& m) {
+    if (!box.valid()) return box;
+    glm::vec3 c = box.center();
+    glm::vec3 e = box.extent() * 0.5f;
+    glm::vec3 center = glm::vec3(m[3]) + glm::vec3(m[0]) * c.x + glm::vec3(m[1]) * c.y + glm::vec3(m[2]) * c.z;
+    glm::vec3 half = glm::abs(glm::vec3(m[0])) * e.x + glm::abs(glm::vec3(m[1])) * e.y + glm::abs(glm::vec3(m[2])) * e.z;
+    Aabb result;
+    result.min = center - half;
+    result.max = center + half;
+    return result;
+}
+
+enum class CullResult { Outside, Intersecting, Inside };
+
+// 视锥体: 从 (projection * view [* model]) 矩阵提取 6 个平面 (Gribb-Hartmann)
+// 传入 projection * view * model 时得到的是模型空间中的视锥体
+struct Frustum {
+    glm::vec4 planes[6]; // xyz: 法线 (指向内侧), w: 距离
+
+    Frustum() = default;
+    explicit Frustum(const glm::mat4& m) {
+        for (int axis = 0; axis < 3; ++axis) {
+            glm::vec4 row(m[0][axis], m[1][axis], m[2][axis], m[3][axis]);
+            glm::vec4 w(m[0][3], m[1][3], m[2][3], m[3][3]);
+            planes[axis * 2 + 0] = w + row;
+            planes[axis * 2 + 1] = w - row;
+        }
+        for (glm::vec4& plane : planes) {
+            float length = glm::length(glm::vec3(plane));
+            if (length > 0.0f) plane = plane / length;
+        }
+    }
+
+    // 球完全在某个平面外侧 (平面已归一化)
+    bool outside(const glm::vec3& center, float radius) const {
+        for (const glm::vec4& plane : planes) {
+            if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) return true;
+        }
+        return false;
+    }
+
+    // 包围盒与视锥体的关系: 对每个平面只测试最靠内 (p) 和最靠外 (n) 的角点
+    CullResult classify(const Aabb& box) const {
+        if (!box.valid()) return CullResult::Outside;
+        CullResult result = CullResult::Inside;
+        for (const glm::vec4& plane : planes) {
+            glm::vec3 p(plane.x >= 0.0f ? box.max.x : box.min.x,
+                        plane.y >= 0.0f ? box.max.y : box.min.y,
+                        plane.z >= 0.0f ? box.max.z : box.min.z);
+            if (glm::dot(glm::vec3(plane), p) + plane.w < 0.0f) return CullResult::Outside;
+            glm::vec3 n(plane.x >= 0.0f ? box.min.x : box.max.x,
+                        plane.y >= 0.0f ? box.min.y : box.max.y,
+                        plane.z >= 0.0f ? box.min.z : box.max.z);
+            if (glm::dot(glm::vec3(plane), n) + plane.w < 0.0f) result = CullResult::Intersecting;
+        }
+        return result;
+    }
+};
+#endif
@@ -0,0 +1,75 @@
+#include "Bvh.h"
+#include <algorithm>
+
+void Bvh::build(const std::vector<Aabb>& bounds, uint32_t maxLeafSize) {
+    nodes.clear();
+    items.resize(bounds.size());
+    for (uint32_t i = 0; i < (uint32_t)bounds.size(); ++i) items[i] = i;
+    if (bounds.empty()) return;
+    if (maxLeafSize == 0) maxLeafSize = 1;
+
+    std::vector<glm::vec3> centers(bounds.size());
+    for (size_t i = 0; i < bounds.size(); ++i) centers[i] = bounds[i].center();
+
+    nodes.reserve(2 * (bounds.size() / maxLeafSize) + 1);
+    BvhNode root;
+    root.first = 0;
+    root.count = (uint32_t)bounds.size();
+    nodes.push_back(root);
+
+    // 显式栈代替递归; 中位数划分保证树是平衡的
+    std::vector<uint32_t> stack;
+    stack.push_back(0);
+    while (!stack.empty()) {
+        uint32_t index = stack.back();
+        stack.pop_back();
+
+        uint32_t first = nodes[index].first;
+        uint32_t count = nodes[index].count;
+        Aabb nodeBounds, centerBounds;
+        for (uint32_t i = first; i < first + count; ++i) {
+            nodeBounds.grow(bounds[items[i]]);
+            centerBounds.grow(centers[items[i]]);
+        }
+        nodes[index].bounds = nodeBounds;
+        if (count <= maxLeafSize) continue;
+
+        // 沿中心点分布最长的轴划分
+        glm::vec3 extent = centerBounds.extent();
+        int axis = 0;
+        if (extent.y > extent[axis]) axis = 1;
+        if (extent.z > extent[axis]) axis = 2;
+
+        uint32_t half = count / 2;
+        std::nth_element(items.begin() + first, items.begin() + first + half, items.begin() + first + count,
+                         [&](uint32_t a, uint32_t b) { return centers[a][axis] < centers[b][axis]; });
+
+        BvhNode left, right;
+        left.first = first;
+        left.count = half;
+        right.first = first + half;
+        right.count = count - half;
+        uint32_t leftIndex = (uint32_t)nodes.size();
+        nodes[index].left = leftIndex;
+        nodes.push_back(left);
+        nodes.push_back(right);
+
+        // 先处理左子树, 叶子在 items 中按深度优先顺序排列
+        stack.push_back(leftIndex + 1);
+        stack.push_back(leftIndex);
+    }
+}
+
+void Bvh::refit(const std::vector<Aabb>& bounds) {
+    for (size_t n = nodes.size(); n-- > 0;) {
+        BvhNode& node = nodes[n];
+        Aabb nodeBounds;
+        if (node.left == 0) {
+            for (uint32_t i = node.first; i < node.first + node.count; ++i) nodeBounds.grow(bounds[items[i]]);
+        } else {
+            nodeBounds.grow(nodes[node.left].bounds);
+            nodeBounds.grow(nodes[node.left + 1].bounds);
+        }
+        node.bounds = nodeBounds;
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include <cstdint>
+#include <vector>
+#include "Bounds.h"
+
+// 层次包围盒节点
+// 每个节点覆盖 items[first, first + count), 子节点成对存放在 nodes[left] 和 nodes[left + 1]
+struct BvhNode {
+    Aabb bounds;
+    uint32_t left = 0;   // 0 表示叶子 (根节点不会是任何节点的子节点)
+    uint32_t first = 0;
+    uint32_t count = 0;
+};
+
+// 包围盒的 BVH: 场景物体和网格的三角形簇共用
+// 按最长轴的中位数划分, 子节点总在父节点之后, 所以倒序遍历即可自底向上更新
+class Bvh {
+public:
+    std::vector<BvhNode> nodes;
+    std::vector<uint32_t> items; // 叶子顺序排列的元素编号
+
+    // 构建 (bounds 下标即元素编号)
+    void build(const std::vector<Aabb>& bounds, uint32_t maxLeafSize = 1);
+
+    // 元素移动后只更新节点包围盒, 不改变树的结构
+    void refit(const std::vector<Aabb>& bounds);
+
+    size_t itemCount() const { return items.size(); }
+
+    // 视锥裁剪: 对每个可见元素调用 visit(item)
+    // 完全在视锥内的子树不再逐个测试
+    template <typename Visit>
+    void cull(const Frustum& frustum, Visit&& visit) const {
+        if (nodes.empty()) return;
+        uint32_t stack[64];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const BvhNode& node = nodes[stack[--top]];
+            CullResult result = frustum.classify(node.bounds);
+            if (result == CullResult::Outside) continue;
+            if (result == CullResult::Inside || node.left == 0) {
+                for (uint32_t i = node.first; i < node.first + node.count; ++i) visit(items[i]);
+                continue;
+            }
+            stack[top++] = node.left + 1;
+            stack[top++] = node.left;
+        }
+    }
+};
+#endif
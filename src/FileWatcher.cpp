@@ -0,0 +1,143 @@
+#include "FileWatcher.h"
+#include <filesystem>
+#include <iostream>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// 后台线程检查退出标志的间隔
+const int WATCH_POLL_MS = 100;
+
+std::filesystem::path normalizedPath(const std::string& path) {
+    std::error_code ec;
+    std::filesystem::path absolute = std::filesystem::absolute(path, ec);
+    return (ec ? std::filesystem::path(path) : absolute).lexically_normal();
+}
+
+} // namespace
+
+FileWatcher::FileWatcher(std::chrono::milliseconds debounce) : debounce(debounce) {
+#ifdef __linux__
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "ERROR::FILEWATCHER::inotify_init1 failed, file watching disabled" << std::endl;
+        return;
+    }
+    thread = std::thread(&FileWatcher::run, this);
+#endif
+}
+
+FileWatcher::~FileWatcher() {
+    stopping = true;
+    if (thread.joinable()) thread.join();
+#ifdef __linux__
+    if (fd >= 0) close(fd);
+#endif
+}
+
+void FileWatcher::watch(const std::string& path) {
+    if (fd < 0) return;
+    std::filesystem::path file = normalizedPath(path);
+    std::string directory = file.parent_path().string();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    files[file.string()] = path;
+    for (const auto& entry : directories) {
+        if (entry.second == directory) return;
+    }
+#ifdef __linux__
+    // 同一目录重复添加时 inotify 返回同一个描述符
+    int wd = inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MODIFY | IN_MOVED_TO | IN_CREATE);
+    if (wd < 0) {
+        std::cerr << "ERROR::FILEWATCHER::Could not watch directory: " << directory << std::endl;
+        files.erase(file.string());
+        return;
+    }
+    directories[wd] = directory;
+#endif
+}
+
+void FileWatcher::unwatch(const std::string& path) {
+    if (fd < 0) return;
+    std::filesystem::path file = normalizedPath(path);
+    std::string directory = file.parent_path().string();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    files.erase(file.string());
+    pending.erase(path);
+    // 目录下没有其他监视的文件时移除目录的 watch
+    for (const auto& entry : files) {
+        if (std::filesystem::path(entry.first).parent_path().string() == directory) return;
+    }
+    for (auto it = directories.begin(); it != directories.end(); ++it) {
+        if (it->second != directory) continue;
+#ifdef __linux__
+        inotify_rm_watch(fd, it->first);
+#endif
+        directories.erase(it);
+        break;
+    }
+}
+
+std::vector<FileWatcher::Change> FileWatcher::poll() {
+    std::vector<Change> changes;
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = pending.begin(); it != pending.end();) {
+        if (now - it->second.lastEvent < debounce) {
+            ++it;
+            continue;
+        }
+        changes.push_back({ it->first, it->second.firstEvent });
+        it = pending.erase(it);
+    }
+    return changes;
+}
+
+// 目录中的一个文件有变化: 只记录被监视的文件
+void FileWatcher::handleEvent(int wd, const char* name) {
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+    auto directory = directories.find(wd);
+    if (directory == directories.end()) return;
+    std::string file = (std::filesystem::path(directory->second) / name).lexically_normal().string();
+    auto watched = files.find(file);
+    if (watched == files.end()) return;
+
+    auto it = pending.find(watched->second);
+    if (it == pending.end()) {
+        pending[watched->second] = { now, now };
+    } else {
+        it->second.lastEvent = now;
+    }
+}
+
+void FileWatcher::run() {
+#ifdef __linux__
+    alignas(inotify_event) char buffer[16 * 1024];
+    while (!stopping) {
+        pollfd request = { fd, POLLIN, 0 };
+        if (::poll(&request, 1, WATCH_POLL_MS) <= 0) continue;
+
+        ssize_t length;
+        while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+            for (char* p = buffer; p < buffer + length;) {
+                const inotify_event* event = (const inotify_event*)p;
+                if (event->mask & IN_IGNORED) {
+                    // 目录被删除或移走, watch 已经失效
+                    std::lock_guard<std::mutex> lock(mutex);
+                    directories.erase(event->wd);
+                } else if (event->len > 0) {
+                    handleEvent(event->wd, event->name);
+                }
+                p += sizeof(inotify_event) + event->len;
+            }
+        }
+    }
+#endif
+}
@@ -0,0 +1,59 @@
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 文件变化监视 (Linux: inotify; 其他平台 available() 为 false, 只能按 R 键手动重新加载着色器)
+// 监视的是文件所在的目录而不是文件本身: 编辑器和导出工具常用 "写临时文件 + 改名" 的方式保存,
+// 直接监视文件时 watch 会跟着旧的 inode 失效.
+// 事件在后台线程读取; 同一文件的连续事件 (分多次写入, 先截断再写) 合并,
+// 最后一个事件之后安静 debounce 时间才报告, 避免读到写了一半的文件.
+class FileWatcher {
+public:
+    struct Change {
+        std::string path;                               // 与 watch 时传入的路径相同
+        std::chrono::steady_clock::time_point firstEvent; // 这一轮变化的第一个事件 (用来统计重新加载的延迟)
+    };
+
+    explicit FileWatcher(std::chrono::milliseconds debounce = std::chrono::milliseconds(150));
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    bool available() const { return fd >= 0; }
+
+    // 开始 / 停止监视一个文件 (文件可以暂时不存在, 目录必须存在)
+    void watch(const std::string& path);
+    void unwatch(const std::string& path);
+
+    // 渲染线程每帧调用: 取出已经安静了 debounce 时间的变化
+    std::vector<Change> poll();
+
+private:
+    struct Pending {
+        std::chrono::steady_clock::time_point firstEvent;
+        std::chrono::steady_clock::time_point lastEvent;
+    };
+
+    std::chrono::milliseconds debounce;
+    int fd = -1;
+    std::atomic<bool> stopping{ false };
+    std::thread thread;
+
+    std::mutex mutex;                               // 保护以下成员
+    std::map<int, std::string> directories;         // watch 描述符 -> 目录
+    std::map<std::string, std::string> files;       // 规范化的绝对路径 -> 调用者的路径
+    std::map<std::string, Pending> pending;         // 调用者的路径 -> 未报告的变化
+
+    void run();
+    void handleEvent(int wd, const char* name);
+};
+#endif
@@ -0,0 +1,20 @@
+#include "FrameUniforms.h"
+
+FrameUniformBuffer::FrameUniformBuffer() {
+    glGenBuffers(1, &UBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_DATA_BINDING, UBO);
+}
+
+FrameUniformBuffer::~FrameUniformBuffer() {
+    if (UBO != 0) glDeleteBuffers(1, &UBO);
+}
+
+void FrameUniformBuffer::update(const FrameUniforms& data) {
+    glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms), &data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_DATA_BINDING, UBO);
+}
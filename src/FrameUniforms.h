@@ -0,0 +1,34 @@
+#ifndef FRAME_UNIFORMS_H
+#define FRAME_UNIFORMS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// 每帧数据 uniform block 的绑定点 (着色器中的 "FrameData")
+const GLuint FRAME_DATA_BINDING = 0;
+
+// 每帧数据, 与着色器中的 std140 布局一一对应 (vec3 按 vec4 对齐)
+struct FrameUniforms {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 viewProjection; // projection * view, 顶点着色器只需要这一个
+    glm::vec4 viewPos;
+    glm::vec4 lightPos;
+    glm::vec4 lightColor;
+};
+
+// 每帧数据的 UBO: 每帧只上传一次, 所有着色器程序共享
+class FrameUniformBuffer {
+public:
+    unsigned int UBO = 0;
+
+    FrameUniformBuffer();
+    ~FrameUniformBuffer();
+
+    FrameUniformBuffer(const FrameUniformBuffer&) = delete;
+    FrameUniformBuffer& operator=(const FrameUniformBuffer&) = delete;
+
+    // 上传本帧数据并绑定到 FRAME_DATA_BINDING
+    void update(const FrameUniforms& data);
+};
+#endif
@@ -0,0 +1,19 @@
+#ifndef INSTANCE_DATA_H
+#define INSTANCE_DATA_H
+
+#include <glm/glm.hpp>
+
+// 每实例顶点属性的位置 (与 obj_viewer.vs 一致)
+const unsigned int INSTANCE_MODEL_LOCATION       = 3; // mat4 占用 3..6
+const unsigned int INSTANCE_QUANT_OFFSET_LOCATION = 7;
+const unsigned int INSTANCE_QUANT_SCALE_LOCATION  = 8;
+const unsigned int INSTANCE_NORMAL_MATRIX_LOCATION = 9; // mat3 占用 9..11
+
+// 每实例数据, 作为实例化顶点属性 (divisor = 1) 上传
+struct InstanceData {
+    glm::mat4 model;
+    glm::vec4 quantOffset; // xyz: 所属网格的反量化偏移
+    glm::vec4 quantScale;  // xyz: 所属网格的反量化缩放, w 未使用
+    glm::vec4 normalMatrix[3]; // 法线矩阵 (model 左上 3x3 的逆转置) 的三列, 只用 xyz; 在 CPU 上每实例算一次
+};
+#endif
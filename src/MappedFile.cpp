@@ -0,0 +1,104 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER largeSize;
+    if (!GetFileSizeEx(file, &largeSize)) {
+        CloseHandle(file);
+        return false;
+    }
+    fileHandle = file;
+    fileSize = (size_t)largeSize.QuadPart;
+    opened = true;
+    if (fileSize == 0) return true;
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL) {
+        close();
+        return false;
+    }
+    mappingHandle = mapping;
+
+    fileData = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (fileData == nullptr) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close() {
+    if (fileData) UnmapViewOfFile(fileData);
+    if (mappingHandle) CloseHandle((HANDLE)mappingHandle);
+    if (fileHandle) CloseHandle((HANDLE)fileHandle);
+    fileData = nullptr;
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+    fileSize = 0;
+    opened = false;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    fileSize = (size_t)st.st_size;
+    opened = true;
+    if (fileSize == 0) {
+        ::close(fd);
+        return true;
+    }
+
+    void* ptr = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // 映射建立后可以直接关闭文件描述符
+    if (ptr == MAP_FAILED) {
+        fileSize = 0;
+        opened = false;
+        return false;
+    }
+    // 解析是顺序扫描, 提示内核积极预读
+    madvise(ptr, fileSize, MADV_SEQUENTIAL);
+    fileData = (const char*)ptr;
+    return true;
+}
+
+void MappedFile::close() {
+    if (fileData) munmap((void*)fileData, fileSize);
+    fileData = nullptr;
+    fileSize = 0;
+    opened = false;
+}
+
+#endif
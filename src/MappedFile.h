@@ -0,0 +1,34 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+// 只读内存映射文件 (POSIX mmap / Win32 MapViewOfFile)
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // 映射整个文件, 失败时返回 false
+    bool open(const std::string& path);
+    void close();
+
+    const char* data() const { return fileData; }
+    size_t size() const { return fileSize; }
+    bool isOpen() const { return opened; }
+
+private:
+    const char* fileData = nullptr;
+    size_t fileSize = 0;
+    bool opened = false; // 空文件不会映射, 但仍视为打开成功
+
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
+#endif
@@ -1,151 +1,684 @@
 #include "Mesh.h"
 #include <iostream>
 #include <fstream>
-#include <sstream>
 #include <string>
-#include <map>
+#include <chrono>
+#include <cmath>
+#include "ObjParser.h"
+#include "MappedFile.h"
+
+namespace {
+
+// 生成法线的设置编码成缓存里的一个数, 设置变化时缓存失效; 不生成时为 0
+uint32_t normalsKeyFor(const MeshLoadOptions& options) {
+    if (!options.generateNormals) return 0;
+    float crease = options.normals.creaseAngle;
+    uint32_t centiDegrees = (crease <= 0.0f || crease >= 180.0f) ? 0u : (uint32_t)std::lround(crease * 100.0f);
+    uint32_t area = options.normals.weighting == NormalWeighting::Area ? 2u : 0u;
+    return 1u | area | (centiDegrees << 2);
+}
+
+template <typename T>
+size_t capacityBytes(const std::vector<T>& values) {
+    return values.capacity() * sizeof(T);
+}
+
+// 上传数据中的顶点位置 (压缩顶点先反量化)
+std::vector<glm::vec3> uploadPositions(const MeshUploadData& upload, bool packed, const glm::vec3& quantOffset,
+                                       const glm::vec3& quantScale) {
+    std::vector<glm::vec3> positions(upload.vertexCount);
+    const PackedVertex* packedData = (const PackedVertex*)upload.vertexData;
+    const Vertex* floatData = (const Vertex*)upload.vertexData;
+    for (size_t i = 0; i < upload.vertexCount; ++i) {
+        positions[i] = packed ? unpackVertex(packedData[i], quantOffset, quantScale).Position : floatData[i].Position;
+    }
+    return positions;
+}
+
+// 上传数据中的索引, 16 位索引展开成 32 位
+std::vector<uint32_t> uploadIndices(const MeshUploadData& upload) {
+    if (upload.indexSize == sizeof(uint32_t)) {
+        const uint32_t* data = (const uint32_t*)upload.indexData;
+        return std::vector<uint32_t>(data, data + upload.indexCount);
+    }
+    const uint16_t* data = (const uint16_t*)upload.indexData;
+    return std::vector<uint32_t>(data, data + upload.indexCount);
+}
+
+} // namespace
+
+const char* hostRetentionName(HostRetention retention) {
+    switch (retention) {
+    case HostRetention::Drop:           return "drop";
+    case HostRetention::KeepForPicking: return "pick";
+    case HostRetention::KeepCompressed: return "compressed";
+    }
+    return "";
+}
 
 // 构造函数
-Mesh::Mesh(const std::string& path) {
+Mesh::Mesh(const std::string& path, const MeshLoadOptions& options) {
+    staged = std::make_unique<MeshUploadData>();
+    retention = options.retention;
+
+    // 优先尝试二进制缓存, 缓存有效时完全跳过 OBJ 文本解析
+    MeshCacheSource source;
+    std::string cachePath;
+    if (options.useCache && MeshCache::describeSource(path, source)) {
+        cachePath = MeshCache::pathFor(path, options.cacheDir);
+        if (loadCache(cachePath, source, options, *staged)) {
+            loaded = true;
+            if (options.buildPickBvh) startPickBuild(*staged, options.threads);
+            if (!options.deferUpload) {
+                uploadBuffers(*staged);
+                retainHostGeometry(*staged);
+                staged.reset();
+            }
+            return;
+        }
+    }
+
     // 仅在加载成功时才 setup
-    if (loadObj(path)) { 
-        setupMesh();
+    if (loadObj(path, options)) {
+        if (options.progress) options.progress->stage = MeshLoadStage::Building;
+
+        // 按空间位置重排三角形并分簇 (视锥裁剪的单位)
+        buildMeshClusters(vertices, indices, clusters);
+        setupClusters();
+
+        // 簇内三角形和顶点顺序优化; 只在写缓存之前做一次, 之后从缓存加载时不再付出这部分时间
+        if (options.optimizeOrder) {
+            MeshOptimizeStats stats = optimizeMesh(vertices, indices, clusters, options.threads);
+            optimized = true;
+            std::cout << "  Optimized triangle order in " << stats.seconds * 1000.0 << " ms: ACMR " << stats.before.acmr
+                      << " -> " << stats.after.acmr << ", ATVR " << stats.before.atvr << " -> " << stats.after.atvr
+                      << " (FIFO " << VERTEX_CACHE_SIZE << ")" << std::endl;
+        }
+
+        // 在最终的三角形顺序上切 meshlet
+        buildMeshlets(vertices, indices, clusters, meshlets);
+        std::cout << "  Meshlets: " << meshlets.size() << " (up to " << MESHLET_MAX_VERTICES << " vertices / "
+                  << MESHLET_MAX_TRIANGLES << " triangles each)" << std::endl;
+
+        this->packed = options.packVertices;
+        prepareUpload(*staged);
+        if (!cachePath.empty()) writeCache(cachePath, source, *staged);
+        loaded = true;
+
+        // LOD 的输入在释放 vertices/indices 之前拷出
+        if (options.buildLods) {
+            std::vector<glm::vec3> positions(vertices.size()), normals(vertices.size());
+            for (size_t i = 0; i < vertices.size(); ++i) {
+                positions[i] = vertices[i].Position;
+                normals[i] = vertices[i].Normal;
+            }
+            startLodBuild(std::move(positions), std::move(normals), indices);
+        }
+        if (options.buildPickBvh) startPickBuild(*staged, options.threads);
+
+        if (!options.deferUpload) {
+            setupMesh(*staged);
+            retainHostGeometry(*staged);
+            staged.reset();
+        }
     } else {
+        staged.reset();
+        if (options.progress) options.progress->stage = MeshLoadStage::Failed;
         std::cerr << "ERROR::MESH::Mesh construction failed for: " << path << std::endl;
     }
 }
 
+Mesh::~Mesh() {
+    // 通知后台 LOD 生成尽快结束并等待, 它引用着 lodCancel
+    lodCancel = true;
+    if (lodJob.valid()) lodJob.wait();
+    if (pickJob.valid()) pickJob.wait(); // 引用着 pickBuild
+    releaseGpuBuffers();
+}
+
+// 在后台线程生成 LOD 链, 输入数据整体移交给线程
+void Mesh::startLodBuild(std::vector<glm::vec3> positions, std::vector<glm::vec3> normals,
+                         std::vector<uint32_t> baseIndices) {
+    if (!hasNormals) normals.clear(); // 没有法线时分身只按位置区分
+    lodJob = std::async(std::launch::async,
+        [this, positions = std::move(positions), normals = std::move(normals), baseIndices = std::move(baseIndices)]() {
+            return buildLodChain(positions, normals, baseIndices, &lodCancel);
+        });
+}
+
+bool Mesh::takeLods() {
+    if (!lodJob.valid() || lodJob.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return false;
+    LodChain chain = lodJob.get();
+    lods = std::move(chain.levels);
+    lodIndices = std::move(chain.indices);
+
+    std::cout << "Built LOD chain in " << chain.seconds * 1000.0 << " ms:";
+    for (const MeshLod& lod : lods) std::cout << " " << lod.indexCount / 3 << " (error " << lod.error << ")";
+    std::cout << std::endl;
+    return true;
+}
+
+// 在后台线程构建拾取 BVH; 输入按上传顺序拷出, 从缓存加载和解析得到的三角形编号一致
+void Mesh::startPickBuild(const MeshUploadData& upload, unsigned int threads) {
+    std::vector<glm::vec3> positions = uploadPositions(upload, packed, quantOffset, quantScale);
+    std::vector<uint32_t> triangles = uploadIndices(upload);
+    pickJob = std::async(std::launch::async,
+        [this, threads, positions = std::move(positions), triangles = std::move(triangles)]() {
+            return pickBuild.build(positions.data(), triangles.data(), triangles.size() / 3, threads);
+        });
+}
+
+bool Mesh::takePickBvh() {
+    if (!pickJob.valid() || pickJob.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return false;
+    TriangleBvhStats stats = pickJob.get();
+    pickBvh = std::move(pickBuild);
+    pickBvhMs = stats.seconds * 1000.0;
+
+    std::cout << "Built pick BVH in " << pickBvhMs << " ms: " << stats.triangles << " triangles, " << stats.nodes
+              << " nodes, " << stats.leaves << " leaves, depth " << stats.depth << ", SAH cost " << stats.sahCost << ", "
+              << (double)pickBvh.memoryBytes() / (1024.0 * 1024.0) << " MB" << std::endl;
+    return true;
+}
+
+// 保留的几何来自上传数据 (解析结果或映射的缓存), 两种来源结果一致
+void Mesh::retainHostGeometry(const MeshUploadData& upload) {
+    size_t releasedBytes = capacityBytes(vertices) + capacityBytes(indices);
+    hostPositions.clear();
+    hostPacked.clear();
+    hostIndices.clear();
+    hostShortIndices.clear();
+
+    const PackedVertex* packedData = packed ? (const PackedVertex*)upload.vertexData : nullptr;
+    const Vertex* floatData = packed ? nullptr : (const Vertex*)upload.vertexData;
+    const uint16_t* shortData = upload.indexSize == sizeof(uint16_t) ? (const uint16_t*)upload.indexData : nullptr;
+    const uint32_t* longData = shortData ? nullptr : (const uint32_t*)upload.indexData;
+
+    if (retention == HostRetention::KeepForPicking) {
+        hostPositions = uploadPositions(upload, packed, quantOffset, quantScale);
+        hostIndices = uploadIndices(upload);
+    } else if (retention == HostRetention::KeepCompressed) {
+        if (packed) {
+            hostPacked.assign(packedData, packedData + upload.vertexCount);
+            hostQuantOffset = quantOffset;
+            hostQuantScale = quantScale;
+        } else {
+            // 上传的是 float 顶点: 解析得到的直接压缩, 来自缓存的先拷出来
+            QuantizationInfo info = floatData == vertices.data()
+                ? packVertices(vertices, hostPacked)
+                : packVertices(std::vector<Vertex>(floatData, floatData + upload.vertexCount), hostPacked);
+            hostQuantOffset = info.offset;
+            hostQuantScale = info.scale;
+        }
+        if (shortData) hostShortIndices.assign(shortData, shortData + upload.indexCount);
+        else hostIndices.assign(longData, longData + upload.indexCount);
+    }
+
+    std::vector<Vertex>().swap(vertices);
+    std::vector<uint32_t>().swap(indices);
+
+    size_t retainedBytes = memoryStats().retainedBytes;
+    if (releasedBytes > 0 || retainedBytes > 0) {
+        std::cout << "  Host geometry: released " << (double)releasedBytes / (1024.0 * 1024.0) << " MB, kept "
+                  << (double)retainedBytes / (1024.0 * 1024.0) << " MB (" << hostRetentionName(retention) << ")" << std::endl;
+    }
+}
+
+glm::vec3 Mesh::hostPosition(uint32_t vertex) const {
+    if (!hostPositions.empty()) return hostPositions[vertex];
+    const PackedVertex& packedVertex = hostPacked[vertex];
+    glm::vec3 position;
+    for (int axis = 0; axis < 3; ++axis) {
+        position[axis] = hostQuantOffset[axis] + (float)packedVertex.Position[axis] / 65535.0f * hostQuantScale[axis];
+    }
+    return position;
+}
+
+MeshMemoryStats Mesh::memoryStats() const {
+    MeshMemoryStats stats;
+    stats.retainedBytes = capacityBytes(hostPositions) + capacityBytes(hostPacked) + capacityBytes(hostIndices) +
+                          capacityBytes(hostShortIndices);
+    stats.hostBytes = stats.retainedBytes + capacityBytes(vertices) + capacityBytes(indices) + capacityBytes(clusters) +
+                      capacityBytes(meshlets) + capacityBytes(clusterBvh.nodes) + capacityBytes(clusterBvh.items) +
+                      capacityBytes(lods) + capacityBytes(lodIndices) + pickBvh.memoryBytes();
+    if (staged) stats.hostBytes += capacityBytes(staged->packedScratch) + capacityBytes(staged->indexScratch);
+
+    // LOD 索引上传到 Scene 的几何池后 lodIndices 释放; 单独绘制的网格不上传 LOD
+    size_t indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+    stats.gpuBytes = vertexCount * vertexStride + indexCount * indexSize;
+    if (lodIndices.empty()) {
+        for (const MeshLod& lod : lods) stats.gpuBytes += (size_t)lod.indexCount * indexSize;
+    }
+    stats.parseScratchPeakBytes = parseScratchPeakBytes;
+    return stats;
+}
+
+void Mesh::releaseGpuBuffers() {
+    if (VAO != 0) glDeleteVertexArrays(1, &VAO);
+    if (VBO != 0) glDeleteBuffers(1, &VBO);
+    if (EBO != 0) glDeleteBuffers(1, &EBO);
+    VAO = VBO = EBO = 0;
+}
+
+InstanceData Mesh::instanceData(const glm::mat4& model) const {
+    InstanceData data;
+    data.model = model;
+    data.quantOffset = glm::vec4(quantOffset, 0.0f);
+    data.quantScale = glm::vec4(quantScale, 0.0f);
+    glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
+    for (int column = 0; column < 3; ++column) data.normalMatrix[column] = glm::vec4(normalMatrix[column], 0.0f);
+    return data;
+}
+
+uint32_t Mesh::shaderFeatures() const {
+    return (hasNormals ? SHADER_HAS_NORMALS : 0u) | (packed ? SHADER_OCT_NORMALS : 0u);
+}
+
 // Draw 函数
-void Mesh::Draw(Shader &shader) {
+void Mesh::Draw(ShaderVariants& shaders, uint32_t features, const glm::mat4& model) {
     // 如果 VAO 没被创建，就不要绘制
     if (VAO == 0) return; 
-    
+
+    shaders.get(features | shaderFeatures()).use();
+
     glBindVertexArray(VAO);
-    glDrawArrays(GL_TRIANGLES, 0, vertices.size());
+
+    // 非实例化绘制: 每实例属性不启用数组, 用属性的当前值代替
+    InstanceData data = instanceData(model);
+    for (unsigned int column = 0; column < 4; ++column) {
+        glVertexAttrib4fv(INSTANCE_MODEL_LOCATION + column, &data.model[column][0]);
+    }
+    glVertexAttrib4fv(INSTANCE_QUANT_OFFSET_LOCATION, &data.quantOffset[0]);
+    glVertexAttrib4fv(INSTANCE_QUANT_SCALE_LOCATION, &data.quantScale[0]);
+    for (unsigned int column = 0; column < 3; ++column) {
+        glVertexAttrib4fv(INSTANCE_NORMAL_MATRIX_LOCATION + column, &data.normalMatrix[column][0]);
+    }
+
+    glDrawElements(GL_TRIANGLES, (GLsizei)indexCount, indexType, (void*)0);
     glBindVertexArray(0);
 }
 
+// 准备上传数据: 按需压缩顶点, 顶点数能用 16 位表示时把索引转换成 GL_UNSIGNED_SHORT
+void Mesh::prepareUpload(MeshUploadData& upload) {
+    if (packed) {
+        QuantizationInfo info = packVertices(vertices, upload.packedScratch);
+        quantOffset = info.offset;
+        quantScale = info.scale;
+        upload.vertexData = upload.packedScratch.data();
+        upload.vertexStride = sizeof(PackedVertex);
+
+        std::cout << "  Packed vertices: " << sizeof(Vertex) << " -> " << sizeof(PackedVertex) << " bytes, saved "
+                  << (double)(vertices.size() * (sizeof(Vertex) - sizeof(PackedVertex))) / (1024.0 * 1024.0) << " MB" << std::endl;
+        std::cout << "  Quantization error: position " << info.maxPositionError << " (bound " << info.positionErrorBound
+                  << "), normal " << info.maxNormalErrorDegrees << " deg, uv " << info.maxTexCoordError << std::endl;
+    } else {
+        quantOffset = glm::vec3(0.0f);
+        quantScale = glm::vec3(1.0f);
+        upload.vertexData = vertices.data();
+        upload.vertexStride = sizeof(Vertex);
+    }
+    upload.vertexCount = vertices.size();
+
+    upload.indexCount = indices.size();
+    if (vertices.size() <= 65536) {
+        upload.indexScratch.assign(indices.begin(), indices.end());
+        upload.indexData = upload.indexScratch.data();
+        upload.indexSize = sizeof(uint16_t);
+    } else {
+        upload.indexData = indices.data();
+        upload.indexSize = sizeof(uint32_t);
+    }
+    describeUpload(upload);
+}
+
+// 按上传数据设置绘制参数 (deferUpload 时在上传之前就已确定)
+void Mesh::describeUpload(const MeshUploadData& upload) {
+    indexCount = upload.indexCount;
+    indexType = (upload.indexSize == sizeof(uint16_t)) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    vertexCount = upload.vertexCount;
+    vertexStride = upload.vertexStride;
+}
+
 // setupMesh 函数
-void Mesh::setupMesh() {
+void Mesh::setupMesh(const MeshUploadData& upload) {
+    uploadBuffers(upload);
+
+    // 与展开成 glDrawArrays 三角形相比节省的内存
+    size_t vertexBytes = upload.vertexCount * upload.vertexStride;
+    size_t indexBytes = upload.indexCount * upload.indexSize;
+    double expandedMB = (double)(indexCount * sizeof(Vertex)) / (1024.0 * 1024.0);
+    double ramMB  = (double)(vertices.size() * sizeof(Vertex) + indices.size() * sizeof(uint32_t)) / (1024.0 * 1024.0);
+    double vramMB = (double)(vertexBytes + indexBytes) / (1024.0 * 1024.0);
+    std::cout << "  Indexed: " << vertices.size() << " unique vertices, " << indexCount << " indices ("
+              << (indexType == GL_UNSIGNED_SHORT ? "uint16" : "uint32") << ")" << std::endl;
+    std::cout << "  Clusters: " << clusters.size() << " (up to " << CLUSTER_TRIANGLES << " triangles each)" << std::endl;
+    std::cout << "  Memory: expanded " << expandedMB << " MB -> RAM " << ramMB << " MB, VRAM " << vramMB << " MB" << std::endl;
+}
+
+// 上传顶点/索引数据并设置 VAO
+void Mesh::uploadBuffers(const MeshUploadData& upload) {
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
 
     glBindVertexArray(VAO);
     
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, upload.vertexCount * upload.vertexStride, upload.vertexData, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, upload.indexCount * upload.indexSize, upload.indexData, GL_STATIC_DRAW);
 
     // 顶点属性指针
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-    
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
-    
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+    setupVertexAttributes(packed);
 
     glBindVertexArray(0);
 }
 
+// 设置顶点属性指针 (需要先绑定 VAO 和 GL_ARRAY_BUFFER), Scene 的共享缓冲也使用同一布局
+void Mesh::setupVertexAttributes(bool packedLayout) {
+    if (packedLayout) {
+        // 位置: unorm16 (反量化在顶点着色器中), 法线: snorm16 八面体编码, UV: half float
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, Position));
+
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, Normal));
+
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, TexCoords));
+    } else {
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+        
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+        
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+    }
+}
+
+// 网格包围盒和簇的 BVH
+void Mesh::setupClusters() {
+    std::vector<Aabb> clusterBounds(clusters.size());
+    bounds = Aabb();
+    for (size_t c = 0; c < clusters.size(); ++c) {
+        clusterBounds[c] = clusters[c].bounds;
+        bounds.grow(clusters[c].bounds);
+    }
+    clusterBvh.build(clusterBounds);
+}
+
+// 从二进制缓存加载: 校验头部后让上传数据直接指向映射的缓存 (映射由 upload.cache 持有)
+bool Mesh::loadCache(const std::string& cachePath, const MeshCacheSource& source, const MeshLoadOptions& options,
+                     MeshUploadData& upload) {
+    auto startTime = std::chrono::steady_clock::now();
+
+    MeshCache& cache = upload.cache;
+    if (!cache.open(cachePath, source)) return false;
+
+    // 顶点布局必须与请求的一致, 否则视为过期, 重新解析
+    uint32_t layout = (cache.header.layoutFlags >> MESH_CACHE_LAYOUT_SHIFT) & 0xFF;
+    uint32_t expectedLayout = options.packVertices ? MESH_CACHE_LAYOUT_PACKED16 : MESH_CACHE_LAYOUT_FLOAT32;
+    uint32_t expectedStride = options.packVertices ? sizeof(PackedVertex) : sizeof(Vertex);
+    if (layout != expectedLayout || cache.header.vertexStride != expectedStride || cache.header.indexCount == 0) {
+        cache.close();
+        return false;
+    }
+
+    // 源文件自带法线时与法线设置无关; 否则缓存里的法线 (生成的或没有) 必须与请求的设置一致
+    bool sourceNormals = (cache.header.layoutFlags & MESH_CACHE_HAS_NORMALS) != 0 && cache.header.normalsKey == 0;
+    if (!sourceNormals && cache.header.normalsKey != normalsKeyFor(options)) {
+        cache.close();
+        return false;
+    }
+
+    // 要求优化顺序时, 未优化的旧缓存重新生成 (反过来已优化的缓存总是可用)
+    if (options.optimizeOrder && (cache.header.layoutFlags & MESH_CACHE_OPTIMIZED) == 0) {
+        cache.close();
+        return false;
+    }
+
+    // 簇必须覆盖整个索引缓冲
+    clusters.resize((size_t)cache.header.clusterCount);
+    uint64_t coveredIndices = 0;
+    for (size_t c = 0; c < clusters.size(); ++c) {
+        const MeshCacheCluster& stored = cache.clusterData[c];
+        if (stored.firstIndex != coveredIndices || stored.indexCount % 3 != 0) {
+            clusters.clear();
+            cache.close();
+            return false;
+        }
+        coveredIndices += stored.indexCount;
+        clusters[c].firstIndex = stored.firstIndex;
+        clusters[c].indexCount = stored.indexCount;
+        clusters[c].bounds.min = glm::vec3(stored.boundsMin[0], stored.boundsMin[1], stored.boundsMin[2]);
+        clusters[c].bounds.max = glm::vec3(stored.boundsMax[0], stored.boundsMax[1], stored.boundsMax[2]);
+    }
+    if (coveredIndices != cache.header.indexCount) {
+        clusters.clear();
+        cache.close();
+        return false;
+    }
+
+    // meshlet 按顺序铺满各个簇, 不跨越簇的边界
+    meshlets.resize((size_t)cache.header.meshletCount);
+    size_t meshletIndex = 0;
+    bool meshletsValid = true;
+    for (MeshCluster& cluster : clusters) {
+        cluster.firstMeshlet = (uint32_t)meshletIndex;
+        uint32_t covered = cluster.firstIndex;
+        while (meshletsValid && covered < cluster.firstIndex + cluster.indexCount) {
+            if (meshletIndex >= meshlets.size()) {
+                meshletsValid = false;
+                break;
+            }
+            const MeshCacheMeshlet& stored = cache.meshletData[meshletIndex];
+            if (stored.firstIndex != covered || stored.indexCount == 0 ||
+                stored.indexCount % 3 != 0 || stored.indexCount > cluster.firstIndex + cluster.indexCount - covered) {
+                meshletsValid = false;
+                break;
+            }
+            Meshlet& meshlet = meshlets[meshletIndex++];
+            meshlet.firstIndex = stored.firstIndex;
+            meshlet.indexCount = stored.indexCount;
+            meshlet.center = glm::vec3(stored.center[0], stored.center[1], stored.center[2]);
+            meshlet.radius = stored.radius;
+            meshlet.coneAxis = glm::vec3(stored.coneAxis[0], stored.coneAxis[1], stored.coneAxis[2]);
+            meshlet.coneCutoff = stored.coneCutoff;
+            covered += stored.indexCount;
+        }
+        cluster.meshletCount = (uint32_t)meshletIndex - cluster.firstMeshlet;
+    }
+    if (!meshletsValid || meshletIndex != meshlets.size()) {
+        clusters.clear();
+        meshlets.clear();
+        cache.close();
+        return false;
+    }
+    setupClusters();
+
+    this->hasNormals = (cache.header.layoutFlags & MESH_CACHE_HAS_NORMALS) != 0;
+    this->normalsKey = cache.header.normalsKey;
+    this->optimized = (cache.header.layoutFlags & MESH_CACHE_OPTIMIZED) != 0;
+    this->packed = options.packVertices;
+    quantOffset = glm::vec3(cache.header.quantOffset[0], cache.header.quantOffset[1], cache.header.quantOffset[2]);
+    quantScale  = glm::vec3(cache.header.quantScale[0], cache.header.quantScale[1], cache.header.quantScale[2]);
+
+    upload.vertexData = cache.vertexData;
+    upload.vertexCount = (size_t)cache.header.vertexCount;
+    upload.vertexStride = cache.header.vertexStride;
+    upload.indexData = cache.indexData;
+    upload.indexCount = (size_t)cache.header.indexCount;
+    upload.indexSize = cache.header.indexSize;
+    describeUpload(upload);
+
+    // LOD 的输入: 从映射的缓存数据解出位置/法线和 32 位索引
+    if (options.buildLods) {
+        std::vector<glm::vec3> positions(upload.vertexCount), normals(upload.vertexCount);
+        for (size_t i = 0; i < upload.vertexCount; ++i) {
+            Vertex v = packed ? unpackVertex(((const PackedVertex*)upload.vertexData)[i], quantOffset, quantScale)
+                              : ((const Vertex*)upload.vertexData)[i];
+            positions[i] = v.Position;
+            normals[i] = v.Normal;
+        }
+        std::vector<uint32_t> baseIndices(upload.indexCount);
+        for (size_t i = 0; i < upload.indexCount; ++i) {
+            baseIndices[i] = upload.indexSize == sizeof(uint16_t) ? ((const uint16_t*)upload.indexData)[i]
+                                                                  : ((const uint32_t*)upload.indexData)[i];
+        }
+        startLodBuild(std::move(positions), std::move(normals), std::move(baseIndices));
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    std::cout << "Loaded mesh from cache: " << cachePath << " with " << indexCount / 3 << " triangles in "
+              << seconds * 1000.0 << " ms." << std::endl;
+    return true;
+}
+
+// 把上传给 GPU 的顶点/索引字节和三角形簇写入二进制缓存
+void Mesh::writeCache(const std::string& cachePath, const MeshCacheSource& source, const MeshUploadData& upload) const {
+    uint32_t layout = packed ? MESH_CACHE_LAYOUT_PACKED16 : MESH_CACHE_LAYOUT_FLOAT32;
+
+    MeshCacheHeader header{};
+    header.layoutFlags = (layout << MESH_CACHE_LAYOUT_SHIFT) | (hasNormals ? MESH_CACHE_HAS_NORMALS : 0u) |
+                         (optimized ? MESH_CACHE_OPTIMIZED : 0u);
+    header.source = source;
+    header.vertexStride = upload.vertexStride;
+    header.indexSize = upload.indexSize;
+    header.vertexCount = upload.vertexCount;
+    header.indexCount = upload.indexCount;
+    header.clusterCount = clusters.size();
+    header.normalsKey = normalsKey;
+    for (int i = 0; i < 3; ++i) {
+        header.quantOffset[i] = quantOffset[i];
+        header.quantScale[i] = quantScale[i];
+    }
+
+    header.meshletCount = meshlets.size();
+
+    std::vector<MeshCacheCluster> storedClusters(clusters.size());
+    for (size_t c = 0; c < clusters.size(); ++c) {
+        storedClusters[c].firstIndex = clusters[c].firstIndex;
+        storedClusters[c].indexCount = clusters[c].indexCount;
+        for (int i = 0; i < 3; ++i) {
+            storedClusters[c].boundsMin[i] = clusters[c].bounds.min[i];
+            storedClusters[c].boundsMax[i] = clusters[c].bounds.max[i];
+        }
+    }
+
+    std::vector<MeshCacheMeshlet> storedMeshlets(meshlets.size());
+    for (size_t m = 0; m < meshlets.size(); ++m) {
+        const Meshlet& meshlet = meshlets[m];
+        storedMeshlets[m].firstIndex = meshlet.firstIndex;
+        storedMeshlets[m].indexCount = meshlet.indexCount;
+        for (int i = 0; i < 3; ++i) {
+            storedMeshlets[m].center[i] = meshlet.center[i];
+            storedMeshlets[m].coneAxis[i] = meshlet.coneAxis[i];
+        }
+        storedMeshlets[m].radius = meshlet.radius;
+        storedMeshlets[m].coneCutoff = meshlet.coneCutoff;
+    }
+
+    if (MeshCache::write(cachePath, header, upload.vertexData, upload.indexData, storedClusters.data(),
+                         storedMeshlets.data())) {
+        std::cout << "  Wrote mesh cache: " << cachePath << std::endl;
+    }
+}
+
 // obj加载器
-bool Mesh::loadObj(const std::string& path) {
+bool Mesh::loadObj(const std::string& path, const MeshLoadOptions& options) {
     vertices.clear();
-
-    std::vector<glm::vec3> temp_Positions;
-    std::vector<glm::vec3> temp_Normals;
-    std::vector<glm::vec2> temp_TexCoords;
+    indices.clear();
 
     // .obj 格式允许 'f 1/1/1 2/2/2 3/3/3'
     // 'f 1//1 2//2 3//3'
     // 'f 1/1 2/2 3/3'
     // 'f 1 2 3'
 
-    std::ifstream file(path);
-    if (!file.is_open()) {
-        std::cerr << "ERROR::MESH::Could not open file: " << path << std::endl;
-        return false;
-    }
+    auto startTime = std::chrono::steady_clock::now();
 
-    std::string line;
-    while (std::getline(file, line)) {
-        std::stringstream ss(line);
-        std::string prefix;
-        ss >> prefix;
-
-        if (prefix == "v") {
-            glm::vec3 pos;
-            ss >> pos.x >> pos.y >> pos.z;
-            temp_Positions.push_back(pos);
-        } else if (prefix == "vn") {
-            glm::vec3 norm;
-            ss >> norm.x >> norm.y >> norm.z;
-            temp_Normals.push_back(norm);
-        } else if (prefix == "vt") {
-            glm::vec2 uv;
-            ss >> uv.x >> uv.y;
-            temp_TexCoords.push_back(uv);
-        } else if (prefix == "f") {
-            std::string face_data_str;
-            unsigned int vIdx, vtIdx, vnIdx;
-            
-            // 循环读取 "f" 行的每一个顶点 (v/t/n 组合)
-            while (ss >> face_data_str) { 
-                
-                // 开始解析 "v/vt/vn" 字符串
-                std::stringstream face_ss(face_data_str);
-                std::string segment;
-                std::vector<std::string> segments;
-                while(std::getline(face_ss, segment, '/')) {
-                    segments.push_back(segment);
-                }
-                // 解析完毕
-
-                Vertex vertex;
-                
-                // .obj 索引从 1 开始, C++ 数组从 0 开始
-                vIdx = std::stoul(segments[0]);
-                vertex.Position = temp_Positions[vIdx - 1];
-
-                // 检查格式
-                if (segments.size() == 2) { // "f v/vt"
-                    vtIdx = std::stoul(segments[1]);
-                    vertex.TexCoords = temp_TexCoords[vtIdx - 1];
-                    // (没有法线)
-                } 
-                else if (segments.size() == 3) {
-                    if (segments[1].empty()) { // "f v//vn" (茶壶格式)
-                        vnIdx = std::stoul(segments[2]);
-                        if (vnIdx > 0) { // 检查索引是否有效
-                            vertex.Normal = temp_Normals[vnIdx - 1];
-                            this->hasNormals = true; 
-                        }
-                    } else { // "f v/vt/vn"
-                        vtIdx = std::stoul(segments[1]);
-                        vnIdx = std::stoul(segments[2]);
-                        if (vtIdx > 0) vertex.TexCoords = temp_TexCoords[vtIdx - 1];
-                        if (vnIdx > 0) { // 检查索引是否有效
-                            vertex.Normal = temp_Normals[vnIdx - 1];
-                            this->hasNormals = true; 
-                        }
-                    }
-                }
-                else if (segments.size() == 1) { // "f v" (只有位置)
-                    // 没有纹理，没有法线
-                }
-
-                vertices.push_back(vertex);
-            }
+    ObjParser parser;
+    size_t fileSize = 0;
+    bool parsed = false;
+
+    if (options.useMmap) {
+        // 内存映射整个文件, 按行切块后多线程解析
+        MappedFile file;
+        if (!file.open(path)) {
+            std::cerr << "ERROR::MESH::Could not open file: " << path << std::endl;
+            return false;
+        }
+        fileSize = file.size();
+        parser.threadCount = options.threads;
+        if (options.progress) {
+            options.progress->bytesTotal = fileSize;
+            options.progress->stage = MeshLoadStage::Parsing;
+            parser.bytesParsed = &options.progress->bytesDone;
+        }
+        parsed = parser.parse(file.data(), file.data() + file.size());
+    } else {
+        // 整个文件一次读入内存, 单线程解析
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) {
+            std::cerr << "ERROR::MESH::Could not open file: " << path << std::endl;
+            return false;
+        }
+        fileSize = (size_t)file.tellg();
+        file.seekg(0, std::ios::beg);
+        std::vector<char> buffer(fileSize);
+        if (fileSize > 0 && !file.read(buffer.data(), (std::streamsize)fileSize)) {
+            std::cerr << "ERROR::MESH::Could not read file: " << path << std::endl;
+            return false;
         }
+        file.close();
+
+        parser.threadCount = 1;
+        if (options.progress) {
+            options.progress->bytesTotal = fileSize;
+            options.progress->stage = MeshLoadStage::Parsing;
+            parser.bytesParsed = &options.progress->bytesDone;
+        }
+        parsed = parser.parse(buffer.data(), buffer.data() + buffer.size());
+    }
+
+    if (!parsed) {
+        std::cerr << "ERROR::MESH::Failed to parse file: " << path << std::endl;
+        return false;
     }
-    file.close();
+    vertices = std::move(parser.vertices);
+    indices = std::move(parser.indices);
+    this->hasNormals = parser.hasNormals;
+    // ifstream 时整个文件的缓冲与解析的临时数组同时存在
+    parseScratchPeakBytes = parser.scratchPeakBytes + (options.useMmap ? 0 : fileSize);
 
     // 检查是否真的加载了顶点
-    if (vertices.empty()) {
+    if (vertices.empty() || indices.empty()) {
         std::cerr << "ERROR::MESH::No vertices loaded from file (is format supported?): " << path << std::endl;
         return false;
     }
 
-    std::cout << "Loaded mesh: " << path << " with " << vertices.size() << " vertices." << std::endl;
+    // 统计吞吐量 (读取 + 解析)
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    double megabytes = (double)fileSize / (1024.0 * 1024.0);
+    std::cout << "Loaded mesh: " << path << " with " << indices.size() / 3 << " triangles." << std::endl;
+    std::cout << "  Parsed " << megabytes << " MB in " << seconds * 1000.0 << " ms ("
+              << (seconds > 0.0 ? megabytes / seconds : 0.0) << " MB/s, "
+              << (options.useMmap ? "mmap" : "ifstream") << ")" << std::endl;
+
+    // 没有法线: 生成平滑法线, 片元着色器不必再用导数逐像素重建面法线
+    if (!hasNormals && options.generateNormals) {
+        NormalOptions normalOptions = options.normals;
+        if (normalOptions.threads == 0) normalOptions.threads = options.useMmap ? options.threads : 1;
+        NormalStats stats = generateNormals(vertices, indices, normalOptions);
+        this->hasNormals = true;
+        this->normalsKey = normalsKeyFor(options);
+        this->normalsMs = stats.seconds * 1000.0;
+        std::cout << "  Generated " << (normalOptions.weighting == NormalWeighting::Area ? "area" : "angle")
+                  << "-weighted normals in " << normalsMs << " ms (+"
+                  << (seconds > 0.0 ? stats.seconds / seconds * 100.0 : 0.0) << "% of parse";
+        if (stats.splitVertices > 0) std::cout << ", " << stats.splitVertices << " vertices split at creases";
+        std::cout << ")" << std::endl;
+    }
     return true;
-}
\ No newline at end of file
+}
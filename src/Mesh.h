@@ -3,28 +3,198 @@
 
 #include <glad/glad.h> 
 #include <glm/glm.hpp>
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <memory>
 #include <string>
 #include <vector>
 #include "Shader.h"
+#include "Vertex.h"
+#include "MeshCache.h"
+#include "VertexPacking.h"
+#include "InstanceData.h"
+#include "MeshClusters.h"
+#include "Bvh.h"
+#include "MeshSimplify.h"
+#include "MeshNormals.h"
+#include "MeshOptimize.h"
+#include "TriangleBvh.h"
 
-struct Vertex {
-    glm::vec3 Position;
-    glm::vec3 Normal;
-    glm::vec2 TexCoords;
+// 加载阶段
+enum class MeshLoadStage { Queued, Parsing, Building, Uploading, Done, Failed };
+
+// 加载进度 (后台加载时由工作线程写, GL 线程读)
+struct MeshLoadProgress {
+    std::atomic<MeshLoadStage> stage{ MeshLoadStage::Queued };
+    std::atomic<size_t> bytesDone{ 0 };   // Parsing: 已解析的源文件字节; Uploading: 已上传的字节
+    std::atomic<size_t> bytesTotal{ 0 };
+};
+
+// 几何上传到 GPU 之后 CPU 端保留什么 (解析出的 32 字节顶点数组总是释放)
+enum class HostRetention {
+    Drop,           // 什么也不保留, 只用于绘制
+    KeepForPicking, // 保留 float 位置和 32 位索引 (每顶点 12 字节), 供 CPU 端的几何查询 (射线拾取用 pickBvh, 不需要保留)
+    KeepCompressed, // 保留完整顶点 (位置/法线/UV) 的 16 字节压缩形式和上传时的索引 (16 位或 32 位), 用到时逐个反量化
+};
+
+const char* hostRetentionName(HostRetention retention); // "drop" / "pick" / "compressed"
+
+// 网格的内存统计 (字节, 数组按容量计)
+struct MeshMemoryStats {
+    size_t hostBytes = 0;              // CPU 端全部数组: 保留的几何, 簇/meshlet/BVH, 待上传数据, 未上传的 LOD 索引
+    size_t retainedBytes = 0;          // 其中按 HostRetention 保留的几何
+    size_t gpuBytes = 0;               // 顶点 + 索引 (含 LOD) 缓冲; 在 Scene 的共享缓冲中时为所占的部分
+    size_t parseScratchPeakBytes = 0;  // 解析 OBJ 时临时数组的峰值 (ObjParser::scratchPeakBytes + 读入的文本), 从缓存加载时为 0
+};
+
+// 加载选项
+struct MeshLoadOptions {
+    bool useMmap = true;        // true: 内存映射 + 多线程分块解析; false: ifstream 读入后单线程解析
+    unsigned int threads = 0;   // 解析线程数, 0 = 硬件线程数 (仅 useMmap 时生效)
+    bool useCache = true;       // 读写二进制缓存 (.meshcache), 源文件变化时自动失效
+    std::string cacheDir;       // 缓存目录, 为空时写在源文件旁边
+    bool packVertices = false;  // 使用 16 字节压缩顶点 (见 VertexPacking.h)
+    bool buildLods = false;     // 在后台线程生成 LOD 链 (见 MeshSimplify.h), 不阻塞第一帧
+    bool generateNormals = true; // 源文件没有法线时生成平滑法线 (见 MeshNormals.h); false 时片元着色器用导数算面法线
+    NormalOptions normals;      // 生成法线的权重和折痕角 (threads 为 0 时沿用上面的 threads)
+    bool optimizeOrder = true;  // 重排三角形和顶点顺序 (顶点缓存 / 过绘制 / 顶点读取, 见 MeshOptimize.h), 结果随缓存保存
+    bool deferUpload = false;   // 只准备 CPU 端数据, 不调用 GL (可以在工作线程构造), 数据留在 staged 中
+    HostRetention retention = HostRetention::Drop; // 上传后保留的 CPU 端几何
+    bool buildPickBvh = false;  // 在后台线程构建三角形 BVH (见 TriangleBvh.h), 用于拾取和测量; BVH 自带三角形数据, 与 retention 无关
+    MeshLoadProgress* progress = nullptr; // 非空时报告加载进度
+};
+
+// 上传到 GPU 的数据 (来自内存数组, 或直接来自映射的缓存文件)
+struct MeshUploadData {
+    const void* vertexData = nullptr;
+    size_t vertexCount = 0;
+    uint32_t vertexStride = 0;
+    const void* indexData = nullptr;
+    size_t indexCount = 0;
+    uint32_t indexSize = 0;
+
+    // 格式转换用的临时存储
+    std::vector<PackedVertex> packedScratch;
+    std::vector<uint16_t> indexScratch;
+
+    // 从缓存加载时保持映射, 上传完成前数据指针都指向这里
+    MeshCache cache;
 };
 
 class Mesh {
 public:
-    std::vector<Vertex> vertices;
-    unsigned int VAO = 0, VBO = 0; // !! 在这里初始化为 0 !!
+    std::vector<Vertex> vertices;       // 去重后的顶点 (上传后释放, 见 retainHostGeometry)
+    std::vector<uint32_t> indices;      // 三角形索引 (同上)
+    unsigned int VAO = 0, VBO = 0, EBO = 0; // !! 在这里初始化为 0 !!
+
+    GLenum indexType = GL_UNSIGNED_INT; // 顶点数不超过 65536 时上传为 GL_UNSIGNED_SHORT
+    size_t indexCount = 0;
+    size_t vertexCount = 0;             // 已上传的顶点数 (从缓存加载时 vertices 为空)
+    uint32_t vertexStride = 0;          // 已上传顶点的字节数
+
+    bool hasNormals = false; //是否读取到法线 (包括加载时生成的)
+    double normalsMs = 0.0;  // 生成法线的耗时, 没有生成时为 0
+    bool loaded = false;     // 加载成功 (deferUpload 时表示 CPU 端数据已就绪)
+
+    // deferUpload 时等待上传的数据, 由 Scene 分批上传后释放
+    std::unique_ptr<MeshUploadData> staged;
+
+    // 上传后按 retention 保留的几何, 顶点和索引顺序与 GPU 上一致
+    HostRetention retention = HostRetention::Drop;
+    std::vector<glm::vec3> hostPositions;       // KeepForPicking
+    std::vector<PackedVertex> hostPacked;       // KeepCompressed, 用 hostQuantOffset/Scale 反量化
+    glm::vec3 hostQuantOffset = glm::vec3(0.0f);
+    glm::vec3 hostQuantScale  = glm::vec3(1.0f);
+    std::vector<uint32_t> hostIndices;          // KeepForPicking; KeepCompressed 且上传为 32 位索引
+    std::vector<uint16_t> hostShortIndices;     // KeepCompressed 且上传为 16 位索引
+    size_t parseScratchPeakBytes = 0;
+
+    // 压缩顶点: 位置在着色器里按 quantOffset + aPos * quantScale 反量化
+    bool packed = false;
+    glm::vec3 quantOffset = glm::vec3(0.0f);
+    glm::vec3 quantScale  = glm::vec3(1.0f);
+
+    // 视锥裁剪用的包围盒 (模型空间)
+    Aabb bounds;
+    std::vector<MeshCluster> clusters;  // 三角形簇, 在索引缓冲中各占连续的一段
+    Bvh clusterBvh;                     // 簇的 BVH, 元素编号即 clusters 的下标
+    std::vector<Meshlet> meshlets;      // 簇内的 meshlet (MeshCluster::firstMeshlet), 逐帧做视锥和背面剔除
 
-    bool hasNormals = false; //是否读取到法线
+    // LOD 链 (第 1 级以后), 后台生成完成后由 takeLods 填入
+    // 各级索引引用原顶点, 与原网格共用顶点缓冲; lods[i].firstIndex 指向 lodIndices
+    std::vector<MeshLod> lods;
+    std::vector<uint32_t> lodIndices;
 
-    Mesh(const std::string& path);
-    void Draw(Shader &shader);
+    // 拾取用的三角形 BVH, 后台构建完成后由 takePickBvh 填入; 三角形编号为上传时的顺序 (与 hostIndex 一致)
+    TriangleBvh pickBvh;
+    double pickBvhMs = 0.0;
+
+    Mesh(const std::string& path, const MeshLoadOptions& options = MeshLoadOptions());
+    ~Mesh();
+
+    Mesh(const Mesh&) = delete;
+    Mesh& operator=(const Mesh&) = delete;
+
+    // 单独绘制 (场景中的网格由 Scene 批量绘制); features 为着色模式 (HEADLIGHT / FLAT / WIREFRAME),
+    // 与网格自己的特性 (shaderFeatures) 合并后选择着色器版本
+    void Draw(ShaderVariants& shaders, uint32_t features, const glm::mat4& model = glm::mat4(1.0f));
+
+    // 网格决定的着色器特性: HAS_NORMALS, OCT_NORMALS
+    uint32_t shaderFeatures() const;
+
+    // 本网格一个实例的每实例数据
+    InstanceData instanceData(const glm::mat4& model) const;
+
+    // 后台 LOD 生成是否还在进行
+    bool lodsPending() const { return lodJob.valid(); }
+
+    // 后台 LOD 生成刚完成时取回结果并返回 true (只返回一次)
+    bool takeLods();
+
+    // 拾取 BVH 的后台构建, 用法同 LOD
+    bool pickBvhPending() const { return pickJob.valid(); }
+    bool takePickBvh();
+
+    // 释放 GPU 缓冲 (几何数据已被 Scene 拷贝到共享缓冲时调用)
+    void releaseGpuBuffers();
+
+    // 上传完成后调用 (upload 仍然有效): 按 retention 从上传数据保留几何, 释放 vertices/indices
+    void retainHostGeometry(const MeshUploadData& upload);
+
+    // 保留的几何 (Drop 时没有); 索引 i 为三角形 i / 3 的第 i % 3 个角点
+    bool hasHostGeometry() const { return !hostPositions.empty() || !hostPacked.empty(); }
+    size_t hostIndexCount() const { return hostIndices.size() + hostShortIndices.size(); }
+    uint32_t hostIndex(size_t i) const { return hostShortIndices.empty() ? hostIndices[i] : hostShortIndices[i]; }
+    glm::vec3 hostPosition(uint32_t vertex) const;
+
+    MeshMemoryStats memoryStats() const;
+
+    // 设置顶点属性指针 (需要先绑定 VAO 和 GL_ARRAY_BUFFER)
+    static void setupVertexAttributes(bool packedLayout);
 
 private:
-    bool loadObj(const std::string& path); 
-    void setupMesh();
+    bool loadObj(const std::string& path, const MeshLoadOptions& options);
+    void prepareUpload(MeshUploadData& upload);
+    void setupMesh(const MeshUploadData& upload);
+    void uploadBuffers(const MeshUploadData& upload);
+    void describeUpload(const MeshUploadData& upload);
+    void setupClusters();
+    void startLodBuild(std::vector<glm::vec3> positions, std::vector<glm::vec3> normals,
+                       std::vector<uint32_t> baseIndices);
+    void startPickBuild(const MeshUploadData& upload, unsigned int threads);
+
+    uint32_t normalsKey = 0;    // 生成法线的设置 (写入缓存), 0: 没有生成
+    bool optimized = false;     // 三角形和顶点顺序已优化 (写入缓存)
+
+    std::future<LodChain> lodJob;
+    std::atomic<bool> lodCancel{ false };
+
+    TriangleBvh pickBuild; // 后台线程构建中, takePickBvh 时移入 pickBvh
+    std::future<TriangleBvhStats> pickJob;
+
+    bool loadCache(const std::string& cachePath, const MeshCacheSource& source, const MeshLoadOptions& options,
+                   MeshUploadData& upload);
+    void writeCache(const std::string& cachePath, const MeshCacheSource& source, const MeshUploadData& upload) const;
 };
 #endif
\ No newline at end of file
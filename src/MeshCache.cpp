@@ -0,0 +1,216 @@
+#include "MeshCache.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+const char MESH_CACHE_MAGIC[8] = { 'O', 'B', 'J', 'M', 'E', 'S', 'H', '\0' };
+
+// 数据块按 16 字节对齐, 方便映射后直接上传
+const uint64_t MESH_CACHE_ALIGNMENT = 16;
+
+// 指纹抽样: 文件头尾各 64 KB, 中间均匀抽取 64 个 4 KB 的块
+const size_t HASH_EDGE_BYTES = 64 * 1024;
+const size_t HASH_BLOCK_BYTES = 4 * 1024;
+const size_t HASH_BLOCK_COUNT = 64;
+
+inline uint64_t alignUp(uint64_t value) {
+    return (value + MESH_CACHE_ALIGNMENT - 1) & ~(MESH_CACHE_ALIGNMENT - 1);
+}
+
+// FNV-1a 64 位
+inline uint64_t fnv1a(const void* data, size_t size, uint64_t hash) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+// 所有索引都小于 vertexCount (一次顺序扫描, 比解析 OBJ 便宜得多)
+template <typename IndexT>
+bool indicesInRange(const void* data, uint64_t count, uint64_t vertexCount) {
+    const IndexT* indices = (const IndexT*)data;
+    IndexT maxIndex = 0;
+    for (uint64_t i = 0; i < count; ++i) maxIndex = std::max(maxIndex, indices[i]);
+    return count == 0 || (uint64_t)maxIndex < vertexCount;
+}
+
+bool writePadding(std::ofstream& out, uint64_t from, uint64_t to) {
+    static const char zeros[MESH_CACHE_ALIGNMENT] = {};
+    return (bool)out.write(zeros, (std::streamsize)(to - from));
+}
+
+} // namespace
+
+bool MeshCache::describeSource(const std::string& sourcePath, MeshCacheSource& source) {
+    std::error_code ec;
+    auto mtime = std::filesystem::last_write_time(sourcePath, ec);
+    if (ec) return false;
+
+    MappedFile sourceFile;
+    if (!sourceFile.open(sourcePath)) return false;
+
+    source.size = sourceFile.size();
+    source.mtime = (int64_t)mtime.time_since_epoch().count();
+
+    // 抽样哈希: 对大文件只读取少量页面, 不必把整个源文件读一遍
+    const char* data = sourceFile.data();
+    size_t size = sourceFile.size();
+    uint64_t hash = fnv1a(&source.size, sizeof(source.size), 0xCBF29CE484222325ull);
+    if (size <= 2 * HASH_EDGE_BYTES + HASH_BLOCK_COUNT * HASH_BLOCK_BYTES) {
+        hash = fnv1a(data, size, hash);
+    } else {
+        hash = fnv1a(data, HASH_EDGE_BYTES, hash);
+        size_t middle = size - 2 * HASH_EDGE_BYTES - HASH_BLOCK_BYTES;
+        for (size_t i = 0; i < HASH_BLOCK_COUNT; ++i) {
+            size_t offset = HASH_EDGE_BYTES + middle * i / (HASH_BLOCK_COUNT - 1);
+            hash = fnv1a(data + offset, HASH_BLOCK_BYTES, hash);
+        }
+        hash = fnv1a(data + size - HASH_EDGE_BYTES, HASH_EDGE_BYTES, hash);
+    }
+    source.hash = hash;
+    return true;
+}
+
+std::string MeshCache::pathFor(const std::string& sourcePath, const std::string& cacheDir) {
+    if (cacheDir.empty()) return sourcePath + ".meshcache";
+    std::filesystem::path name = std::filesystem::path(sourcePath).filename();
+    return (std::filesystem::path(cacheDir) / name).string() + ".meshcache";
+}
+
+bool MeshCache::open(const std::string& cachePath, const MeshCacheSource& source) {
+    close();
+    if (!file.open(cachePath)) return false; // 没有缓存, 不算错误
+
+    if (file.size() < sizeof(MeshCacheHeader)) {
+        close();
+        return false;
+    }
+    memcpy(&header, file.data(), sizeof(MeshCacheHeader));
+
+    // 版本和源文件指纹
+    if (memcmp(header.magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC)) != 0 ||
+        header.version != MESH_CACHE_VERSION ||
+        header.source.size != source.size ||
+        header.source.mtime != source.mtime ||
+        header.source.hash != source.hash) {
+        close();
+        return false;
+    }
+
+    // 数据范围
+    uint64_t size = file.size();
+    // 先按文件大小限制个数再相乘, 伪造的个数不会让乘积溢出后通过下面的范围检查
+    uint64_t payload = size - sizeof(MeshCacheHeader);
+    bool countsValid = (header.indexSize == 2 || header.indexSize == 4) && header.vertexStride != 0 &&
+                       header.vertexCount <= payload / header.vertexStride &&
+                       header.indexCount <= payload / header.indexSize &&
+                       header.clusterCount <= payload / sizeof(MeshCacheCluster) &&
+                       header.meshletCount <= payload / sizeof(MeshCacheMeshlet);
+    if (!countsValid) {
+        std::cerr << "ERROR::MESHCACHE::Corrupted cache file: " << cachePath << std::endl;
+        close();
+        return false;
+    }
+    uint64_t vertexBytes = header.vertexCount * header.vertexStride;
+    uint64_t indexBytes = header.indexCount * header.indexSize;
+    uint64_t clusterBytes = header.clusterCount * sizeof(MeshCacheCluster);
+    uint64_t meshletBytes = header.meshletCount * sizeof(MeshCacheMeshlet);
+    bool valid = header.indexCount % 3 == 0 &&
+                 header.vertexOffset % MESH_CACHE_ALIGNMENT == 0 &&
+                 header.indexOffset % MESH_CACHE_ALIGNMENT == 0 &&
+                 header.clusterOffset % MESH_CACHE_ALIGNMENT == 0 &&
+                 header.meshletOffset % MESH_CACHE_ALIGNMENT == 0 &&
+                 header.vertexOffset >= sizeof(MeshCacheHeader) &&
+                 header.vertexOffset <= size && vertexBytes <= size - header.vertexOffset &&
+                 header.indexOffset <= size && indexBytes <= size - header.indexOffset &&
+                 header.clusterOffset <= size && clusterBytes <= size - header.clusterOffset &&
+                 header.meshletOffset <= size && meshletBytes <= size - header.meshletOffset;
+    if (!valid) {
+        std::cerr << "ERROR::MESHCACHE::Corrupted cache file: " << cachePath << std::endl;
+        close();
+        return false;
+    }
+
+    vertexData = file.data() + header.vertexOffset;
+    indexData = file.data() + header.indexOffset;
+
+    // 索引越界会让 LOD 生成, 拾取 BVH 构建和绘制读到顶点数组之外
+    bool indicesValid = header.indexSize == 2
+                            ? indicesInRange<uint16_t>(indexData, header.indexCount, header.vertexCount)
+                            : indicesInRange<uint32_t>(indexData, header.indexCount, header.vertexCount);
+    if (!indicesValid) {
+        std::cerr << "ERROR::MESHCACHE::Index out of range in cache file: " << cachePath << std::endl;
+        close();
+        return false;
+    }
+    clusterData = (const MeshCacheCluster*)(file.data() + header.clusterOffset);
+    meshletData = (const MeshCacheMeshlet*)(file.data() + header.meshletOffset);
+    return true;
+}
+
+void MeshCache::close() {
+    file.close();
+    header = MeshCacheHeader{};
+    vertexData = nullptr;
+    indexData = nullptr;
+    clusterData = nullptr;
+    meshletData = nullptr;
+}
+
+bool MeshCache::write(const std::string& cachePath, const MeshCacheHeader& header,
+                      const void* vertices, const void* indices, const MeshCacheCluster* clusters,
+                      const MeshCacheMeshlet* meshlets) {
+    MeshCacheHeader out = header;
+    memcpy(out.magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC));
+    out.version = MESH_CACHE_VERSION;
+    uint64_t vertexBytes = out.vertexCount * out.vertexStride;
+    uint64_t indexBytes = out.indexCount * out.indexSize;
+    uint64_t clusterBytes = out.clusterCount * sizeof(MeshCacheCluster);
+    uint64_t meshletBytes = out.meshletCount * sizeof(MeshCacheMeshlet);
+    out.vertexOffset = alignUp(sizeof(MeshCacheHeader));
+    out.indexOffset = alignUp(out.vertexOffset + vertexBytes);
+    out.clusterOffset = alignUp(out.indexOffset + indexBytes);
+    out.meshletOffset = alignUp(out.clusterOffset + clusterBytes);
+
+    std::error_code ec;
+    std::filesystem::path target(cachePath);
+    if (target.has_parent_path()) std::filesystem::create_directories(target.parent_path(), ec);
+
+    std::string tempPath = cachePath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "ERROR::MESHCACHE::Could not write cache file: " << tempPath << std::endl;
+            return false;
+        }
+        bool ok = file.write((const char*)&out, sizeof(out)) &&
+                  writePadding(file, sizeof(out), out.vertexOffset) &&
+                  file.write((const char*)vertices, (std::streamsize)vertexBytes) &&
+                  writePadding(file, out.vertexOffset + vertexBytes, out.indexOffset) &&
+                  file.write((const char*)indices, (std::streamsize)indexBytes) &&
+                  writePadding(file, out.indexOffset + indexBytes, out.clusterOffset) &&
+                  file.write((const char*)clusters, (std::streamsize)clusterBytes) &&
+                  writePadding(file, out.clusterOffset + clusterBytes, out.meshletOffset) &&
+                  file.write((const char*)meshlets, (std::streamsize)meshletBytes);
+        if (!ok) {
+            std::cerr << "ERROR::MESHCACHE::Could not write cache file: " << tempPath << std::endl;
+            file.close();
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tempPath, cachePath, ec);
+    if (ec) {
+        std::cerr << "ERROR::MESHCACHE::Could not replace cache file: " << cachePath << std::endl;
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,96 @@
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "MappedFile.h"
+
+// 二进制网格缓存 (.meshcache)
+// 文件布局: [MeshCacheHeader][顶点数据][索引数据][三角形簇][meshlet]
+// 顶点和索引数据与 Mesh::setupMesh 上传到 VBO/EBO 的字节完全一致,
+// 读取时直接映射文件交给 glBufferData, 不做任何逐元素解析.
+
+const uint32_t MESH_CACHE_VERSION = 5;
+
+// layoutFlags 的位定义
+const uint32_t MESH_CACHE_HAS_NORMALS   = 1u << 0;
+const uint32_t MESH_CACHE_OPTIMIZED     = 1u << 1;  // 三角形和顶点顺序经过 optimizeMesh 重排
+const uint32_t MESH_CACHE_LAYOUT_SHIFT  = 8;      // bits 8..15: 顶点布局编号
+const uint32_t MESH_CACHE_LAYOUT_FLOAT32 = 0;     // Vertex: 3f 位置 + 3f 法线 + 2f UV
+const uint32_t MESH_CACHE_LAYOUT_PACKED16 = 1;    // PackedVertex: 量化位置 + 八面体法线 + half UV
+
+// 源文件指纹: 大小 + 修改时间 + 抽样哈希
+struct MeshCacheSource {
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    uint64_t hash = 0;
+};
+
+// 三角形簇 (见 MeshClusters.h)
+struct MeshCacheCluster {
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    float boundsMin[3];
+    float boundsMax[3];
+};
+
+// meshlet (见 MeshClusters.h)
+struct MeshCacheMeshlet {
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    float center[3];
+    float radius;
+    float coneAxis[3];
+    float coneCutoff;
+};
+
+struct MeshCacheHeader {
+    char magic[8];            // "OBJMESH\0"
+    uint32_t version;
+    uint32_t layoutFlags;
+    MeshCacheSource source;
+    uint32_t vertexStride;    // 每个顶点的字节数
+    uint32_t indexSize;       // 2 (uint16) 或 4 (uint32)
+    uint64_t vertexCount;
+    uint64_t indexCount;
+    uint64_t vertexOffset;    // 相对文件开头
+    uint64_t indexOffset;
+    float quantOffset[3];     // 压缩顶点的反量化参数
+    float quantScale[3];
+    uint64_t clusterCount;
+    uint64_t clusterOffset;
+    uint32_t normalsKey;      // 加载时生成法线所用的设置, 0 表示法线来自源文件 (或没有法线)
+    uint32_t reserved;
+    uint64_t meshletCount;
+    uint64_t meshletOffset;
+};
+
+class MeshCache {
+public:
+    MeshCacheHeader header{};
+    const void* vertexData = nullptr;
+    const void* indexData = nullptr;
+    const MeshCacheCluster* clusterData = nullptr;
+    const MeshCacheMeshlet* meshletData = nullptr;
+
+    // 映射缓存文件并校验 (版本, 源文件指纹, 数据范围), 失败或过期时返回 false
+    bool open(const std::string& cachePath, const MeshCacheSource& source);
+    void close();
+
+    // 写入缓存 (先写临时文件再改名, 避免留下半个文件)
+    // header 中的 magic, version 和各数据块偏移由 write 填写, 其余字段由调用者填写
+    static bool write(const std::string& cachePath, const MeshCacheHeader& header,
+                      const void* vertices, const void* indices, const MeshCacheCluster* clusters,
+                      const MeshCacheMeshlet* meshlets);
+
+    // 计算源文件指纹
+    static bool describeSource(const std::string& sourcePath, MeshCacheSource& source);
+
+    // 缓存路径: cacheDir 为空时写在源文件旁边
+    static std::string pathFor(const std::string& sourcePath, const std::string& cacheDir);
+
+private:
+    MappedFile file;
+};
+#endif
@@ -0,0 +1,144 @@
+#include "MeshClusters.h"
+#include <algorithm>
+#include <cmath>
+#include "Bvh.h"
+#include "SimdKernels.h"
+
+void buildMeshClusters(const std::vector<Vertex>& vertices, std::vector<uint32_t>& indices,
+                       std::vector<MeshCluster>& clusters) {
+    clusters.clear();
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) return;
+
+    // 每个三角形用中心点参与划分
+    std::vector<Aabb> centers(triangleCount);
+    for (size_t t = 0; t < triangleCount; ++t) {
+        glm::vec3 c = (vertices[indices[t * 3 + 0]].Position +
+                       vertices[indices[t * 3 + 1]].Position +
+                       vertices[indices[t * 3 + 2]].Position) / 3.0f;
+        centers[t].min = c;
+        centers[t].max = c;
+    }
+
+    // 划分树的叶子就是簇, 叶子在 items 中按深度优先顺序连续存放
+    Bvh tree;
+    tree.build(centers, CLUSTER_TRIANGLES);
+    std::vector<uint32_t> leafFirst;
+    for (const BvhNode& node : tree.nodes) {
+        if (node.left == 0) leafFirst.push_back(node.first);
+    }
+    std::sort(leafFirst.begin(), leafFirst.end());
+    leafFirst.push_back((uint32_t)triangleCount);
+
+    // 按叶子顺序重排三角形
+    std::vector<uint32_t> reordered(triangleCount * 3);
+    for (size_t t = 0; t < triangleCount; ++t) {
+        uint32_t source = tree.items[t];
+        reordered[t * 3 + 0] = indices[source * 3 + 0];
+        reordered[t * 3 + 1] = indices[source * 3 + 1];
+        reordered[t * 3 + 2] = indices[source * 3 + 2];
+    }
+    indices.swap(reordered);
+
+    // 簇的包围盒用实际顶点计算 (比中心点的包围盒大): 簇的角点位置先收集成 SoA, 再用 SIMD 内核做 min/max 归约.
+    // 网格的包围盒 (加载后自动适配视野用) 是所有簇的并集
+    clusters.resize(leafFirst.size() - 1);
+    std::vector<float> cornerX(CLUSTER_TRIANGLES * 3), cornerY(CLUSTER_TRIANGLES * 3), cornerZ(CLUSTER_TRIANGLES * 3);
+    for (size_t c = 0; c + 1 < leafFirst.size(); ++c) {
+        MeshCluster& cluster = clusters[c];
+        cluster.firstIndex = leafFirst[c] * 3;
+        cluster.indexCount = (leafFirst[c + 1] - leafFirst[c]) * 3;
+        if (cluster.indexCount > cornerX.size()) {
+            cornerX.resize(cluster.indexCount);
+            cornerY.resize(cluster.indexCount);
+            cornerZ.resize(cluster.indexCount);
+        }
+        for (uint32_t k = 0; k < cluster.indexCount; ++k) {
+            const glm::vec3& p = vertices[indices[cluster.firstIndex + k]].Position;
+            cornerX[k] = p.x;
+            cornerY[k] = p.y;
+            cornerZ[k] = p.z;
+        }
+        cluster.bounds = simdBounds(cornerX.data(), cornerY.data(), cornerZ.data(), cluster.indexCount);
+    }
+}
+
+void computeMeshletBounds(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, Meshlet& meshlet) {
+    uint32_t end = meshlet.firstIndex + meshlet.indexCount;
+
+    // 包围球: 包围盒中心 + 到最远顶点的距离
+    Aabb box;
+    for (uint32_t i = meshlet.firstIndex; i < end; ++i) box.grow(vertices[indices[i]].Position);
+    meshlet.center = box.center();
+    float radiusSquared = 0.0f;
+    for (uint32_t i = meshlet.firstIndex; i < end; ++i) {
+        glm::vec3 d = vertices[indices[i]].Position - meshlet.center;
+        radiusSquared = std::max(radiusSquared, glm::dot(d, d));
+    }
+    meshlet.radius = std::sqrt(radiusSquared);
+
+    // 法线锥: 轴为单位面法线的平均方向, 张角由与轴夹角最大的面法线决定 (退化三角形不参与)
+    glm::vec3 sum(0.0f);
+    for (uint32_t i = meshlet.firstIndex; i + 2 < end; i += 3) {
+        const glm::vec3& p0 = vertices[indices[i + 0]].Position;
+        glm::vec3 n = glm::cross(vertices[indices[i + 1]].Position - p0, vertices[indices[i + 2]].Position - p0);
+        float length = glm::length(n);
+        if (length > 0.0f) sum += n / length;
+    }
+    meshlet.coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+    meshlet.coneCutoff = 1.0f;
+    float sumLength = glm::length(sum);
+    if (!(sumLength > 0.0f)) return;
+    glm::vec3 axis = sum / sumLength;
+    float minDot = 1.0f;
+    for (uint32_t i = meshlet.firstIndex; i + 2 < end; i += 3) {
+        const glm::vec3& p0 = vertices[indices[i + 0]].Position;
+        glm::vec3 n = glm::cross(vertices[indices[i + 1]].Position - p0, vertices[indices[i + 2]].Position - p0);
+        float length = glm::length(n);
+        if (length > 0.0f) minDot = std::min(minDot, glm::dot(n / length, axis));
+    }
+    meshlet.coneAxis = axis;
+    if (minDot > 0.0f) meshlet.coneCutoff = std::sqrt(std::max(0.0f, 1.0f - minDot * minDot));
+}
+
+void buildMeshlets(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+                   std::vector<MeshCluster>& clusters, std::vector<Meshlet>& meshlets) {
+    meshlets.clear();
+    // 顶点最后一次出现在哪个 meshlet (用来统计当前 meshlet 引用的顶点数)
+    std::vector<uint32_t> lastMeshlet(vertices.size(), 0xFFFFFFFFu);
+
+    for (MeshCluster& cluster : clusters) {
+        cluster.firstMeshlet = (uint32_t)meshlets.size();
+        uint32_t end = cluster.firstIndex + cluster.indexCount;
+        uint32_t vertexCount = 0;
+        for (uint32_t i = cluster.firstIndex; i < end; i += 3) {
+            uint32_t id = (uint32_t)meshlets.size() - 1;
+            bool open = meshlets.size() > cluster.firstMeshlet;
+            uint32_t added = 0;
+            for (int k = 0; k < 3; ++k) {
+                uint32_t v = indices[i + k];
+                bool repeated = (k > 0 && indices[i + k - 1] == v) || (k > 1 && indices[i] == v);
+                if (!repeated && (!open || lastMeshlet[v] != id)) ++added;
+            }
+            if (!open || vertexCount + added > MESHLET_MAX_VERTICES ||
+                meshlets.back().indexCount / 3 + 1 > MESHLET_MAX_TRIANGLES) {
+                Meshlet meshlet;
+                meshlet.firstIndex = i;
+                meshlets.push_back(meshlet);
+                id = (uint32_t)meshlets.size() - 1;
+                vertexCount = 0;
+            }
+            for (int k = 0; k < 3; ++k) {
+                uint32_t v = indices[i + k];
+                if (lastMeshlet[v] != id) {
+                    lastMeshlet[v] = id;
+                    ++vertexCount;
+                }
+            }
+            meshlets.back().indexCount += 3;
+        }
+        cluster.meshletCount = (uint32_t)meshlets.size() - cluster.firstMeshlet;
+    }
+
+    for (Meshlet& meshlet : meshlets) computeMeshletBounds(vertices, indices, meshlet);
+}
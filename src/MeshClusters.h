@@ -0,0 +1,56 @@
+#ifndef MESH_CLUSTERS_H
+#define MESH_CLUSTERS_H
+
+#include <cstdint>
+#include <vector>
+#include "Bounds.h"
+#include "Vertex.h"
+
+// 每个簇最多包含的三角形数
+const uint32_t CLUSTER_TRIANGLES = 2048;
+
+// 每个 meshlet 最多引用的顶点数和三角形数 (与 mesh shader 常用的上限一致)
+const uint32_t MESHLET_MAX_VERTICES = 64;
+const uint32_t MESHLET_MAX_TRIANGLES = 124;
+
+// 三角形簇: 索引缓冲中连续的一段三角形和它们的包围盒 (模型空间)
+struct MeshCluster {
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    Aabb bounds;
+    uint32_t firstMeshlet = 0;  // 簇内的 meshlet 在 Mesh::meshlets 中连续存放
+    uint32_t meshletCount = 0;
+};
+
+// meshlet: 簇内更小的一段连续三角形, 带包围球和法线锥, 逐帧做视锥和背面剔除
+// 法线锥: 所有面法线与 coneAxis 的夹角不超过 a, coneCutoff = sin(a 的余角) = sqrt(1 - cos(a)^2);
+// 法线分布超过半球时 coneCutoff = 1, 永远不会被判为背面
+struct Meshlet {
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+    glm::vec3 coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+    float coneCutoff = 1.0f;
+};
+
+// meshlet 的所有三角形都背对 camera (模型空间): 包围球内任意一点看过去都在法线锥的背面
+inline bool meshletBackfacing(const Meshlet& meshlet, const glm::vec3& camera) {
+    glm::vec3 toCenter = meshlet.center - camera;
+    return glm::dot(toCenter, meshlet.coneAxis) >=
+           meshlet.coneCutoff * glm::length(toCenter) + meshlet.radius * (1.0f + meshlet.coneCutoff);
+}
+
+// 按三角形中心的空间位置把网格分成簇, 并重排 indices 使每个簇在索引缓冲中连续
+// 簇按空间划分树的叶子顺序排列, 相邻的簇在空间上也相邻
+void buildMeshClusters(const std::vector<Vertex>& vertices, std::vector<uint32_t>& indices,
+                       std::vector<MeshCluster>& clusters);
+
+// 按索引顺序把每个簇切成 meshlet (不超过 MESHLET_MAX_VERTICES / MESHLET_MAX_TRIANGLES), 填写簇的 meshlet 范围
+// 三角形顺序已按顶点缓存优化时 (MeshOptimize.h), 顺序切出的 meshlet 在空间上是紧凑的
+void buildMeshlets(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+                   std::vector<MeshCluster>& clusters, std::vector<Meshlet>& meshlets);
+
+// 由三角形计算 meshlet 的包围球和法线锥 (firstIndex / indexCount 已填写)
+void computeMeshletBounds(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, Meshlet& meshlet);
+#endif
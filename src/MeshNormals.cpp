@@ -0,0 +1,194 @@
+#include "MeshNormals.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include "Parallel.h"
+
+namespace {
+
+// 每个并行任务处理的三角形 (或位置) 数
+const size_t NORMAL_BLOCK = 16384;
+
+// 顶点分裂时认为两条法线相同的阈值 (约 0.8 度)
+const float SAME_NORMAL_DOT = 0.9999f;
+
+const uint32_t NO_VERTEX = 0xFFFFFFFFu;
+
+// 两条边的夹角, 退化的边返回 0
+float cornerAngle(const glm::vec3& a, const glm::vec3& b) {
+    float lengths = glm::length(a) * glm::length(b);
+    if (!(lengths > 0.0f)) return 0.0f;
+    return std::acos(std::clamp(glm::dot(a, b) / lengths, -1.0f, 1.0f));
+}
+
+// 归一化, 长度为 0 (所有相邻面都退化) 时返回 fallback
+glm::vec3 normalizeOr(const glm::vec3& v, const glm::vec3& fallback) {
+    float length = glm::length(v);
+    return length > 0.0f && std::isfinite(length) ? v / length : fallback;
+}
+
+// 按位置合并顶点: positionIds[v] 为同一位置的第一个顶点的编号 (开放寻址哈希表, 键为坐标的位模式)
+void weldPositions(const std::vector<Vertex>& vertices, std::vector<uint32_t>& positionIds) {
+    size_t capacity = 16;
+    while (capacity < vertices.size() * 2) capacity *= 2;
+    std::vector<uint32_t> table(capacity, NO_VERTEX);
+    auto bits = [](float value) {
+        uint32_t result;
+        value += 0.0f; // -0 与 +0 视为相同
+        memcpy(&result, &value, sizeof(result));
+        return result;
+    };
+
+    positionIds.resize(vertices.size());
+    for (size_t v = 0; v < vertices.size(); ++v) {
+        const glm::vec3& p = vertices[v].Position;
+        uint32_t x = bits(p.x), y = bits(p.y), z = bits(p.z);
+        size_t slot = ((size_t)x * 73856093u ^ (size_t)y * 19349663u ^ (size_t)z * 83492791u) & (capacity - 1);
+        for (;; slot = (slot + 1) & (capacity - 1)) {
+            uint32_t other = table[slot];
+            if (other == NO_VERTEX) {
+                table[slot] = (uint32_t)v;
+                positionIds[v] = (uint32_t)v;
+                break;
+            }
+            const glm::vec3& q = vertices[other].Position;
+            if (bits(q.x) == x && bits(q.y) == y && bits(q.z) == z) {
+                positionIds[v] = other;
+                break;
+            }
+        }
+    }
+}
+
+} // namespace
+
+NormalStats generateNormals(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, const NormalOptions& options) {
+    auto startTime = std::chrono::steady_clock::now();
+    NormalStats stats;
+
+    size_t triangleCount = indices.size() / 3;
+    size_t cornerCount = triangleCount * 3;
+    unsigned int workers = resolveThreadCount(options.threads);
+    size_t triangleBlocks = (triangleCount + NORMAL_BLOCK - 1) / NORMAL_BLOCK;
+    const glm::vec3 up(0.0f, 0.0f, 1.0f);
+
+    // 1. 面法线 (单位长度, 退化三角形为 0) 和每个角点的权重
+    std::vector<glm::vec3> faceNormals(triangleCount);
+    std::vector<float> cornerWeights(cornerCount);
+    parallelFor(triangleBlocks, workers, [&](size_t block) {
+        size_t end = std::min(triangleCount, (block + 1) * NORMAL_BLOCK);
+        for (size_t t = block * NORMAL_BLOCK; t < end; ++t) {
+            const glm::vec3& p0 = vertices[indices[3 * t + 0]].Position;
+            const glm::vec3& p1 = vertices[indices[3 * t + 1]].Position;
+            const glm::vec3& p2 = vertices[indices[3 * t + 2]].Position;
+            glm::vec3 cross = glm::cross(p1 - p0, p2 - p0);
+            float length = glm::length(cross);
+            if (!(length > 0.0f) || !std::isfinite(length)) {
+                faceNormals[t] = glm::vec3(0.0f);
+                cornerWeights[3 * t + 0] = cornerWeights[3 * t + 1] = cornerWeights[3 * t + 2] = 0.0f;
+                continue;
+            }
+            faceNormals[t] = cross / length;
+            if (options.weighting == NormalWeighting::Area) {
+                cornerWeights[3 * t + 0] = cornerWeights[3 * t + 1] = cornerWeights[3 * t + 2] = 0.5f * length;
+            } else {
+                cornerWeights[3 * t + 0] = cornerAngle(p1 - p0, p2 - p0);
+                cornerWeights[3 * t + 1] = cornerAngle(p2 - p1, p0 - p1);
+                cornerWeights[3 * t + 2] = cornerAngle(p0 - p2, p1 - p2);
+            }
+        }
+    });
+
+    // 2. 位置 -> 角点的邻接表 (CSR), 位置以合并后的第一个顶点编号表示
+    // 顺序扫描构建, 每个位置的角点按索引顺序排列, 这样后面的浮点累加顺序固定
+    std::vector<uint32_t> positionIds;
+    weldPositions(vertices, positionIds);
+    size_t positionCount = vertices.size();
+    auto positionOf = [&positionIds](uint32_t vertex) { return positionIds[vertex]; };
+
+    std::vector<uint32_t> cornerStart(positionCount + 1, 0);
+    for (size_t c = 0; c < cornerCount; ++c) ++cornerStart[positionOf(indices[c]) + 1];
+    for (size_t p = 0; p < positionCount; ++p) cornerStart[p + 1] += cornerStart[p];
+    std::vector<uint32_t> positionCorners(cornerCount);
+    {
+        std::vector<uint32_t> cursor(cornerStart.begin(), cornerStart.end() - 1);
+        for (size_t c = 0; c < cornerCount; ++c) positionCorners[cursor[positionOf(indices[c])]++] = (uint32_t)c;
+    }
+
+    float creaseAngle = options.creaseAngle;
+    if (creaseAngle <= 0.0f || creaseAngle >= 180.0f) {
+        // 3a. 没有折痕: 每个位置一条法线, 由该位置的所有角点加权求和 (每个位置只由一个线程写)
+        std::vector<glm::vec3> positionNormals(positionCount);
+        size_t positionBlocks = (positionCount + NORMAL_BLOCK - 1) / NORMAL_BLOCK;
+        parallelFor(positionBlocks, workers, [&](size_t block) {
+            size_t end = std::min(positionCount, (block + 1) * NORMAL_BLOCK);
+            for (size_t p = block * NORMAL_BLOCK; p < end; ++p) {
+                glm::vec3 sum(0.0f);
+                for (uint32_t i = cornerStart[p]; i < cornerStart[p + 1]; ++i) {
+                    uint32_t c = positionCorners[i];
+                    sum += faceNormals[c / 3] * cornerWeights[c];
+                }
+                positionNormals[p] = normalizeOr(sum, up);
+            }
+        });
+
+        size_t vertexBlocks = (vertices.size() + NORMAL_BLOCK - 1) / NORMAL_BLOCK;
+        parallelFor(vertexBlocks, workers, [&](size_t block) {
+            size_t end = std::min(vertices.size(), (block + 1) * NORMAL_BLOCK);
+            for (size_t v = block * NORMAL_BLOCK; v < end; ++v) vertices[v].Normal = positionNormals[positionOf((uint32_t)v)];
+        });
+    } else {
+        // 3b. 有折痕: 每个角点只累加与所在面夹角不超过折痕角的相邻面
+        float cosCrease = std::cos(glm::radians(creaseAngle));
+        std::vector<glm::vec3> cornerNormals(cornerCount);
+        parallelFor(triangleBlocks, workers, [&](size_t block) {
+            size_t end = std::min(triangleCount, (block + 1) * NORMAL_BLOCK);
+            for (size_t c = block * NORMAL_BLOCK * 3; c < end * 3; ++c) {
+                const glm::vec3& face = faceNormals[c / 3];
+                bool degenerate = face == glm::vec3(0.0f); // 退化三角形没有方向, 取全部相邻面
+                uint32_t p = positionOf(indices[c]);
+                glm::vec3 sum(0.0f);
+                for (uint32_t i = cornerStart[p]; i < cornerStart[p + 1]; ++i) {
+                    uint32_t other = positionCorners[i];
+                    const glm::vec3& otherFace = faceNormals[other / 3];
+                    if (degenerate || glm::dot(face, otherFace) >= cosCrease) sum += otherFace * cornerWeights[other];
+                }
+                cornerNormals[c] = normalizeOr(sum, degenerate ? up : face);
+            }
+        });
+
+        // 4. 同一顶点的角点法线不同时分裂顶点: 分身用链表串起来, 法线相同的角点共用一个分身
+        std::vector<uint32_t> nextCopy(vertices.size(), NO_VERTEX);
+        std::vector<char> assigned(vertices.size(), 0);
+        for (size_t c = 0; c < cornerCount; ++c) {
+            uint32_t vertex = indices[c];
+            const glm::vec3& normal = cornerNormals[c];
+            if (!assigned[vertex]) {
+                assigned[vertex] = 1;
+                vertices[vertex].Normal = normal;
+                continue;
+            }
+            for (uint32_t copy = vertex;; copy = nextCopy[copy]) {
+                if (glm::dot(vertices[copy].Normal, normal) >= SAME_NORMAL_DOT) {
+                    indices[c] = copy;
+                    break;
+                }
+                if (nextCopy[copy] == NO_VERTEX) {
+                    uint32_t added = (uint32_t)vertices.size();
+                    Vertex split = vertices[vertex];
+                    split.Normal = normal;
+                    vertices.push_back(split);
+                    nextCopy.push_back(NO_VERTEX);
+                    nextCopy[copy] = added;
+                    indices[c] = added;
+                    ++stats.splitVertices;
+                    break;
+                }
+            }
+        }
+    }
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return stats;
+}
@@ -0,0 +1,32 @@
+#ifndef MESH_NORMALS_H
+#define MESH_NORMALS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Vertex.h"
+
+// 面法线对顶点法线的权重
+enum class NormalWeighting {
+    Angle,  // 按角点处的内角 (与网格细分方式无关, 默认)
+    Area    // 按三角形面积
+};
+
+struct NormalOptions {
+    NormalWeighting weighting = NormalWeighting::Angle;
+    float creaseAngle = 0.0f;   // 折痕角 (度): 面法线夹角超过它的面不参与平滑, 顶点按需分裂; <= 0 或 >= 180 时全部平滑
+    unsigned int threads = 0;   // 0 = 硬件线程数
+};
+
+struct NormalStats {
+    size_t splitVertices = 0;   // 因折痕新增的顶点数
+    double seconds = 0.0;
+};
+
+// 为没有法线的网格生成平滑顶点法线, 写入 vertices[i].Normal
+// 位置完全相同的顶点 (UV 接缝处的分身, 或文件里重复的 'v') 视为同一点, 共享法线.
+// 各阶段都按三角形 (或位置) 分块并行, 每个输出只由一个线程写, 不需要锁;
+// 累加顺序固定, 结果与线程数无关.
+// 有折痕时 vertices 末尾会追加分裂出的顶点, indices 相应改写.
+NormalStats generateNormals(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, const NormalOptions& options);
+#endif
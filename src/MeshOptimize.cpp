@@ -0,0 +1,270 @@
+#include "MeshOptimize.h"
+#include <algorithm>
+#include <chrono>
+#include "Bounds.h"
+#include "Parallel.h"
+
+namespace {
+
+// FIFO 缓存模拟: 每次未命中时间加 1, 顶点写入缓存时记下时间;
+// 之后又有 cacheSize 次未命中时它就被挤出. 时间加 cacheSize + 1 相当于清空缓存
+class FifoCache {
+public:
+    FifoCache(size_t vertexCount, unsigned int cacheSize)
+        : stamps(vertexCount, 0), time(cacheSize + 1), cacheSize(cacheSize) {}
+
+    // 访问一个顶点, 未命中时返回 true
+    bool access(uint32_t vertex) {
+        if (time - stamps[vertex] <= cacheSize) return false;
+        stamps[vertex] = time++;
+        return true;
+    }
+    unsigned int triangleMisses(const uint32_t* triangle) {
+        return (unsigned int)access(triangle[0]) + access(triangle[1]) + access(triangle[2]);
+    }
+    void flush() { time += cacheSize + 1; }
+
+private:
+    std::vector<uint32_t> stamps;
+    uint32_t time;
+    uint32_t cacheSize;
+};
+
+// 在 Tipsify 的结果上切分子簇 (返回各子簇的起始三角形, 末尾是三角形总数)
+// 硬边界之间再按缓存模拟切分: 从子簇开头清空缓存重新计数, 累计 ACMR 降到
+// OVERDRAW_ACMR_THRESHOLD * 该段 ACMR 以下时就在这里切开, 这样子簇任意排列后 ACMR 也基本不变
+std::vector<uint32_t> subclusterBoundaries(const uint32_t* indices, size_t triangleCount, size_t vertexCount,
+                                           const std::vector<uint32_t>& hardBoundaries) {
+    std::vector<uint32_t> hard;
+    hard.push_back(0);
+    for (uint32_t boundary : hardBoundaries) {
+        if (boundary > hard.back() && boundary < triangleCount) hard.push_back(boundary);
+    }
+    hard.push_back((uint32_t)triangleCount);
+
+    FifoCache cache(vertexCount, VERTEX_CACHE_SIZE);
+    std::vector<uint32_t> result;
+    for (size_t h = 0; h + 1 < hard.size(); ++h) {
+        uint32_t first = hard[h], end = hard[h + 1];
+        cache.flush();
+        size_t rangeMisses = 0;
+        for (uint32_t t = first; t < end; ++t) rangeMisses += cache.triangleMisses(indices + 3 * t);
+        float threshold = OVERDRAW_ACMR_THRESHOLD * (float)rangeMisses / (float)(end - first);
+
+        result.push_back(first);
+        cache.flush();
+        size_t runMisses = 0, runTriangles = 0;
+        for (uint32_t t = first; t + 1 < end; ++t) {
+            runMisses += cache.triangleMisses(indices + 3 * t);
+            ++runTriangles;
+            if ((float)runMisses <= threshold * (float)runTriangles) {
+                result.push_back(t + 1);
+                cache.flush();
+                runMisses = runTriangles = 0;
+            }
+        }
+    }
+    result.push_back((uint32_t)triangleCount);
+    return result;
+}
+
+// 子簇按 "朝外程度" 从大到小排列: 面积加权的中心相对网格中心的偏移在子簇平均法线上的投影.
+// 朝外的面从大多数视角看都在前面, 先画它们可以让后面的片元被深度测试提前剔除 (Sander et al.)
+void sortSubclusters(uint32_t* localIndices, size_t triangleCount, const std::vector<uint32_t>& boundaries,
+                     const std::vector<uint32_t>& globalVertex, const std::vector<Vertex>& vertices,
+                     const glm::vec3& meshCenter) {
+    struct Subcluster {
+        float key;
+        uint32_t first, end;
+    };
+    std::vector<Subcluster> subclusters;
+    subclusters.reserve(boundaries.size());
+    for (size_t s = 0; s + 1 < boundaries.size(); ++s) {
+        glm::vec3 centroid(0.0f), normal(0.0f);
+        float area = 0.0f;
+        for (uint32_t t = boundaries[s]; t < boundaries[s + 1]; ++t) {
+            const glm::vec3& p0 = vertices[globalVertex[localIndices[3 * t + 0]]].Position;
+            const glm::vec3& p1 = vertices[globalVertex[localIndices[3 * t + 1]]].Position;
+            const glm::vec3& p2 = vertices[globalVertex[localIndices[3 * t + 2]]].Position;
+            glm::vec3 cross = glm::cross(p1 - p0, p2 - p0);
+            float triangleArea = glm::length(cross);
+            centroid += (p0 + p1 + p2) * (triangleArea / 3.0f);
+            normal += cross;
+            area += triangleArea;
+        }
+        float key = 0.0f;
+        float normalLength = glm::length(normal);
+        if (area > 0.0f && normalLength > 0.0f) key = glm::dot(centroid / area - meshCenter, normal / normalLength);
+        subclusters.push_back({ key, boundaries[s], boundaries[s + 1] });
+    }
+    std::stable_sort(subclusters.begin(), subclusters.end(),
+                     [](const Subcluster& a, const Subcluster& b) { return a.key > b.key; });
+
+    std::vector<uint32_t> sorted;
+    sorted.reserve(triangleCount * 3);
+    for (const Subcluster& subcluster : subclusters) {
+        sorted.insert(sorted.end(), localIndices + 3 * subcluster.first, localIndices + 3 * subcluster.end);
+    }
+    std::copy(sorted.begin(), sorted.end(), localIndices);
+}
+
+} // namespace
+
+VertexCacheStats analyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, unsigned int cacheSize) {
+    VertexCacheStats stats;
+    if (indices.size() < 3) return stats;
+
+    FifoCache cache(vertexCount, cacheSize);
+    std::vector<char> used(vertexCount, 0);
+    size_t misses = 0, usedCount = 0;
+    for (uint32_t index : indices) {
+        if (cache.access(index)) ++misses;
+        if (!used[index]) {
+            used[index] = 1;
+            ++usedCount;
+        }
+    }
+    stats.acmr = (float)misses / (float)(indices.size() / 3);
+    stats.atvr = (float)misses / (float)usedCount;
+    return stats;
+}
+
+void optimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount,
+                         std::vector<uint32_t>* hardBoundaries) {
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0) return;
+    const uint32_t cacheSize = VERTEX_CACHE_SIZE;
+
+    // 顶点 -> 三角形邻接表 (CSR), liveTriangles: 每个顶点还没输出的三角形数
+    std::vector<uint32_t> adjacencyStart(vertexCount + 1, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i) ++adjacencyStart[indices[i] + 1];
+    std::vector<uint32_t> liveTriangles(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        liveTriangles[v] = adjacencyStart[v + 1];
+        adjacencyStart[v + 1] += adjacencyStart[v];
+    }
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    {
+        std::vector<uint32_t> cursor(adjacencyStart.begin(), adjacencyStart.end() - 1);
+        for (size_t i = 0; i < triangleCount * 3; ++i) adjacency[cursor[indices[i]]++] = (uint32_t)(i / 3);
+    }
+
+    std::vector<uint32_t> cacheStamps(vertexCount, 0);
+    uint32_t time = cacheSize + 1;
+    std::vector<char> emitted(triangleCount, 0);
+    std::vector<uint32_t> deadEnd;  // 最近输出的顶点, 走到死路时从这里找下一个扇形中心
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> output;
+    output.reserve(triangleCount * 3);
+    size_t scan = 0;                // 死路栈也空了时按编号顺序扫描
+
+    long long fanning = indices[0];
+    while (fanning >= 0) {
+        // 输出扇形中心周围所有还没输出的三角形
+        candidates.clear();
+        for (uint32_t a = adjacencyStart[fanning]; a < adjacencyStart[fanning + 1]; ++a) {
+            uint32_t t = adjacency[a];
+            if (emitted[t]) continue;
+            emitted[t] = 1;
+            for (int k = 0; k < 3; ++k) {
+                uint32_t v = indices[3 * t + k];
+                output.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                --liveTriangles[v];
+                if (time - cacheStamps[v] > cacheSize) cacheStamps[v] = time++;
+            }
+        }
+
+        // 下一个扇形中心: 候选中展开后仍留在缓存里的, 取在缓存中最久的; 都不满足时取任一仍有三角形的
+        fanning = -1;
+        long long bestPriority = -1;
+        for (uint32_t v : candidates) {
+            if (liveTriangles[v] == 0) continue;
+            long long priority = 0;
+            if (time - cacheStamps[v] + 2 * liveTriangles[v] <= cacheSize) priority = time - cacheStamps[v];
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                fanning = v;
+            }
+        }
+        if (fanning >= 0) continue;
+
+        // 死路: 先回溯最近输出的顶点, 再顺序扫描 (扫描跳转处缓存内容与之后无关, 记为硬边界)
+        while (!deadEnd.empty()) {
+            uint32_t v = deadEnd.back();
+            deadEnd.pop_back();
+            if (liveTriangles[v] > 0) {
+                fanning = v;
+                break;
+            }
+        }
+        if (fanning >= 0) continue;
+        while (scan < vertexCount && liveTriangles[scan] == 0) ++scan;
+        if (scan < vertexCount) {
+            fanning = (long long)scan;
+            if (hardBoundaries) hardBoundaries->push_back((uint32_t)(output.size() / 3));
+        }
+    }
+    std::copy(output.begin(), output.end(), indices);
+}
+
+MeshOptimizeStats optimizeMesh(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices,
+                               const std::vector<MeshCluster>& clusters, unsigned int threads) {
+    auto startTime = std::chrono::steady_clock::now();
+    MeshOptimizeStats stats;
+    stats.before = analyzeVertexCache(indices, vertices.size());
+
+    // 网格中心用包围盒中心近似
+    Aabb bounds;
+    for (const MeshCluster& cluster : clusters) bounds.grow(cluster.bounds);
+    glm::vec3 meshCenter = clusters.empty() ? glm::vec3(0.0f) : (bounds.min + bounds.max) * 0.5f;
+
+    // 1, 2. 各簇独立: 换成簇内的局部顶点编号, Tipsify, 切分并排序子簇, 再写回全局编号
+    parallelFor(clusters.size(), resolveThreadCount(threads), [&](size_t c) {
+        const MeshCluster& cluster = clusters[c];
+        uint32_t* clusterIndices = indices.data() + cluster.firstIndex;
+        size_t indexCount = cluster.indexCount;
+        if (indexCount < 3) return;
+
+        // (全局编号 << 32 | 位置) 排序一次, 同一全局编号的位置连续, 依次分配局部编号
+        std::vector<uint64_t> keys(indexCount);
+        for (size_t i = 0; i < indexCount; ++i) keys[i] = ((uint64_t)clusterIndices[i] << 32) | (uint64_t)i;
+        std::sort(keys.begin(), keys.end());
+        std::vector<uint32_t> globalVertex;
+        std::vector<uint32_t> local(indexCount);
+        for (size_t i = 0; i < indexCount; ++i) {
+            uint32_t global = (uint32_t)(keys[i] >> 32);
+            if (globalVertex.empty() || globalVertex.back() != global) globalVertex.push_back(global);
+            local[(uint32_t)keys[i]] = (uint32_t)globalVertex.size() - 1;
+        }
+
+        std::vector<uint32_t> hardBoundaries;
+        optimizeVertexCache(local.data(), indexCount, globalVertex.size(), &hardBoundaries);
+        std::vector<uint32_t> boundaries =
+            subclusterBoundaries(local.data(), indexCount / 3, globalVertex.size(), hardBoundaries);
+        if (boundaries.size() > 2) {
+            sortSubclusters(local.data(), indexCount / 3, boundaries, globalVertex, vertices, meshCenter);
+        }
+
+        for (size_t i = 0; i < indexCount; ++i) clusterIndices[i] = globalVertex[local[i]];
+    });
+
+    // 3. 顶点按首次使用的顺序重新编号
+    const uint32_t unused = 0xFFFFFFFFu;
+    std::vector<uint32_t> remap(vertices.size(), unused);
+    uint32_t next = 0;
+    for (uint32_t& index : indices) {
+        if (remap[index] == unused) remap[index] = next++;
+        index = remap[index];
+    }
+    std::vector<Vertex> reordered(next);
+    for (size_t v = 0; v < vertices.size(); ++v) {
+        if (remap[v] != unused) reordered[remap[v]] = vertices[v];
+    }
+    vertices.swap(reordered);
+
+    stats.after = analyzeVertexCache(indices, vertices.size());
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return stats;
+}
@@ -0,0 +1,42 @@
+#ifndef MESH_OPTIMIZE_H
+#define MESH_OPTIMIZE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Vertex.h"
+#include "MeshClusters.h"
+
+// 顶点缓存模拟和 Tipsify 使用的缓存大小 (FIFO, 顶点个数)
+const unsigned int VERTEX_CACHE_SIZE = 16;
+
+// 子簇排序时允许的 ACMR 增幅: 子簇切分后的 ACMR 不超过原 ACMR 的这个倍数
+const float OVERDRAW_ACMR_THRESHOLD = 1.05f;
+
+// 顶点缓存效率 (FIFO 模拟)
+struct VertexCacheStats {
+    float acmr = 0.0f;  // 平均每个三角形的缓存未命中数 (0.5 ~ 3, 越低越好)
+    float atvr = 0.0f;  // 未命中数 / 被引用的顶点数 (1 为最优)
+};
+
+VertexCacheStats analyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount,
+                                    unsigned int cacheSize = VERTEX_CACHE_SIZE);
+
+// Tipsify (Sander, Nehab, Barczak 2007): 重排 [indices, indices + indexCount) 中的三角形, 提高顶点缓存命中率
+// 索引必须小于 vertexCount; hardBoundaries 非空时写入缓存实际被清空的位置 (三角形序号, 用于切分子簇)
+void optimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount,
+                         std::vector<uint32_t>* hardBoundaries = nullptr);
+
+struct MeshOptimizeStats {
+    VertexCacheStats before;
+    VertexCacheStats after;
+    double seconds = 0.0;
+};
+
+// 加载后的三步优化, 各簇 (MeshClusters.h) 在索引缓冲中的范围和包围盒不变:
+//   1. 每个簇内用 Tipsify 重排三角形 (簇之间并行)
+//   2. 簇内按缓存模拟切成子簇, 外朝向的子簇先画 (减少过绘制), ACMR 最多增加到 OVERDRAW_ACMR_THRESHOLD 倍
+//   3. 顶点按在索引缓冲中首次出现的顺序重新编号, 顶点缓冲顺序读取 (没有被引用的顶点被删除)
+MeshOptimizeStats optimizeMesh(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices,
+                               const std::vector<MeshCluster>& clusters, unsigned int threads = 0);
+#endif
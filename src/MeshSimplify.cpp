@@ -0,0 +1,324 @@
+#include "MeshSimplify.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include "MeshOptimize.h"
+#include "Parallel.h"
+
+namespace {
+
+const uint32_t NO_VERTEX = 0xFFFFFFFFu;
+
+// 每个并行任务处理的边数
+const size_t EDGES_PER_TASK = 64 * 1024;
+
+// 每轮至少允许误差最小的 1/N 的候选折叠
+const size_t MIN_PASS_FRACTION = 8;
+
+// 误差二次型: 对称 4x4 矩阵的 10 个元素 + 面积权重
+struct Quadric {
+    double a00 = 0, a01 = 0, a02 = 0, a03 = 0;
+    double a11 = 0, a12 = 0, a13 = 0;
+    double a22 = 0, a23 = 0;
+    double a33 = 0;
+    double weight = 0;
+
+    void add(const Quadric& q) {
+        a00 += q.a00; a01 += q.a01; a02 += q.a02; a03 += q.a03;
+        a11 += q.a11; a12 += q.a12; a13 += q.a13;
+        a22 += q.a22; a23 += q.a23;
+        a33 += q.a33;
+        weight += q.weight;
+    }
+
+    // 平面 n.p + d = 0 (n 为单位向量), 权重 w
+    static Quadric fromPlane(double nx, double ny, double nz, double d, double w) {
+        Quadric q;
+        q.a00 = w * nx * nx; q.a01 = w * nx * ny; q.a02 = w * nx * nz; q.a03 = w * nx * d;
+        q.a11 = w * ny * ny; q.a12 = w * ny * nz; q.a13 = w * ny * d;
+        q.a22 = w * nz * nz; q.a23 = w * nz * d;
+        q.a33 = w * d * d;
+        q.weight = w;
+        return q;
+    }
+
+    // 点到各平面距离平方的加权平均
+    float error(const glm::vec3& p) const {
+        double x = p.x, y = p.y, z = p.z;
+        double e = a00 * x * x + 2.0 * a01 * x * y + 2.0 * a02 * x * z + 2.0 * a03 * x +
+                   a11 * y * y + 2.0 * a12 * y * z + 2.0 * a13 * y +
+                   a22 * z * z + 2.0 * a23 * z +
+                   a33;
+        return weight > 0.0 ? (float)(std::fabs(e) / weight) : 0.0f;
+    }
+};
+
+// 把顶点 from 折叠到顶点 to (都是焊接后的代表顶点)
+struct Collapse {
+    uint32_t from;
+    uint32_t to;
+    float cost;
+};
+
+// 按位比较位置 (只合并完全相同的位置)
+struct PositionHash {
+    size_t operator()(const glm::vec3& p) const {
+        uint32_t h[3];
+        memcpy(h, &p, sizeof(h));
+        return (size_t)(h[0] * 73856093u) ^ (size_t)(h[1] * 19349663u) ^ (size_t)(h[2] * 83492791u);
+    }
+};
+
+struct PositionEqual {
+    bool operator()(const glm::vec3& a, const glm::vec3& b) const {
+        return memcmp(&a, &b, sizeof(glm::vec3)) == 0;
+    }
+};
+
+inline uint64_t edgeKey(uint32_t a, uint32_t b) {
+    return a < b ? ((uint64_t)a << 32) | b : ((uint64_t)b << 32) | a;
+}
+
+inline glm::vec3 triangleNormal(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+    return glm::cross(b - a, c - a);
+}
+
+} // namespace
+
+float simplifyMesh(const std::vector<glm::vec3>& positions, const std::vector<glm::vec3>& normals,
+                   const std::vector<uint32_t>& indices, size_t targetIndexCount,
+                   std::vector<uint32_t>& result, const std::atomic<bool>* cancel) {
+    result = indices;
+    size_t vertexCount = positions.size();
+    if (result.size() <= targetIndexCount || vertexCount == 0) return 0.0f;
+    bool useNormals = normals.size() == vertexCount;
+    size_t targetTriangles = targetIndexCount / 3;
+
+    // 位置焊接: canon[v] 为同一位置上的第一个顶点, 同一位置的分身用 nextWedge 串成链表
+    std::vector<uint32_t> canon(vertexCount);
+    std::vector<uint32_t> nextWedge(vertexCount, NO_VERTEX);
+    {
+        std::unordered_map<glm::vec3, uint32_t, PositionHash, PositionEqual> firstAt;
+        firstAt.reserve(vertexCount);
+        for (uint32_t v = 0; v < (uint32_t)vertexCount; ++v) {
+            uint32_t c = firstAt.emplace(positions[v], v).first->second;
+            canon[v] = c;
+            if (c != v) {
+                nextWedge[v] = nextWedge[c];
+                nextWedge[c] = v;
+            }
+        }
+    }
+
+    // 每个代表顶点的误差二次型: 相邻三角形平面按面积加权
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t t = 0; t < result.size() / 3; ++t) {
+        uint32_t a = canon[result[t * 3 + 0]], b = canon[result[t * 3 + 1]], c = canon[result[t * 3 + 2]];
+        glm::vec3 n = triangleNormal(positions[a], positions[b], positions[c]);
+        double length = std::sqrt((double)n.x * n.x + (double)n.y * n.y + (double)n.z * n.z);
+        if (length == 0.0) continue;
+        double nx = n.x / length, ny = n.y / length, nz = n.z / length;
+        double d = -(nx * positions[a].x + ny * positions[a].y + nz * positions[a].z);
+        Quadric q = Quadric::fromPlane(nx, ny, nz, d, length * 0.5);
+        quadrics[a].add(q);
+        quadrics[b].add(q);
+        quadrics[c].add(q);
+    }
+
+    // 当前三角形的全部无向边 (去重前的条数用于判断开放边界)
+    std::vector<uint64_t> edges;
+    auto collectEdges = [&]() {
+        edges.clear();
+        for (size_t t = 0; t < result.size() / 3; ++t) {
+            for (int e = 0; e < 3; ++e) {
+                uint32_t u = canon[result[t * 3 + e]];
+                uint32_t v = canon[result[t * 3 + (e + 1) % 3]];
+                if (u != v) edges.push_back(edgeKey(u, v));
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+    };
+
+    // 开放边界 (只属于一个三角形的边) 上的顶点不移动, 保持轮廓
+    std::vector<uint8_t> locked(vertexCount, 0);
+    collectEdges();
+    for (size_t i = 0; i < edges.size();) {
+        size_t j = i + 1;
+        while (j < edges.size() && edges[j] == edges[i]) ++j;
+        if (j - i == 1) {
+            locked[edges[i] >> 32] = 1;
+            locked[edges[i] & 0xFFFFFFFFu] = 1;
+        }
+        i = j;
+    }
+
+    unsigned int workers = resolveThreadCount(0);
+    float maxCost = 0.0f;
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> adjacencyStart(vertexCount + 1);
+    std::vector<uint32_t> adjacency;
+    std::vector<uint32_t> collapseTarget(vertexCount, NO_VERTEX);
+    std::vector<uint8_t> touched(vertexCount, 0);
+
+    // 每一轮: 按误差从小到大做一批互不相邻的折叠, 然后重写三角形
+    while (result.size() > targetIndexCount) {
+        if (cancel && cancel->load()) break;
+        size_t triangleCount = result.size() / 3;
+
+        collectEdges();
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+        // 每条边选择误差较小的折叠方向 (不能移动锁定的顶点)
+        collapses.resize(edges.size());
+        size_t taskCount = (edges.size() + EDGES_PER_TASK - 1) / EDGES_PER_TASK;
+        parallelFor(taskCount, workers, [&](size_t task) {
+            size_t end = std::min(edges.size(), (task + 1) * EDGES_PER_TASK);
+            for (size_t i = task * EDGES_PER_TASK; i < end; ++i) {
+                uint32_t u = (uint32_t)(edges[i] >> 32);
+                uint32_t v = (uint32_t)(edges[i] & 0xFFFFFFFFu);
+                Quadric q = quadrics[u];
+                q.add(quadrics[v]);
+                float costUV = locked[u] ? INFINITY : q.error(positions[v]);
+                float costVU = locked[v] ? INFINITY : q.error(positions[u]);
+                collapses[i] = costUV <= costVU ? Collapse{ u, v, costUV } : Collapse{ v, u, costVU };
+            }
+        });
+        collapses.erase(std::remove_if(collapses.begin(), collapses.end(),
+                                       [](const Collapse& c) { return std::isinf(c.cost); }),
+                        collapses.end());
+        if (collapses.empty()) break;
+        std::sort(collapses.begin(), collapses.end(),
+                  [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+        // 每次折叠大约去掉 2 个三角形; 本轮误差上限取 "刚好够用" 那次折叠误差的 1.5 倍,
+        // 避免因为相邻冲突跳过的折叠被误差大得多的折叠顶替.
+        // 接近目标时至少放开一部分候选, 否则每轮只能折叠极少的边
+        size_t needed = (triangleCount - targetTriangles) / 2 + 1;
+        size_t goal = std::min(collapses.size(), std::max(needed, collapses.size() / MIN_PASS_FRACTION));
+        float costLimit = collapses[goal - 1].cost * 1.5f + 1e-12f;
+
+        // 代表顶点 -> 相邻三角形 (CSR)
+        std::fill(adjacencyStart.begin(), adjacencyStart.end(), 0);
+        for (uint32_t index : result) ++adjacencyStart[canon[index] + 1];
+        for (size_t v = 0; v < vertexCount; ++v) adjacencyStart[v + 1] += adjacencyStart[v];
+        adjacency.resize(result.size());
+        {
+            std::vector<uint32_t> cursor(adjacencyStart.begin(), adjacencyStart.end() - 1);
+            for (size_t i = 0; i < result.size(); ++i) adjacency[cursor[canon[result[i]]]++] = (uint32_t)(i / 3);
+        }
+
+        std::fill(touched.begin(), touched.end(), 0);
+        size_t removed = 0;
+        size_t applied = 0;
+        for (const Collapse& collapse : collapses) {
+            if (collapse.cost > costLimit && applied > 0) break;
+            if (touched[collapse.from] || touched[collapse.to]) continue;
+
+            // 翻转检查: from 移到 to 之后, 其余相邻三角形的朝向不能反转
+            const glm::vec3& target = positions[collapse.to];
+            bool flips = false;
+            size_t degenerate = 0;
+            for (uint32_t a = adjacencyStart[collapse.from]; a < adjacencyStart[collapse.from + 1] && !flips; ++a) {
+                uint32_t t = adjacency[a];
+                uint32_t corner[3] = { canon[result[t * 3 + 0]], canon[result[t * 3 + 1]], canon[result[t * 3 + 2]] };
+                if (corner[0] == collapse.to || corner[1] == collapse.to || corner[2] == collapse.to) {
+                    ++degenerate;
+                    continue;
+                }
+                glm::vec3 p[3], q[3];
+                for (int k = 0; k < 3; ++k) {
+                    p[k] = positions[corner[k]];
+                    q[k] = corner[k] == collapse.from ? target : p[k];
+                }
+                glm::vec3 before = triangleNormal(p[0], p[1], p[2]);
+                glm::vec3 after = triangleNormal(q[0], q[1], q[2]);
+                flips = glm::dot(before, after) <= 1e-2f * glm::length(before) * glm::length(after);
+            }
+            if (flips) continue;
+
+            collapseTarget[collapse.from] = collapse.to;
+            quadrics[collapse.to].add(quadrics[collapse.from]);
+            maxCost = std::max(maxCost, collapse.cost);
+
+            // from 周围的三角形本轮都会改变, 它们的顶点本轮不再参与折叠
+            for (uint32_t a = adjacencyStart[collapse.from]; a < adjacencyStart[collapse.from + 1]; ++a) {
+                uint32_t t = adjacency[a];
+                for (int k = 0; k < 3; ++k) touched[canon[result[t * 3 + k]]] = 1;
+            }
+            removed += degenerate;
+            ++applied;
+            if (triangleCount - removed <= targetTriangles) break;
+        }
+        if (applied == 0) break;
+
+        // 重写三角形: 被折叠的角点换成目标位置上法线最接近的分身, 去掉退化三角形
+        size_t write = 0;
+        for (size_t t = 0; t < triangleCount; ++t) {
+            uint32_t vertex[3];
+            uint32_t position[3];
+            for (int k = 0; k < 3; ++k) {
+                uint32_t v = result[t * 3 + k];
+                uint32_t to = collapseTarget[canon[v]];
+                if (to != NO_VERTEX) {
+                    uint32_t best = to;
+                    if (useNormals) {
+                        float bestDot = -2.0f;
+                        for (uint32_t w = to; w != NO_VERTEX; w = nextWedge[w]) {
+                            float d = glm::dot(normals[w], normals[v]);
+                            if (d > bestDot) {
+                                bestDot = d;
+                                best = w;
+                            }
+                        }
+                    }
+                    v = best;
+                }
+                vertex[k] = v;
+                position[k] = canon[v];
+            }
+            if (position[0] == position[1] || position[1] == position[2] || position[0] == position[2]) continue;
+            result[write * 3 + 0] = vertex[0];
+            result[write * 3 + 1] = vertex[1];
+            result[write * 3 + 2] = vertex[2];
+            ++write;
+        }
+        result.resize(write * 3);
+
+        for (const Collapse& collapse : collapses) collapseTarget[collapse.from] = NO_VERTEX;
+    }
+    return std::sqrt(maxCost);
+}
+
+LodChain buildLodChain(const std::vector<glm::vec3>& positions, const std::vector<glm::vec3>& normals,
+                       const std::vector<uint32_t>& indices, const std::atomic<bool>* cancel) {
+    auto startTime = std::chrono::steady_clock::now();
+    LodChain chain;
+
+    std::vector<uint32_t> source = indices;
+    std::vector<uint32_t> simplified;
+    float error = 0.0f;
+    for (int level = 1; level < MAX_LOD_LEVELS; ++level) {
+        size_t target = (size_t)((double)(indices.size() / 3) * LOD_TRIANGLE_RATIOS[level - 1]) * 3;
+        error = std::max(error, simplifyMesh(positions, normals, source, target, simplified, cancel));
+        if (cancel && cancel->load()) break;
+
+        // 三角形数几乎没有减少 (例如大部分顶点在开放边界上), 后面的级别没有意义
+        if (simplified.empty() || simplified.size() > source.size() * 9 / 10) break;
+
+        // 折叠后的三角形顺序不再连贯, 按顶点缓存重排 (不影响下一级的简化)
+        optimizeVertexCache(simplified.data(), simplified.size(), positions.size());
+
+        MeshLod lod;
+        lod.firstIndex = (uint32_t)chain.indices.size();
+        lod.indexCount = (uint32_t)simplified.size();
+        lod.error = error;
+        chain.levels.push_back(lod);
+        chain.indices.insert(chain.indices.end(), simplified.begin(), simplified.end());
+        source.swap(simplified);
+    }
+
+    chain.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return chain;
+}
@@ -0,0 +1,44 @@
+#ifndef MESH_SIMPLIFY_H
+#define MESH_SIMPLIFY_H
+
+#include <glm/glm.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 细节层次 (LOD) 级数, 包括原网格 (第 0 级)
+const int MAX_LOD_LEVELS = 5;
+
+// 第 1..4 级相对原网格的三角形比例
+const float LOD_TRIANGLE_RATIOS[MAX_LOD_LEVELS - 1] = { 0.5f, 0.25f, 0.125f, 0.0625f };
+
+// 一级 LOD: 网格索引数据中的一段三角形
+struct MeshLod {
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    float error = 0.0f;      // 简化误差 (模型空间距离)
+};
+
+// 二次误差度量 (QEM) 边折叠简化
+// 位置相同的顶点 (法线/UV 不同的分身) 一起折叠, 折叠后每个角点选择
+// 目标位置上法线最接近的分身, 因此结果只引用原有顶点, 可以与原网格共用顶点缓冲.
+// 开放边界上的顶点保持不动, 会让三角形翻转的折叠被拒绝.
+//
+// 输入 indices 可以是已经简化过的索引 (用来逐级生成 LOD 链)
+// 返回达到的误差; cancel 置位时尽快返回 (结果为部分简化)
+float simplifyMesh(const std::vector<glm::vec3>& positions, const std::vector<glm::vec3>& normals,
+                   const std::vector<uint32_t>& indices, size_t targetIndexCount,
+                   std::vector<uint32_t>& result, const std::atomic<bool>* cancel = nullptr);
+
+// 第 1 级以后的 LOD 链, levels[i].firstIndex 指向 indices
+struct LodChain {
+    std::vector<MeshLod> levels;
+    std::vector<uint32_t> indices;
+    double seconds = 0.0;      // 生成耗时
+};
+
+// 按 LOD_TRIANGLE_RATIOS 逐级简化 (每级从上一级开始), 简化不动时提前结束
+LodChain buildLodChain(const std::vector<glm::vec3>& positions, const std::vector<glm::vec3>& normals,
+                       const std::vector<uint32_t>& indices, const std::atomic<bool>* cancel = nullptr);
+#endif
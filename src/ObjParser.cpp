@@ -0,0 +1,430 @@
+#include "ObjParser.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+
+namespace {
+
+// 每个线程分到的分块数, 多切几块用于负载均衡
+const unsigned int CHUNKS_PER_THREAD = 4;
+
+// 行内空白 (不含换行)
+inline bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+inline void skipBlanks(const char*& p, const char* end) {
+    while (p < end && isBlank(*p)) ++p;
+}
+
+// 跳到下一行的开头
+inline void skipLine(const char*& p, const char* end) {
+    const char* newline = (const char*)memchr(p, '\n', end - p);
+    p = newline ? newline + 1 : end;
+}
+
+inline bool atLineEnd(const char* p, const char* end) {
+    return p >= end || *p == '\n';
+}
+
+inline bool atTokenEnd(const char* p, const char* end) {
+    return p >= end || isBlank(*p) || *p == '\n';
+}
+
+// 读取一个浮点数; 行尾缺省的分量按 0 处理 (与原 stringstream 行为一致)
+inline bool parseFloat(const char*& p, const char* end, float& value) {
+    skipBlanks(p, end);
+    if (atLineEnd(p, end)) {
+        value = 0.0f;
+        return true;
+    }
+    if (*p == '+') ++p; // from_chars 不接受前导 '+'
+    auto result = std::from_chars(p, end, value);
+    if (result.ec != std::errc()) return false;
+    p = result.ptr;
+    return true;
+}
+
+// 读取一个 (可能为负的) 整数索引
+inline bool parseIndex(const char*& p, const char* end, int32_t& value) {
+    if (p < end && *p == '+') ++p;
+    auto result = std::from_chars(p, end, value);
+    if (result.ec != std::errc()) return false;
+    p = result.ptr;
+    return true;
+}
+
+// 把负索引换算成 "相对本分块起点" 的 0 起始偏移 (可能为负, 指向前面的分块)
+inline void makeRelative(ObjCorner& corner, int slot, size_t localCount) {
+    if (corner.idx[slot] < 0) {
+        corner.idx[slot] = (int32_t)((long long)localCount + corner.idx[slot]);
+        corner.relativeMask |= 1u << slot;
+    }
+}
+
+// 解析 "f" 行的全部角点并三角化, 失败时返回 false
+// 支持 'f v', 'f v/vt', 'f v//vn', 'f v/vt/vn', 多于 3 个角点时按扇形三角化
+bool parseFace(const char*& p, const char* end, ObjChunk& chunk) {
+    ObjCorner first{}, previous{};
+    int cornerCount = 0;
+
+    while (true) {
+        skipBlanks(p, end);
+        if (atLineEnd(p, end)) break;
+
+        // idx[0] = v, idx[1] = vt, idx[2] = vn, 0 表示缺省
+        ObjCorner corner{};
+        bool ok = parseIndex(p, end, corner.idx[0]);
+        if (ok && p < end && *p == '/') {
+            ++p;
+            if (p < end && *p != '/' && !atTokenEnd(p, end)) {
+                ok = parseIndex(p, end, corner.idx[1]);
+            }
+            if (ok && p < end && *p == '/') {
+                ++p;
+                if (!atTokenEnd(p, end)) {
+                    ok = parseIndex(p, end, corner.idx[2]);
+                }
+            }
+        }
+        if (!ok || !atTokenEnd(p, end) || corner.idx[0] == 0) return false;
+
+        makeRelative(corner, 0, chunk.positions.size());
+        makeRelative(corner, 1, chunk.texCoords.size());
+        makeRelative(corner, 2, chunk.normals.size());
+
+        // 扇形三角化: (first, previous, current), 不足 3 个角点的面被丢弃
+        if (cornerCount == 0) {
+            first = corner;
+        } else if (cornerCount >= 2) {
+            chunk.corners.push_back(first);
+            chunk.corners.push_back(previous);
+            chunk.corners.push_back(corner);
+        }
+        previous = corner;
+        ++cornerCount;
+    }
+    return true;
+}
+
+// 去重用的键: 全局 0 起始的 (v, vt, vn), -1 表示缺省
+struct CornerKey {
+    int32_t v, vt, vn;
+    bool operator==(const CornerKey& other) const {
+        return v == other.v && vt == other.vt && vn == other.vn;
+    }
+};
+
+struct CornerKeyHash {
+    size_t operator()(const CornerKey& key) const {
+        uint64_t h = (uint64_t)(uint32_t)key.v * 0x9E3779B97F4A7C15ull;
+        h ^= ((uint64_t)(uint32_t)key.vt + 0x632BE59BD9B4E019ull) * 0xC2B2AE3D27D4EB4Full;
+        h ^= ((uint64_t)(uint32_t)key.vn + 0x85EBCA77C2B2AE63ull) * 0x165667B19E3779F9ull;
+        return (size_t)(h ^ (h >> 29));
+    }
+};
+
+using VertexMap = std::unordered_map<CornerKey, uint32_t, CornerKeyHash, std::equal_to<CornerKey>,
+                                     ArenaAllocator<std::pair<const CornerKey, uint32_t>>>;
+
+template <typename T, typename Allocator>
+size_t capacityBytes(const std::vector<T, Allocator>& values) {
+    return values.capacity() * sizeof(T);
+}
+
+// 分块中各类元素的个数 (解析前的计数扫描)
+struct ChunkCounts {
+    size_t positions = 0, normals = 0, texCoords = 0, corners = 0;
+};
+
+// 只看行首关键字和面的角点个数, 不转换数字; 格式错误的行照样计入 (只影响预留的大小)
+ChunkCounts countChunk(const char* begin, const char* end) {
+    ChunkCounts counts;
+    const char* p = begin;
+    while (p < end) {
+        skipBlanks(p, end);
+        const char* key = p;
+        while (!atTokenEnd(p, end)) ++p;
+        size_t keyLen = p - key;
+
+        if (keyLen == 1 && key[0] == 'v') {
+            ++counts.positions;
+        } else if (keyLen == 2 && key[0] == 'v' && key[1] == 'n') {
+            ++counts.normals;
+        } else if (keyLen == 2 && key[0] == 'v' && key[1] == 't') {
+            ++counts.texCoords;
+        } else if (keyLen == 1 && key[0] == 'f') {
+            // n 个角点扇形三角化为 n - 2 个三角形
+            size_t tokens = 0;
+            while (true) {
+                skipBlanks(p, end);
+                if (atLineEnd(p, end)) break;
+                while (!atTokenEnd(p, end)) ++p;
+                ++tokens;
+            }
+            if (tokens >= 3) counts.corners += (tokens - 2) * 3;
+        }
+        skipLine(p, end);
+    }
+    return counts;
+}
+
+// 按计数预留数组; 数组在 Arena 中时先让 Arena 准备一整块, 四个数组连续存放
+void reserveChunk(ObjChunk& chunk, const ChunkCounts& counts) {
+    const size_t slack = 4 * alignof(std::max_align_t);
+    Arena* attributes = chunk.positions.get_allocator().arena;
+    Arena* corners = chunk.corners.get_allocator().arena;
+    size_t attributeBytes = counts.positions * sizeof(glm::vec3) + counts.normals * sizeof(glm::vec3) +
+                            counts.texCoords * sizeof(glm::vec2);
+    size_t cornerBytes = counts.corners * sizeof(ObjCorner);
+    if (attributes == corners) {
+        if (attributes) attributes->reserve(attributeBytes + cornerBytes + slack);
+    } else {
+        if (attributes) attributes->reserve(attributeBytes + slack);
+        if (corners) corners->reserve(cornerBytes + slack);
+    }
+    chunk.positions.reserve(counts.positions);
+    chunk.normals.reserve(counts.normals);
+    chunk.texCoords.reserve(counts.texCoords);
+    chunk.corners.reserve(counts.corners);
+}
+
+// 一个分块的解析结果占用的字节数
+size_t chunkBytes(const ObjChunk& chunk) {
+    return capacityBytes(chunk.positions) + capacityBytes(chunk.normals) + capacityBytes(chunk.texCoords) +
+           capacityBytes(chunk.corners);
+}
+
+// 把角点的某个索引换算成全局 0 起始索引, 越界时返回 -1
+inline long long resolveIndex(const ObjCorner& corner, int slot, size_t chunkBase, size_t total) {
+    long long index = (corner.relativeMask & (1u << slot))
+        ? (long long)chunkBase + corner.idx[slot]
+        : (long long)corner.idx[slot] - 1;
+    return (index >= 0 && index < (long long)total) ? index : -1;
+}
+
+} // namespace
+
+// 解析单个分块
+void ObjParser::parseChunk(const char* begin, const char* end, ObjChunk& chunk) {
+    reserveChunk(chunk, countChunk(begin, end));
+
+    const char* p = begin;
+
+    while (p < end) {
+        ++chunk.lineCount;
+        skipBlanks(p, end);
+        if (atLineEnd(p, end)) { skipLine(p, end); continue; }
+
+        // 读取行首关键字
+        const char* key = p;
+        while (!atTokenEnd(p, end)) ++p;
+        size_t keyLen = p - key;
+
+        bool ok = true;
+        const char* message = "Malformed number";
+        if (keyLen == 1 && key[0] == 'v') {
+            glm::vec3 pos;
+            ok = parseFloat(p, end, pos.x) && parseFloat(p, end, pos.y) && parseFloat(p, end, pos.z);
+            chunk.positions.push_back(pos);
+        } else if (keyLen == 2 && key[0] == 'v' && key[1] == 'n') {
+            glm::vec3 norm;
+            ok = parseFloat(p, end, norm.x) && parseFloat(p, end, norm.y) && parseFloat(p, end, norm.z);
+            chunk.normals.push_back(norm);
+        } else if (keyLen == 2 && key[0] == 'v' && key[1] == 't') {
+            glm::vec2 uv;
+            ok = parseFloat(p, end, uv.x) && parseFloat(p, end, uv.y);
+            chunk.texCoords.push_back(uv);
+        } else if (keyLen == 1 && key[0] == 'f') {
+            ok = parseFace(p, end, chunk);
+            message = "Malformed face";
+        }
+        // 其余关键字 (注释, o/g/s/usemtl/mtllib ...) 直接忽略
+
+        if (!ok) {
+            chunk.errorLine = chunk.lineCount;
+            chunk.errorMessage = message;
+            return;
+        }
+        skipLine(p, end);
+    }
+}
+
+bool ObjParser::parse(const char* begin, const char* end) {
+    vertices.clear();
+    indices.clear();
+    hasNormals = false;
+    scratchPeakBytes = 0;
+
+    // 按行边界切分
+    size_t size = end - begin;
+    unsigned int workers = resolveThreadCount(threadCount);
+    size_t chunkCount = 1;
+    if (workers > 1) {
+        chunkCount = std::min<size_t>((size_t)workers * CHUNKS_PER_THREAD, size / std::max<size_t>(minChunkBytes, 1));
+        if (chunkCount < 1) chunkCount = 1;
+    }
+
+    std::vector<const char*> bounds;
+    bounds.reserve(chunkCount + 1);
+    bounds.push_back(begin);
+    for (size_t i = 1; i < chunkCount; ++i) {
+        const char* cut = begin + size * i / chunkCount;
+        if (cut < bounds.back()) cut = bounds.back();
+        const char* newline = (const char*)memchr(cut, '\n', end - cut);
+        bounds.push_back(newline ? newline + 1 : end);
+    }
+    bounds.push_back(end);
+
+    // 并行解析各分块; 每个分块的属性和角点各用一个 Arena (只由解析它的线程分配), 返回时整体释放
+    std::unique_ptr<Arena[]> attributeArenas(new Arena[chunkCount]);
+    std::unique_ptr<Arena[]> cornerArenas(new Arena[chunkCount]);
+    std::vector<ObjChunk> chunks;
+    chunks.reserve(chunkCount);
+    for (size_t i = 0; i < chunkCount; ++i) chunks.emplace_back(&attributeArenas[i], &cornerArenas[i]);
+    parallelFor(chunkCount, workers, [&](size_t i) {
+        parseChunk(bounds[i], bounds[i + 1], chunks[i]);
+        if (bytesParsed) *bytesParsed += (size_t)(bounds[i + 1] - bounds[i]);
+    });
+
+    // 报告第一个出错的分块 (它之前的分块都已完整扫描, 行号可以累加)
+    size_t lineBase = 0;
+    for (const ObjChunk& chunk : chunks) {
+        if (chunk.errorLine != 0) {
+            std::cerr << "ERROR::OBJPARSER::" << chunk.errorMessage << " at line " << lineBase + chunk.errorLine << std::endl;
+            return false;
+        }
+        lineBase += chunk.lineCount;
+    }
+
+    return merge(chunks, attributeArenas.get(), workers);
+}
+
+// 合并阶段: 拼接各分块的属性数组, 再把角点索引解析成全局索引, 最后去重生成顶点和索引缓冲
+bool ObjParser::merge(std::vector<ObjChunk>& chunks, Arena* attributeArenas, unsigned int workers) {
+    size_t chunkCount = chunks.size();
+
+    // 各分块在全局数组中的起点 (前缀和)
+    std::vector<size_t> positionBase(chunkCount), normalBase(chunkCount), texCoordBase(chunkCount), cornerBase(chunkCount);
+    size_t positionCount = 0, normalCount = 0, texCoordCount = 0, cornerCount = 0;
+    size_t parsedBytes = 0, cornerBytes = 0;
+    for (size_t i = 0; i < chunkCount; ++i) {
+        parsedBytes += chunkBytes(chunks[i]);
+        cornerBytes += capacityBytes(chunks[i].corners);
+        positionBase[i] = positionCount;  positionCount += chunks[i].positions.size();
+        normalBase[i]   = normalCount;    normalCount   += chunks[i].normals.size();
+        texCoordBase[i] = texCoordCount;  texCoordCount += chunks[i].texCoords.size();
+        cornerBase[i]   = cornerCount;    cornerCount   += chunks[i].corners.size();
+    }
+
+    // 合并阶段的临时数据 (拼接后的属性, 去重哈希表) 都在这个 Arena 中, 函数返回时整体释放
+    Arena arena;
+
+    // 拼接属性 (只有一个分块时直接接管, 连同分块的 Arena)
+    ArenaVector<glm::vec3> temp_Positions(&arena);
+    ArenaVector<glm::vec3> temp_Normals(&arena);
+    ArenaVector<glm::vec2> temp_TexCoords(&arena);
+    if (chunkCount == 1) {
+        temp_Positions = std::move(chunks[0].positions);
+        temp_Normals   = std::move(chunks[0].normals);
+        temp_TexCoords = std::move(chunks[0].texCoords);
+    } else {
+        arena.reserve(positionCount * sizeof(glm::vec3) + normalCount * sizeof(glm::vec3) +
+                      texCoordCount * sizeof(glm::vec2) + 3 * alignof(std::max_align_t));
+        temp_Positions.resize(positionCount);
+        temp_Normals.resize(normalCount);
+        temp_TexCoords.resize(texCoordCount);
+        parallelFor(chunkCount, workers, [&](size_t i) {
+            ObjChunk& chunk = chunks[i];
+            std::copy(chunk.positions.begin(), chunk.positions.end(), temp_Positions.begin() + positionBase[i]);
+            std::copy(chunk.normals.begin(), chunk.normals.end(), temp_Normals.begin() + normalBase[i]);
+            std::copy(chunk.texCoords.begin(), chunk.texCoords.end(), temp_TexCoords.begin() + texCoordBase[i]);
+            // 拷贝完立即释放分块的属性 Arena, 降低峰值内存
+            chunk.positions = ArenaVector<glm::vec3>();
+            chunk.normals   = ArenaVector<glm::vec3>();
+            chunk.texCoords = ArenaVector<glm::vec2>();
+            attributeArenas[i].release();
+        });
+    }
+    size_t attributeBytes = capacityBytes(temp_Positions) + capacityBytes(temp_Normals) + capacityBytes(temp_TexCoords);
+    // 拼接时分块的属性数组边拷贝边释放, 按都还在计 (上限)
+    scratchPeakBytes = chunkCount == 1 ? parsedBytes : parsedBytes + attributeBytes;
+
+    // 并行解析角点索引: 就地把每个角点换算成全局 0 起始索引 (-1 表示缺省)
+    std::vector<long long> badCorner(chunkCount, -1);
+    std::vector<char> chunkHasNormals(chunkCount, 0);
+    parallelFor(chunkCount, workers, [&](size_t i) {
+        ArenaVector<ObjCorner>& corners = chunks[i].corners;
+        for (size_t c = 0; c < corners.size(); ++c) {
+            ObjCorner& corner = corners[c];
+
+            long long v = resolveIndex(corner, 0, positionBase[i], temp_Positions.size());
+            if (v < 0) { badCorner[i] = (long long)c; return; }
+
+            long long vt = -1;
+            if (corner.idx[1] != 0 || (corner.relativeMask & 2u)) {
+                vt = resolveIndex(corner, 1, texCoordBase[i], temp_TexCoords.size());
+                if (vt < 0) { badCorner[i] = (long long)c; return; }
+            }
+
+            long long vn = -1;
+            if (corner.idx[2] != 0 || (corner.relativeMask & 4u)) {
+                vn = resolveIndex(corner, 2, normalBase[i], temp_Normals.size());
+                if (vn < 0) { badCorner[i] = (long long)c; return; }
+                chunkHasNormals[i] = 1;
+            }
+
+            corner.idx[0] = (int32_t)v;
+            corner.idx[1] = (int32_t)vt;
+            corner.idx[2] = (int32_t)vn;
+            corner.relativeMask = 0;
+        }
+    });
+
+    for (size_t i = 0; i < chunkCount; ++i) {
+        if (badCorner[i] >= 0) {
+            size_t triangle = (cornerBase[i] + (size_t)badCorner[i]) / 3;
+            std::cerr << "ERROR::OBJPARSER::Index out of range in triangle " << triangle << std::endl;
+            return false;
+        }
+        if (chunkHasNormals[i]) hasNormals = true;
+    }
+
+    // 去重: 相同 (v, vt, vn) 组合只生成一个顶点, 按首次出现的顺序编号.
+    // 桶数组和节点都从 Arena 分配 (节点按每个位置一个顶点预留一整块), 先只编号, 顶点数确定后一次分配顶点数组
+    size_t mapStart = arena.bytesAllocated();
+    size_t expectedVertices = positionCount + positionCount / 4;
+    VertexMap uniqueVertices(0, CornerKeyHash(), std::equal_to<CornerKey>(), &arena);
+    uniqueVertices.reserve(expectedVertices);
+    // 节点: 键值 + next 指针 + 缓存的哈希值
+    arena.reserve(expectedVertices * (sizeof(VertexMap::value_type) + 2 * sizeof(void*)));
+    indices.resize(cornerCount);
+
+    size_t next = 0;
+    for (const ObjChunk& chunk : chunks) {
+        for (const ObjCorner& corner : chunk.corners) {
+            CornerKey key{ corner.idx[0], corner.idx[1], corner.idx[2] };
+            auto inserted = uniqueVertices.try_emplace(key, (uint32_t)uniqueVertices.size());
+            indices[next++] = inserted.first->second;
+        }
+    }
+
+    vertices.resize(uniqueVertices.size());
+    for (const auto& entry : uniqueVertices) {
+        const CornerKey& key = entry.first;
+        Vertex& vertex = vertices[entry.second];
+        vertex.Position = temp_Positions[(size_t)key.v];
+        if (key.vt >= 0) vertex.TexCoords = temp_TexCoords[(size_t)key.vt];
+        if (key.vn >= 0) vertex.Normal = temp_Normals[(size_t)key.vn];
+    }
+
+    // 去重结束时: 属性数组 + 角点 + 哈希表
+    size_t mapBytes = arena.bytesAllocated() - mapStart;
+    scratchPeakBytes = std::max(scratchPeakBytes, attributeBytes + cornerBytes + mapBytes);
+    return true;
+}
@@ -0,0 +1,75 @@
+#ifndef OBJ_PARSER_H
+#define OBJ_PARSER_H
+
+#include <glm/glm.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Arena.h"
+#include "Vertex.h"
+
+// 一个三角形角点的原始 OBJ 索引
+// 正数: OBJ 的绝对索引 (从 1 开始); 0: 缺省;
+// relativeMask 对应位为 1 时: 已换算成 "本分块起点 + 偏移" 的形式 (由负索引得来)
+struct ObjCorner {
+    int32_t idx[3];       // v, vt, vn
+    uint32_t relativeMask;
+};
+
+// 一个分块 (若干完整的行) 的解析结果
+// 数组从构造时给定的 Arena 中分配 (为空时用全局堆); 属性和角点分开, 合并时属性可以先于角点整体释放
+struct ObjChunk {
+    ArenaVector<glm::vec3> positions;
+    ArenaVector<glm::vec3> normals;
+    ArenaVector<glm::vec2> texCoords;
+    ArenaVector<ObjCorner> corners; // 已三角化, 每 3 个一个三角形
+
+    ObjChunk() = default;
+    ObjChunk(Arena* attributeArena, Arena* cornerArena)
+        : positions(attributeArena), normals(attributeArena), texCoords(attributeArena), corners(cornerArena) {}
+
+    size_t lineCount = 0;  // 本分块已扫描的行数 (用于报告错误行号)
+    size_t errorLine = 0;  // 出错的行 (分块内, 从 1 开始), 0 表示成功
+    const char* errorMessage = nullptr;
+};
+
+// OBJ 文本解析器
+// 直接在内存缓冲区上用指针游标扫描, 用 std::from_chars 转换数字.
+// 每个分块先做一遍计数 (v / vn / vt 行数, 面的角点数), 数组一次分配到准确大小, 解析时不再扩容;
+// 分块结果, 拼接后的属性数组和去重哈希表都从 Arena 分配, parse 返回前整体释放
+//
+// 文本按行边界切成若干分块, 由多个线程各自解析到 ObjChunk,
+// 最后的合并阶段把 1 起始索引和负 (相对) 索引换算成全局索引,
+// 并把相同的 (v, vt, vn) 组合合并成一个顶点, 生成索引缓冲.
+// 单线程时就是只有一个分块的同一条路径, 因此结果与多线程完全一致.
+class ObjParser {
+public:
+    // 解析结果: 去重后的顶点 + 三角形索引 (多边形按扇形三角化)
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    bool hasNormals = false; // 是否有面引用了法线
+
+    // 解析过程中临时数组 (分块结果, 拼接后的属性数组, 去重哈希表) 同时占用的字节数峰值,
+    // 按容器容量估计, 不含结果数组; 每次 parse 重新统计
+    size_t scratchPeakBytes = 0;
+
+    // 解析线程数, 0 = 硬件线程数
+    unsigned int threadCount = 1;
+
+    // 每个分块的最小字节数, 太小的分块合并开销大于并行收益 (测试时调小, 让小文件也切成多块)
+    size_t minChunkBytes = 256 * 1024;
+
+    // 非空时每解析完一个分块就累加它的字节数 (后台加载时显示进度)
+    std::atomic<size_t>* bytesParsed = nullptr;
+
+    // 解析 [begin, end) 范围内的 OBJ 文本, 失败时打印错误并返回 false
+    bool parse(const char* begin, const char* end);
+
+    // 解析单个分块 (供工作线程调用), 数组按计数结果预留
+    static void parseChunk(const char* begin, const char* end, ObjChunk& chunk);
+
+private:
+    bool merge(std::vector<ObjChunk>& chunks, Arena* attributeArenas, unsigned int workers);
+};
+#endif
@@ -0,0 +1,792 @@
+#include "PageBuilder.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <unordered_map>
+#include "MappedFile.h"
+#include "MeshOptimize.h"
+#include "MeshSimplify.h"
+#include "ObjParser.h"
+#include "Parallel.h"
+#include "VertexPacking.h"
+
+namespace {
+
+const uint32_t NO_INDEX = 0xFFFFFFFFu;
+
+// 所有三角形中心都落在同一个八分体时只缩小单元, 不产生节点;
+// 单元细分超过这个层数后按顺序二分 (大量重复或退化的三角形)
+const int MAX_OCTREE_LEVEL = 32;
+
+// 页数据和节点表按 16 字节对齐
+const uint64_t PAGE_ALIGNMENT = 16;
+
+// 读写三角形临时文件时每次处理的三角形数
+const size_t TRIANGLE_BLOCK = 64 * 1024;
+
+// 顶点聚类的初始格子数 (每轴), 每次减半直到放得下一页
+const uint32_t CLUSTER_GRID = 256;
+
+// 一个三角形的全局 0 起始索引, 缺省的 vt / vn 为 NO_INDEX
+struct SourceTriangle {
+    uint32_t v[3];
+    uint32_t vt[3];
+    uint32_t vn[3];
+};
+
+// 一页的几何 (量化前), 返回给父节点合并简化
+struct PageGeometry {
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    float error = 0.0f;
+};
+
+// 叶子去重用的键 (与 ObjParser 相同: 相同的 (v, vt, vn) 组合只生成一个顶点)
+struct CornerKey {
+    uint32_t v, vt, vn;
+    bool operator==(const CornerKey& other) const {
+        return v == other.v && vt == other.vt && vn == other.vn;
+    }
+};
+
+struct CornerKeyHash {
+    size_t operator()(const CornerKey& key) const {
+        uint64_t h = (uint64_t)key.v * 0x9E3779B97F4A7C15ull;
+        h ^= ((uint64_t)key.vt + 0x632BE59BD9B4E019ull) * 0xC2B2AE3D27D4EB4Full;
+        h ^= ((uint64_t)key.vn + 0x85EBCA77C2B2AE63ull) * 0x165667B19E3779F9ull;
+        return (size_t)(h ^ (h >> 29));
+    }
+};
+
+// 按位比较的顶点 (合并子节点的几何时去重, 子节点之间的公共边界因此重新连起来)
+struct VertexHash {
+    size_t operator()(const Vertex& vertex) const {
+        uint32_t words[sizeof(Vertex) / sizeof(uint32_t)];
+        memcpy(words, &vertex, sizeof(words));
+        uint64_t hash = 0xCBF29CE484222325ull;
+        for (uint32_t word : words) hash = (hash ^ word) * 0x100000001B3ull;
+        return (size_t)(hash ^ (hash >> 29));
+    }
+};
+
+struct VertexEqual {
+    bool operator()(const Vertex& a, const Vertex& b) const {
+        return memcmp(&a, &b, sizeof(Vertex)) == 0;
+    }
+};
+
+inline uint64_t alignUp(uint64_t value) {
+    return (value + PAGE_ALIGNMENT - 1) & ~(PAGE_ALIGNMENT - 1);
+}
+
+bool writePadding(std::ofstream& out, uint64_t from, uint64_t to) {
+    static const char zeros[PAGE_ALIGNMENT] = {};
+    return (bool)out.write(zeros, (std::streamsize)(to - from));
+}
+
+inline int octantOf(const glm::vec3& p, const glm::vec3& mid) {
+    return (p.x >= mid.x ? 1 : 0) | (p.y >= mid.y ? 2 : 0) | (p.z >= mid.z ? 4 : 0);
+}
+
+inline Aabb octantCell(const Aabb& cell, int octant) {
+    glm::vec3 mid = cell.center();
+    Aabb child;
+    for (int axis = 0; axis < 3; ++axis) {
+        bool upper = (octant >> axis) & 1;
+        child.min[axis] = upper ? mid[axis] : cell.min[axis];
+        child.max[axis] = upper ? cell.max[axis] : mid[axis];
+    }
+    return child;
+}
+
+// 转换过程中的临时文件, 析构时 (包括失败返回时) 全部删除
+class TempFiles {
+public:
+    uint64_t bytesWritten = 0;
+
+    explicit TempFiles(std::string prefix) : prefix(std::move(prefix)) {}
+    ~TempFiles() {
+        std::error_code ec;
+        for (const std::string& path : paths) std::filesystem::remove(path, ec);
+    }
+
+    std::string create() {
+        std::string path = prefix + "." + std::to_string(next++) + ".tmp";
+        paths.insert(path);
+        return path;
+    }
+
+    void remove(const std::string& path) {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        paths.erase(path);
+    }
+
+private:
+    std::string prefix;
+    std::set<std::string> paths;
+    size_t next = 0;
+};
+
+// 第 1 步的结果: 属性和三角形都在临时文件中
+struct ParsedObj {
+    std::string positionPath, normalPath, texCoordPath, trianglePath;
+    size_t positions = 0, normals = 0, texCoords = 0, triangles = 0;
+    bool hasNormals = false;
+    Aabb bounds;
+};
+
+// OBJ 索引换算成全局 0 起始索引 (负索引相对分块起点, 见 ObjParser.h 的 ObjCorner)
+// 指向后面还没读到的属性的正索引在全部解析完后统一检查
+inline bool resolveCorner(const ObjCorner& corner, int slot, size_t chunkBase, uint32_t& index, uint32_t& maxIndex) {
+    bool relative = (corner.relativeMask & (1u << slot)) != 0;
+    if (!relative && corner.idx[slot] == 0) {
+        index = NO_INDEX;
+        return true;
+    }
+    long long global = relative ? (long long)chunkBase + corner.idx[slot] : (long long)corner.idx[slot] - 1;
+    if (global < 0 || global >= (long long)NO_INDEX) return false;
+    index = (uint32_t)global;
+    maxIndex = std::max(maxIndex, index + 1);
+    return true;
+}
+
+template <typename T, typename Allocator>
+bool appendArray(std::ofstream& out, const std::vector<T, Allocator>& values, TempFiles& temp) {
+    size_t bytes = values.size() * sizeof(T);
+    temp.bytesWritten += bytes;
+    return (bool)out.write((const char*)values.data(), (std::streamsize)bytes);
+}
+
+// 第 1 步: 按段读入 OBJ (缓冲区只保留完整的行, 不完整的最后一行留到下一段),
+// 每段切成 workers 个分块并行解析, 之后按顺序追加到临时文件
+bool parseObj(const std::string& objPath, const PageBuildOptions& options, TempFiles& temp, ParsedObj& parsed) {
+    std::ifstream file(objPath, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "ERROR::PAGEBUILDER::Could not open file: " << objPath << std::endl;
+        return false;
+    }
+    file.seekg(0, std::ios::end);
+    uint64_t fileSize = (uint64_t)file.tellg();
+    file.seekg(0, std::ios::beg);
+
+    parsed.positionPath = temp.create();
+    parsed.normalPath = temp.create();
+    parsed.texCoordPath = temp.create();
+    parsed.trianglePath = temp.create();
+    std::ofstream positionOut(parsed.positionPath, std::ios::binary | std::ios::trunc);
+    std::ofstream normalOut(parsed.normalPath, std::ios::binary | std::ios::trunc);
+    std::ofstream texCoordOut(parsed.texCoordPath, std::ios::binary | std::ios::trunc);
+    std::ofstream triangleOut(parsed.trianglePath, std::ios::binary | std::ios::trunc);
+    if (!positionOut.is_open() || !normalOut.is_open() || !texCoordOut.is_open() || !triangleOut.is_open()) {
+        std::cerr << "ERROR::PAGEBUILDER::Could not create temporary files next to " << parsed.positionPath << std::endl;
+        return false;
+    }
+
+    unsigned int workers = resolveThreadCount(options.threads);
+    size_t chunkBytes = std::max<size_t>(options.chunkBytes, 1);
+    std::vector<char> buffer(chunkBytes * workers);
+    size_t carried = 0;          // 上一段末尾不完整的行, 已移到缓冲区开头
+    uint64_t bytesRead = 0;
+    std::vector<ObjChunk> chunks(workers);
+    std::vector<const char*> cuts;
+    std::vector<SourceTriangle> triangles;
+    size_t lineBase = 0;
+    uint32_t maxPosition = 0, maxTexCoord = 0, maxNormal = 0;
+
+    while (true) {
+        // 一行比整个缓冲区还长时扩大缓冲区
+        if (carried == buffer.size()) buffer.resize(buffer.size() * 2);
+        file.read(buffer.data() + carried, (std::streamsize)(buffer.size() - carried));
+        size_t filled = carried + (size_t)file.gcount();
+        bytesRead += (uint64_t)file.gcount();
+        bool last = !file;
+        if (filled == 0) break;
+
+        const char* begin = buffer.data();
+        const char* end = begin + filled;
+        if (!last) {
+            const char* lastNewline = begin + filled;
+            while (lastNewline > begin && lastNewline[-1] != '\n') --lastNewline;
+            if (lastNewline == begin) {
+                carried = filled;
+                continue;
+            }
+            end = lastNewline;
+        }
+
+        cuts.clear();
+        cuts.push_back(begin);
+        for (unsigned int w = 0; w < workers && cuts.back() < end; ++w) {
+            const char* cut = cuts.back() + std::min<size_t>(chunkBytes, (size_t)(end - cuts.back()));
+            if (cut < end) {
+                const char* newline = (const char*)memchr(cut, '\n', end - cut);
+                cut = newline ? newline + 1 : end;
+            }
+            cuts.push_back(cut);
+        }
+        size_t chunkCount = cuts.size() - 1;
+        parallelFor(chunkCount, workers, [&](size_t i) {
+            chunks[i] = ObjChunk();
+            ObjParser::parseChunk(cuts[i], cuts[i + 1], chunks[i]);
+        });
+
+        for (size_t i = 0; i < chunkCount; ++i) {
+            const ObjChunk& chunk = chunks[i];
+            if (chunk.errorLine != 0) {
+                std::cerr << "ERROR::PAGEBUILDER::" << chunk.errorMessage << " at line " << lineBase + chunk.errorLine << std::endl;
+                return false;
+            }
+            lineBase += chunk.lineCount;
+
+            for (const glm::vec3& p : chunk.positions) parsed.bounds.grow(p);
+            triangles.resize(chunk.corners.size() / 3);
+            for (size_t c = 0; c < chunk.corners.size(); ++c) {
+                const ObjCorner& corner = chunk.corners[c];
+                SourceTriangle& triangle = triangles[c / 3];
+                int k = (int)(c % 3);
+                if (!resolveCorner(corner, 0, parsed.positions, triangle.v[k], maxPosition) ||
+                    !resolveCorner(corner, 1, parsed.texCoords, triangle.vt[k], maxTexCoord) ||
+                    !resolveCorner(corner, 2, parsed.normals, triangle.vn[k], maxNormal)) {
+                    std::cerr << "ERROR::PAGEBUILDER::Index out of range in triangle " << parsed.triangles + c / 3 << std::endl;
+                    return false;
+                }
+                if (triangle.vn[k] != NO_INDEX) parsed.hasNormals = true;
+            }
+
+            if (!appendArray(positionOut, chunk.positions, temp) || !appendArray(normalOut, chunk.normals, temp) ||
+                !appendArray(texCoordOut, chunk.texCoords, temp) || !appendArray(triangleOut, triangles, temp)) {
+                std::cerr << "ERROR::PAGEBUILDER::Could not write temporary files (disk full?)" << std::endl;
+                return false;
+            }
+            parsed.positions += chunk.positions.size();
+            parsed.normals += chunk.normals.size();
+            parsed.texCoords += chunk.texCoords.size();
+            parsed.triangles += triangles.size();
+        }
+
+        carried = (size_t)(begin + filled - end);
+        memmove(buffer.data(), end, carried);
+        if (options.verbose) {
+            std::cout << "Parsed " << bytesRead / (1024 * 1024) << " / " << fileSize / (1024 * 1024)
+                      << " MB, " << parsed.triangles << " triangles" << std::endl;
+        }
+        if (last) break;
+    }
+
+    positionOut.close();
+    normalOut.close();
+    texCoordOut.close();
+    triangleOut.close();
+    if (!positionOut || !normalOut || !texCoordOut || !triangleOut) {
+        std::cerr << "ERROR::PAGEBUILDER::Could not write temporary files (disk full?)" << std::endl;
+        return false;
+    }
+    if (maxPosition > parsed.positions || maxTexCoord > parsed.texCoords || maxNormal > parsed.normals) {
+        std::cerr << "ERROR::PAGEBUILDER::Face references a vertex that is never defined" << std::endl;
+        return false;
+    }
+    if (parsed.triangles == 0) {
+        std::cerr << "ERROR::PAGEBUILDER::No triangles in " << objPath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 第 2, 3 步: 自底向上构建八叉树, 每个节点写一页
+class OctreeBuilder {
+public:
+    std::vector<PageNode> nodes;
+    bool failed = false;
+
+    OctreeBuilder(const MappedFile& positionFile, const MappedFile& normalFile,
+                  const MappedFile& texCoordFile, const PageBuildOptions& options, TempFiles& temp,
+                  std::ofstream& out, uint64_t writeOffset, PageBuildStats& stats)
+        : positions((const glm::vec3*)positionFile.data()), normals((const glm::vec3*)normalFile.data()),
+          texCoords((const glm::vec2*)texCoordFile.data()), options(options), temp(temp),
+          out(out), writeOffset(writeOffset), stats(stats) {}
+
+    uint64_t offset() const { return writeOffset; }
+
+    // 三角形列表在临时文件中 (函数返回前删除)
+    PageGeometry buildFromFile(uint32_t node, std::string path, size_t count, Aabb cell, int level);
+
+    // 三角形列表在内存中, 就地重排
+    PageGeometry buildInMemory(uint32_t node, SourceTriangle* triangles, size_t count, Aabb cell, int level);
+
+private:
+    struct FileRange {
+        std::string path;
+        size_t count;
+        Aabb cell;
+    };
+    struct MemoryRange {
+        size_t first;
+        size_t count;
+        Aabb cell;
+    };
+
+    const glm::vec3* positions;
+    const glm::vec3* normals;
+    const glm::vec2* texCoords;
+    const PageBuildOptions& options;
+    TempFiles& temp;
+    std::ofstream& out;
+    uint64_t writeOffset;
+    PageBuildStats& stats;
+    size_t pagesWritten = 0;
+
+    glm::vec3 centroid(const SourceTriangle& triangle) const {
+        return (positions[triangle.v[0]] + positions[triangle.v[1]] + positions[triangle.v[2]]) / 3.0f;
+    }
+
+    std::vector<MemoryRange> partitionInMemory(SourceTriangle* triangles, size_t count, const Aabb& cell);
+    std::vector<FileRange> partitionFile(const std::string& path, const Aabb& cell);
+    std::vector<FileRange> splitFile(const std::string& path, size_t count, const Aabb& cell);
+    uint32_t allocateChildren(uint32_t node, size_t count);
+    PageGeometry gatherLeaf(const SourceTriangle* triangles, size_t count) const;
+    PageGeometry finishInterior(uint32_t node, std::vector<PageGeometry>& children);
+    void clusterVertices(PageGeometry& page);
+    void writePage(uint32_t node, PageGeometry& page);
+};
+
+PageGeometry OctreeBuilder::buildFromFile(uint32_t node, std::string path, size_t count, Aabb cell, int level) {
+    if ((uint64_t)count * sizeof(SourceTriangle) <= options.memoryBytes) {
+        std::vector<SourceTriangle> triangles(count);
+        std::ifstream in(path, std::ios::binary);
+        if (!in.read((char*)triangles.data(), (std::streamsize)(count * sizeof(SourceTriangle)))) {
+            std::cerr << "ERROR::PAGEBUILDER::Could not read temporary file: " << path << std::endl;
+            failed = true;
+            return PageGeometry();
+        }
+        in.close();
+        temp.remove(path);
+        return buildInMemory(node, triangles.data(), count, cell, level);
+    }
+
+    // 列表太大, 在临时文件之间划分 (每层读写一遍)
+    std::vector<FileRange> ranges;
+    while (true) {
+        if (options.verbose) std::cout << "Partitioning " << count << " triangles on disk (level " << level << ")" << std::endl;
+        ranges = partitionFile(path, cell);
+        if (failed) return PageGeometry();
+        if (ranges.size() > 1) break;
+        path = ranges[0].path;
+        cell = ranges[0].cell;
+        if (++level >= MAX_OCTREE_LEVEL) {
+            ranges = splitFile(path, count, cell);
+            if (failed) return PageGeometry();
+            break;
+        }
+    }
+
+    uint32_t firstChild = allocateChildren(node, ranges.size());
+    std::vector<PageGeometry> children(ranges.size());
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        children[i] = buildFromFile(firstChild + (uint32_t)i, ranges[i].path, ranges[i].count, ranges[i].cell, level + 1);
+        if (failed) return PageGeometry();
+    }
+    return finishInterior(node, children);
+}
+
+PageGeometry OctreeBuilder::buildInMemory(uint32_t node, SourceTriangle* triangles, size_t count, Aabb cell, int level) {
+    stats.depth = std::max(stats.depth, (size_t)level);
+    if (count <= PAGE_MAX_TRIANGLES) {
+        PageGeometry leaf = gatherLeaf(triangles, count);
+        if (leaf.vertices.size() <= PAGE_MAX_VERTICES) {
+            writePage(node, leaf);
+            ++stats.leaves;
+            return leaf;
+        }
+    }
+
+    std::vector<MemoryRange> ranges;
+    while (true) {
+        ranges = partitionInMemory(triangles, count, cell);
+        if (ranges.size() > 1) break;
+        cell = ranges[0].cell;
+        if (++level >= MAX_OCTREE_LEVEL) {
+            ranges = { { 0, count / 2, cell }, { count / 2, count - count / 2, cell } };
+            break;
+        }
+    }
+
+    uint32_t firstChild = allocateChildren(node, ranges.size());
+    std::vector<PageGeometry> children(ranges.size());
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        children[i] = buildInMemory(firstChild + (uint32_t)i, triangles + ranges[i].first, ranges[i].count,
+                                    ranges[i].cell, level + 1);
+        if (failed) return PageGeometry();
+    }
+    return finishInterior(node, children);
+}
+
+// 按三角形中心所在的八分体原地重排 (American flag sort), 返回非空的八分体
+std::vector<OctreeBuilder::MemoryRange> OctreeBuilder::partitionInMemory(SourceTriangle* triangles, size_t count,
+                                                                         const Aabb& cell) {
+    glm::vec3 mid = cell.center();
+    std::vector<uint8_t> octants(count);
+    size_t counts[8] = {};
+    for (size_t i = 0; i < count; ++i) {
+        octants[i] = (uint8_t)octantOf(centroid(triangles[i]), mid);
+        ++counts[octants[i]];
+    }
+
+    size_t next[8], end[8];
+    size_t start = 0;
+    for (int o = 0; o < 8; ++o) {
+        next[o] = start;
+        start += counts[o];
+        end[o] = start;
+    }
+    for (int o = 0; o < 8; ++o) {
+        while (next[o] < end[o]) {
+            int target = octants[next[o]];
+            if (target == o) {
+                ++next[o];
+            } else {
+                size_t j = next[target]++;
+                std::swap(triangles[next[o]], triangles[j]);
+                std::swap(octants[next[o]], octants[j]);
+            }
+        }
+    }
+
+    std::vector<MemoryRange> ranges;
+    for (int o = 0; o < 8; ++o) {
+        if (counts[o] > 0) ranges.push_back({ end[o] - counts[o], counts[o], octantCell(cell, o) });
+    }
+    return ranges;
+}
+
+// 按八分体把临时文件分到最多 8 个新的临时文件, 删除原文件
+std::vector<OctreeBuilder::FileRange> OctreeBuilder::partitionFile(const std::string& path, const Aabb& cell) {
+    glm::vec3 mid = cell.center();
+    std::ifstream in(path, std::ios::binary);
+    std::ofstream outs[8];
+    std::vector<SourceTriangle> block(TRIANGLE_BLOCK);
+    std::vector<SourceTriangle> buckets[8];
+    std::vector<FileRange> ranges(8);
+
+    auto flush = [&](int o) {
+        if (buckets[o].empty()) return true;
+        if (!outs[o].is_open()) {
+            ranges[o].path = temp.create();
+            ranges[o].count = 0;
+            ranges[o].cell = octantCell(cell, o);
+            outs[o].open(ranges[o].path, std::ios::binary | std::ios::trunc);
+        }
+        ranges[o].count += buckets[o].size();
+        bool ok = appendArray(outs[o], buckets[o], temp);
+        buckets[o].clear();
+        return ok;
+    };
+
+    while (in) {
+        in.read((char*)block.data(), (std::streamsize)(block.size() * sizeof(SourceTriangle)));
+        size_t read = (size_t)in.gcount() / sizeof(SourceTriangle);
+        for (size_t i = 0; i < read; ++i) {
+            int o = octantOf(centroid(block[i]), mid);
+            buckets[o].push_back(block[i]);
+            if (buckets[o].size() == TRIANGLE_BLOCK && !flush(o)) failed = true;
+        }
+    }
+    for (int o = 0; o < 8; ++o) {
+        if (!flush(o)) failed = true;
+        if (outs[o].is_open()) {
+            outs[o].close();
+            if (!outs[o]) failed = true;
+        }
+    }
+    in.close();
+    temp.remove(path);
+    if (failed) {
+        std::cerr << "ERROR::PAGEBUILDER::Could not write temporary files (disk full?)" << std::endl;
+        return {};
+    }
+
+    ranges.erase(std::remove_if(ranges.begin(), ranges.end(), [](const FileRange& range) { return range.path.empty(); }),
+                 ranges.end());
+    return ranges;
+}
+
+// 按顺序一分为二 (无法按空间划分时)
+std::vector<OctreeBuilder::FileRange> OctreeBuilder::splitFile(const std::string& path, size_t count, const Aabb& cell) {
+    std::vector<FileRange> ranges = { { temp.create(), count / 2, cell }, { temp.create(), count - count / 2, cell } };
+    std::ifstream in(path, std::ios::binary);
+    std::vector<SourceTriangle> block;
+    for (const FileRange& range : ranges) {
+        std::ofstream rangeOut(range.path, std::ios::binary | std::ios::trunc);
+        for (size_t done = 0; done < range.count;) {
+            block.resize(std::min(TRIANGLE_BLOCK, range.count - done));
+            if (!in.read((char*)block.data(), (std::streamsize)(block.size() * sizeof(SourceTriangle))) ||
+                !appendArray(rangeOut, block, temp)) {
+                std::cerr << "ERROR::PAGEBUILDER::Could not split temporary file: " << path << std::endl;
+                failed = true;
+                return {};
+            }
+            done += block.size();
+        }
+    }
+    in.close();
+    temp.remove(path);
+    return ranges;
+}
+
+// 子节点在节点表中连续存放
+uint32_t OctreeBuilder::allocateChildren(uint32_t node, size_t count) {
+    uint32_t firstChild = (uint32_t)nodes.size();
+    nodes.resize(nodes.size() + count);
+    nodes[node].firstChild = firstChild;
+    nodes[node].childCount = (uint32_t)count;
+    return firstChild;
+}
+
+PageGeometry OctreeBuilder::gatherLeaf(const SourceTriangle* triangles, size_t count) const {
+    PageGeometry page;
+    std::unordered_map<CornerKey, uint32_t, CornerKeyHash> unique;
+    unique.reserve(count * 2);
+    page.indices.reserve(count * 3);
+    for (size_t t = 0; t < count; ++t) {
+        const SourceTriangle& triangle = triangles[t];
+        for (int k = 0; k < 3; ++k) {
+            CornerKey key{ triangle.v[k], triangle.vt[k], triangle.vn[k] };
+            auto inserted = unique.emplace(key, (uint32_t)page.vertices.size());
+            if (inserted.second) {
+                Vertex vertex{};
+                vertex.Position = positions[key.v];
+                if (key.vt != NO_INDEX) vertex.TexCoords = texCoords[key.vt];
+                if (key.vn != NO_INDEX) vertex.Normal = normals[key.vn];
+                page.vertices.push_back(vertex);
+            }
+            page.indices.push_back(inserted.first->second);
+        }
+    }
+    return page;
+}
+
+// 内部节点: 合并子节点的几何, 简化到一页; 误差不小于任何子节点
+PageGeometry OctreeBuilder::finishInterior(uint32_t node, std::vector<PageGeometry>& children) {
+    PageGeometry page;
+    float childError = 0.0f;
+    {
+        std::unordered_map<Vertex, uint32_t, VertexHash, VertexEqual> unique;
+        for (PageGeometry& child : children) {
+            childError = std::max(childError, child.error);
+            for (uint32_t index : child.indices) {
+                auto inserted = unique.emplace(child.vertices[index], (uint32_t)page.vertices.size());
+                if (inserted.second) page.vertices.push_back(child.vertices[index]);
+                page.indices.push_back(inserted.first->second);
+            }
+            child = PageGeometry();
+        }
+    }
+    page.error = childError;
+
+    if (page.indices.size() / 3 > PAGE_MAX_TRIANGLES || page.vertices.size() > PAGE_MAX_VERTICES) {
+        std::vector<glm::vec3> vertexPositions(page.vertices.size());
+        std::vector<glm::vec3> vertexNormals(page.vertices.size());
+        for (size_t i = 0; i < page.vertices.size(); ++i) {
+            vertexPositions[i] = page.vertices[i].Position;
+            vertexNormals[i] = page.vertices[i].Normal;
+        }
+        std::vector<uint32_t> simplified;
+        float error = simplifyMesh(vertexPositions, vertexNormals, page.indices, (size_t)PAGE_MAX_TRIANGLES * 3, simplified);
+        page.indices.swap(simplified);
+        page.error = std::max(page.error, error);
+
+        // 去掉不再被引用的顶点
+        std::vector<uint32_t> remap(page.vertices.size(), NO_INDEX);
+        std::vector<Vertex> used;
+        for (uint32_t& index : page.indices) {
+            if (remap[index] == NO_INDEX) {
+                remap[index] = (uint32_t)used.size();
+                used.push_back(page.vertices[index]);
+            }
+            index = remap[index];
+        }
+        page.vertices.swap(used);
+
+        if (page.indices.size() / 3 > PAGE_MAX_TRIANGLES || page.vertices.size() > PAGE_MAX_VERTICES) {
+            clusterVertices(page);
+            ++stats.clusteredNodes;
+        }
+    }
+
+    writePage(node, page);
+    return page;
+}
+
+// 顶点聚类: 同一格子里的顶点合并成一个 (位置取平均), 退化的三角形删除; 格子从细到粗直到放得下一页
+void OctreeBuilder::clusterVertices(PageGeometry& page) {
+    Aabb box;
+    for (const Vertex& vertex : page.vertices) box.grow(vertex.Position);
+
+    for (uint32_t grid = CLUSTER_GRID; grid >= 1; grid /= 2) {
+        glm::vec3 cellSize = glm::max(box.extent() / (float)grid, glm::vec3(1e-20f));
+        std::unordered_map<uint32_t, uint32_t> cellVertex;
+        std::vector<Vertex> clustered;
+        std::vector<uint32_t> members;
+        std::vector<uint32_t> remap(page.vertices.size());
+        for (size_t i = 0; i < page.vertices.size(); ++i) {
+            glm::vec3 cell = glm::floor((page.vertices[i].Position - box.min) / cellSize);
+            cell = glm::clamp(cell, glm::vec3(0.0f), glm::vec3((float)(grid - 1)));
+            uint32_t key = (uint32_t)cell.x + grid * ((uint32_t)cell.y + grid * (uint32_t)cell.z);
+            auto inserted = cellVertex.emplace(key, (uint32_t)clustered.size());
+            if (inserted.second) {
+                clustered.push_back(page.vertices[i]);
+                clustered.back().Normal = glm::vec3(0.0f);
+                members.push_back(0);
+            }
+            uint32_t target = inserted.first->second;
+            if (!inserted.second) clustered[target].Position += page.vertices[i].Position;
+            clustered[target].Normal += page.vertices[i].Normal;
+            ++members[target];
+            remap[i] = target;
+        }
+        for (size_t c = 0; c < clustered.size(); ++c) {
+            clustered[c].Position /= (float)members[c];
+            float length = glm::length(clustered[c].Normal);
+            if (length > 0.0f) clustered[c].Normal /= length;
+        }
+
+        std::vector<uint32_t> indices;
+        for (size_t t = 0; t + 2 < page.indices.size(); t += 3) {
+            uint32_t a = remap[page.indices[t]], b = remap[page.indices[t + 1]], c = remap[page.indices[t + 2]];
+            if (a == b || b == c || a == c) continue;
+            indices.push_back(a);
+            indices.push_back(b);
+            indices.push_back(c);
+        }
+        if (clustered.size() <= PAGE_MAX_VERTICES && indices.size() / 3 <= PAGE_MAX_TRIANGLES) {
+            page.vertices.swap(clustered);
+            page.indices.swap(indices);
+            page.error = std::max(page.error, glm::length(cellSize));
+            return;
+        }
+    }
+}
+
+// 优化顶点顺序, 压缩, 写到输出文件末尾; 节点包围盒包括整个子树 (裁剪一个节点即裁剪整个子树)
+void OctreeBuilder::writePage(uint32_t node, PageGeometry& page) {
+    Aabb pageBounds;
+    for (const Vertex& vertex : page.vertices) pageBounds.grow(vertex.Position);
+    if (!page.indices.empty()) {
+        MeshCluster whole;
+        whole.indexCount = (uint32_t)page.indices.size();
+        whole.bounds = pageBounds;
+        optimizeMesh(page.vertices, page.indices, { whole }, options.threads);
+    }
+
+    std::vector<PackedVertex> packed;
+    QuantizationInfo quant = packVertices(page.vertices, packed);
+    std::vector<uint16_t> indices(page.indices.begin(), page.indices.end());
+
+    PageNode& entry = nodes[node];
+    Aabb bounds = pageBounds;
+    for (uint32_t child = entry.firstChild; child < entry.firstChild + entry.childCount; ++child) {
+        bounds.grow(pageNodeBounds(nodes[child]));
+    }
+    for (int axis = 0; axis < 3; ++axis) {
+        entry.boundsMin[axis] = bounds.min[axis];
+        entry.boundsMax[axis] = bounds.max[axis];
+        entry.quantOffset[axis] = quant.offset[axis];
+        entry.quantScale[axis] = quant.scale[axis];
+    }
+    entry.error = page.error;
+    entry.vertexCount = (uint32_t)packed.size();
+    entry.triangleCount = (uint32_t)(indices.size() / 3);
+    entry.dataBytes = (uint32_t)pageDataBytes(entry.vertexCount, entry.triangleCount);
+
+    uint64_t start = alignUp(writeOffset);
+    entry.dataOffset = start;
+    if (!writePadding(out, writeOffset, start) ||
+        !out.write((const char*)packed.data(), (std::streamsize)(packed.size() * sizeof(PackedVertex))) ||
+        !out.write((const char*)indices.data(), (std::streamsize)(indices.size() * sizeof(uint16_t)))) {
+        std::cerr << "ERROR::PAGEBUILDER::Could not write page file (disk full?)" << std::endl;
+        failed = true;
+    }
+    writeOffset = start + entry.dataBytes;
+
+    if (options.verbose && ++pagesWritten % 1000 == 0) std::cout << "Wrote " << pagesWritten << " pages" << std::endl;
+}
+
+} // namespace
+
+bool buildPageFile(const std::string& objPath, const std::string& outputPath,
+                   const PageBuildOptions& options, PageBuildStats& stats) {
+    stats = PageBuildStats();
+    auto startTime = std::chrono::steady_clock::now();
+
+    std::filesystem::path output(outputPath);
+    std::filesystem::path tempDir = options.tempDir.empty() ? output.parent_path() : std::filesystem::path(options.tempDir);
+    TempFiles temp((tempDir / output.filename()).string());
+
+    // 1. 解析到临时文件
+    ParsedObj parsed;
+    if (!parseObj(objPath, options, temp, parsed)) return false;
+    stats.sourceTriangles = parsed.triangles;
+    stats.positions = parsed.positions;
+    auto parsedTime = std::chrono::steady_clock::now();
+    stats.parseSeconds = std::chrono::duration<double>(parsedTime - startTime).count();
+
+    // 2, 3. 属性映射后随机访问, 构建八叉树, 每个节点一页
+    MappedFile positionFile, normalFile, texCoordFile;
+    if (!positionFile.open(parsed.positionPath) || !normalFile.open(parsed.normalPath) ||
+        !texCoordFile.open(parsed.texCoordPath)) {
+        std::cerr << "ERROR::PAGEBUILDER::Could not map temporary files" << std::endl;
+        return false;
+    }
+
+    std::string partialPath = outputPath + ".tmp";
+    std::ofstream out(partialPath, std::ios::binary | std::ios::trunc);
+    PageFileHeader header{};
+    if (!out.is_open() || !PageFile::writeHeader(out, header)) {
+        std::cerr << "ERROR::PAGEBUILDER::Could not create output file: " << partialPath << std::endl;
+        return false;
+    }
+
+    OctreeBuilder builder(positionFile, normalFile, texCoordFile, options, temp, out, sizeof(PageFileHeader), stats);
+    builder.nodes.resize(1);
+    builder.buildFromFile(0, parsed.trianglePath, parsed.triangles, parsed.bounds, 0);
+
+    bool ok = !builder.failed;
+    if (ok) {
+        uint64_t nodeOffset = alignUp(builder.offset());
+        ok = writePadding(out, builder.offset(), nodeOffset) &&
+             out.write((const char*)builder.nodes.data(), (std::streamsize)(builder.nodes.size() * sizeof(PageNode)));
+
+        header.flags = parsed.hasNormals ? PAGE_FILE_HAS_NORMALS : 0u;
+        header.nodeCount = builder.nodes.size();
+        header.nodeOffset = nodeOffset;
+        memcpy(header.boundsMin, builder.nodes[0].boundsMin, sizeof(header.boundsMin));
+        memcpy(header.boundsMax, builder.nodes[0].boundsMax, sizeof(header.boundsMax));
+        header.sourceTriangles = parsed.triangles;
+        header.maxPageVertices = PAGE_MAX_VERTICES;
+        header.maxPageTriangles = PAGE_MAX_TRIANGLES;
+        ok = ok && PageFile::writeHeader(out, header);
+        stats.outputBytes = nodeOffset + builder.nodes.size() * sizeof(PageNode);
+    }
+    out.close();
+    std::error_code ec;
+    if (!ok || !out) {
+        if (!builder.failed) std::cerr << "ERROR::PAGEBUILDER::Could not write page file: " << partialPath << std::endl;
+        std::filesystem::remove(partialPath, ec);
+        return false;
+    }
+    std::filesystem::rename(partialPath, outputPath, ec);
+    if (ec) {
+        std::cerr << "ERROR::PAGEBUILDER::Could not replace output file: " << outputPath << std::endl;
+        std::filesystem::remove(partialPath, ec);
+        return false;
+    }
+
+    stats.nodes = builder.nodes.size();
+    stats.tempBytes = temp.bytesWritten;
+    stats.buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - parsedTime).count();
+    return true;
+}
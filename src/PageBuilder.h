@@ -0,0 +1,41 @@
+#ifndef PAGE_BUILDER_H
+#define PAGE_BUILDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "PageFile.h"
+
+// 转换选项
+struct PageBuildOptions {
+    unsigned int threads = 0;                   // 解析和页内优化的线程数, 0 = 硬件线程数
+    std::string tempDir;                        // 临时文件目录, 为空时用输出文件所在目录
+    size_t memoryBytes = 512u * 1024 * 1024;    // 三角形列表不超过这个大小时读入内存划分, 否则在临时文件之间划分
+    size_t chunkBytes = 32u * 1024 * 1024;      // 每个线程一次解析的 OBJ 文本字节数
+    bool verbose = false;                       // 打印各阶段进度
+};
+
+struct PageBuildStats {
+    size_t sourceTriangles = 0;
+    size_t positions = 0;
+    size_t nodes = 0;
+    size_t leaves = 0;
+    size_t depth = 0;              // 八叉树最大深度 (根为 0)
+    size_t clusteredNodes = 0;     // 边界锁定使简化不够一页, 退回顶点聚类的内部节点
+    uint64_t outputBytes = 0;
+    uint64_t tempBytes = 0;        // 写过的临时文件总字节数
+    double parseSeconds = 0.0;
+    double buildSeconds = 0.0;
+};
+
+// OBJ -> .objpages (见 PageFile.h), 内存占用与模型大小无关:
+//   1. 逐段读入 OBJ, 多线程解析 (ObjParser::parseChunk), 位置/法线/UV 追加到临时文件,
+//      三角形换算成全局索引后追加到另一个临时文件
+//   2. 属性临时文件内存映射后随机访问 (由操作系统按需换入换出); 三角形按中心所在的八分体递归划分,
+//      列表大于 memoryBytes 时在临时文件之间划分, 否则读入内存就地划分
+//   3. 自底向上写页: 叶子去重顶点; 内部节点合并子节点的几何, 用 simplifyMesh 简化到一页,
+//      开放边界 (节点的外边界) 锁定导致简化不够时再做顶点聚类
+// 失败时打印错误并返回 false (不会留下输出文件和临时文件)
+bool buildPageFile(const std::string& objPath, const std::string& outputPath,
+                   const PageBuildOptions& options, PageBuildStats& stats);
+#endif
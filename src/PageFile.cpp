@@ -0,0 +1,90 @@
+#include "PageFile.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+const char PAGE_FILE_MAGIC[8] = { 'O', 'B', 'J', 'P', 'A', 'G', 'E', '\0' };
+
+} // namespace
+
+bool PageFile::open(const std::string& path) {
+    close();
+    file.open(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "ERROR::PAGEFILE::Could not open file: " << path << std::endl;
+        return false;
+    }
+    file.seekg(0, std::ios::end);
+    fileSize = (uint64_t)file.tellg();
+    file.seekg(0, std::ios::beg);
+
+    auto fail = [&](const char* message) {
+        std::cerr << "ERROR::PAGEFILE::" << message << ": " << path << std::endl;
+        close();
+        return false;
+    };
+
+    if (!file.read((char*)&header, sizeof(header)) ||
+        memcmp(header.magic, PAGE_FILE_MAGIC, sizeof(PAGE_FILE_MAGIC)) != 0) {
+        return fail("Not a page file");
+    }
+    if (header.version != PAGE_FILE_VERSION) return fail("Unsupported page file version");
+    if (header.nodeCount == 0 || header.maxPageVertices > PAGE_MAX_VERTICES ||
+        header.maxPageTriangles > PAGE_MAX_TRIANGLES ||
+        header.nodeOffset > fileSize || header.nodeCount > (fileSize - header.nodeOffset) / sizeof(PageNode)) {
+        return fail("Corrupt page file header");
+    }
+
+    nodes.resize((size_t)header.nodeCount);
+    file.seekg((std::streamoff)header.nodeOffset);
+    if (!file.read((char*)nodes.data(), (std::streamsize)(nodes.size() * sizeof(PageNode)))) {
+        return fail("Could not read node table");
+    }
+
+    // 子节点总在父节点之后, 遍历不会成环
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        const PageNode& node = nodes[i];
+        bool childrenValid = node.childCount == 0 ||
+            (node.firstChild > i && node.childCount <= 8 && (uint64_t)node.firstChild + node.childCount <= nodes.size());
+        bool pageValid = node.vertexCount <= header.maxPageVertices && node.triangleCount <= header.maxPageTriangles &&
+            node.dataBytes == pageDataBytes(node.vertexCount, node.triangleCount) &&
+            node.dataOffset <= header.nodeOffset && node.dataBytes <= header.nodeOffset - node.dataOffset;
+        if (!childrenValid || !pageValid) return fail("Corrupt page node");
+    }
+    return true;
+}
+
+void PageFile::close() {
+    if (file.is_open()) file.close();
+    file.clear();
+    nodes.clear();
+    header = PageFileHeader{};
+    fileSize = 0;
+}
+
+bool PageFile::readPage(uint32_t node, void* data) {
+    if (!file.is_open() || node >= nodes.size()) return false;
+    const PageNode& page = nodes[node];
+    file.clear();
+    file.seekg((std::streamoff)page.dataOffset);
+    if (!file.read((char*)data, (std::streamsize)page.dataBytes)) return false;
+
+    // 页在槽中按 baseVertex 绘制, 越界的索引会读到相邻的槽或顶点缓冲之外
+    const uint16_t* indices = (const uint16_t*)((const char*)data + (size_t)page.vertexCount * sizeof(PackedVertex));
+    uint16_t maxIndex = 0;
+    for (size_t i = 0; i < (size_t)page.triangleCount * 3; ++i) maxIndex = std::max(maxIndex, indices[i]);
+    if (page.triangleCount > 0 && maxIndex >= page.vertexCount) {
+        std::cerr << "ERROR::PAGEFILE::Index out of range in page " << node << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool PageFile::writeHeader(std::ofstream& out, PageFileHeader header) {
+    memcpy(header.magic, PAGE_FILE_MAGIC, sizeof(PAGE_FILE_MAGIC));
+    header.version = PAGE_FILE_VERSION;
+    out.seekp(0);
+    return (bool)out.write((const char*)&header, sizeof(header));
+}
@@ -0,0 +1,92 @@
+#ifndef PAGE_FILE_H
+#define PAGE_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Bounds.h"
+#include "VertexPacking.h"
+
+// 分页网格文件 (.objpages), 由 obj_pages 从 OBJ 离线生成, 查看器按需流式读取 (见 PageStreamer.h)
+// 文件布局: [PageFileHeader][页数据 ...][PageNode x nodeCount]
+// 模型按三角形中心划分成八叉树, 每个节点一页几何数据:
+//   叶子: 原始三角形; 内部节点: 子节点几何合并后简化到一页, error 为用它代替子树的误差
+// 页数据: [PackedVertex x vertexCount][uint16 索引 x triangleCount * 3], 位置在页自己的包围盒内量化,
+// 字节与上传到 GPU 的完全一致, 读入后直接 glBufferSubData
+
+const uint32_t PAGE_FILE_VERSION = 1;
+
+// 每页的容量上限 (查看器的 GPU 页池按它划分固定大小的槽)
+const uint32_t PAGE_MAX_VERTICES = 16384;
+const uint32_t PAGE_MAX_TRIANGLES = 16384;
+
+// flags 的位定义
+const uint32_t PAGE_FILE_HAS_NORMALS = 1u << 0;
+
+struct PageFileHeader {
+    char magic[8];            // "OBJPAGE\0"
+    uint32_t version;
+    uint32_t flags;
+    uint64_t nodeCount;
+    uint64_t nodeOffset;      // 节点表相对文件开头的位置 (在所有页之后)
+    float boundsMin[3];       // 整个模型的包围盒
+    float boundsMax[3];
+    uint64_t sourceTriangles; // 全部叶子的三角形数 (即源模型的三角形数)
+    uint32_t maxPageVertices; // 生成时的页容量
+    uint32_t maxPageTriangles;
+};
+
+// 八叉树节点, 子节点在节点表中连续存放, 根节点为 0
+struct PageNode {
+    float boundsMin[3];       // 本页几何的包围盒 (模型空间)
+    float boundsMax[3];
+    float quantOffset[3];     // 本页压缩顶点的反量化参数
+    float quantScale[3];
+    float error;              // 简化误差 (模型空间距离), 叶子为 0; 不小于任何子节点的误差
+    uint32_t firstChild;
+    uint32_t childCount;      // 0 表示叶子
+    uint32_t vertexCount;
+    uint32_t triangleCount;
+    uint32_t dataBytes;
+    uint64_t dataOffset;
+};
+
+// 页数据的字节数
+inline size_t pageDataBytes(uint32_t vertexCount, uint32_t triangleCount) {
+    return (size_t)vertexCount * sizeof(PackedVertex) + (size_t)triangleCount * 3 * sizeof(uint16_t);
+}
+
+inline Aabb pageNodeBounds(const PageNode& node) {
+    Aabb box;
+    box.min = glm::vec3(node.boundsMin[0], node.boundsMin[1], node.boundsMin[2]);
+    box.max = glm::vec3(node.boundsMax[0], node.boundsMax[1], node.boundsMax[2]);
+    return box;
+}
+
+// 读取端: 打开时只读入文件头和节点表 (每页几十字节), 页数据用 readPage 按需读取
+class PageFile {
+public:
+    PageFileHeader header{};
+    std::vector<PageNode> nodes;
+
+    // 读入并校验文件头和节点表 (子节点范围, 页容量, 数据范围), 失败时打印错误并返回 false
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return file.is_open(); }
+
+    bool hasNormals() const { return (header.flags & PAGE_FILE_HAS_NORMALS) != 0; }
+
+    // 把一页读入 data (至少 nodes[node].dataBytes 字节), 索引不小于页的顶点数时也返回 false;
+    // 不是线程安全的, 只由一个 I/O 线程调用
+    bool readPage(uint32_t node, void* data);
+
+    // 写入端 (obj_pages): 在所有页和节点表写完之后把文件头写到文件开头, magic 和 version 由这里填写
+    static bool writeHeader(std::ofstream& out, PageFileHeader header);
+
+private:
+    std::ifstream file;
+    uint64_t fileSize = 0;
+};
+#endif
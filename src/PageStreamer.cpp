@@ -0,0 +1,399 @@
+#include "PageStreamer.h"
+#include <algorithm>
+#include <cfloat>
+#include <iostream>
+
+namespace {
+
+// 页池至少的槽数 (根节点和它的子节点同时驻留)
+const size_t MIN_PAGE_SLOTS = 16;
+
+// nodeInPipeline 的取值
+const uint8_t PAGE_IDLE = 0;
+const uint8_t PAGE_LOADING = 1;     // 正在读或已读入等待上传
+const uint8_t PAGE_FAILED = 2;      // 读取失败, 不再重试
+
+} // namespace
+
+PageStreamer::PageStreamer(const PageStreamOptions& options) : options(options) {}
+
+PageStreamer::~PageStreamer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (ioThread.joinable()) ioThread.join();
+
+    if (VAO != 0) glDeleteVertexArrays(1, &VAO);
+    if (VBO != 0) glDeleteBuffers(1, &VBO);
+    if (EBO != 0) glDeleteBuffers(1, &EBO);
+    if (instanceVBO != 0) glDeleteBuffers(1, &instanceVBO);
+    if (indirectBuffer != 0) glDeleteBuffers(1, &indirectBuffer);
+}
+
+bool PageStreamer::open(const std::string& path) {
+    if (opened || !file.open(path)) return false;
+
+    // 槽的大小按文件的页容量; 槽数由预算决定, 但不超过节点数, 索引偏移不超出 GLuint
+    slotVertices = file.header.maxPageVertices;
+    slotIndices = file.header.maxPageTriangles * 3;
+    size_t slotBytes = std::max<size_t>(pageDataBytes(file.header.maxPageVertices, file.header.maxPageTriangles), 1);
+    size_t slotCount = std::max(MIN_PAGE_SLOTS, options.gpuBudgetBytes / slotBytes);
+    slotCount = std::min(slotCount, file.nodes.size());
+    slotCount = std::min<size_t>(slotCount, UINT32_MAX / std::max<uint32_t>(slotIndices, 1));
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+    glGenBuffers(1, &instanceVBO);
+    glGenBuffers(1, &indirectBuffer);
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(slotCount * slotVertices * sizeof(PackedVertex)), nullptr, GL_DYNAMIC_DRAW);
+    Mesh::setupVertexAttributes(true);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)(slotCount * slotIndices * sizeof(uint16_t)), nullptr, GL_DYNAMIC_DRAW);
+    Scene::bindInstanceAttributes(instanceVBO, 0);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    useMultiDrawIndirect = GLAD_GL_VERSION_4_3 != 0;
+
+    slotNode.assign(slotCount, -1);
+    slotFrame.assign(slotCount, 0);
+    lruPrev.resize(slotCount);
+    lruNext.resize(slotCount);
+    for (size_t s = 0; s < slotCount; ++s) {
+        lruPrev[s] = (int32_t)s - 1;
+        lruNext[s] = s + 1 < slotCount ? (int32_t)s + 1 : -1;
+    }
+    lruHead = 0;
+    lruTail = (int32_t)slotCount - 1;
+
+    nodeSlot.assign(file.nodes.size(), -1);
+    nodeWantedFrame.assign(file.nodes.size(), 0);
+    nodeInPipeline.assign(file.nodes.size(), PAGE_IDLE);
+
+    stats = PageStreamStats();
+    stats.slots = slotCount;
+    stats.gpuBytes = slotCount * slotBytes;
+    rateStart = std::chrono::steady_clock::now();
+
+    opened = true;
+    ioThread = std::thread(&PageStreamer::ioLoop, this);
+    return true;
+}
+
+Aabb PageStreamer::bounds() const {
+    Aabb box;
+    box.min = glm::vec3(file.header.boundsMin[0], file.header.boundsMin[1], file.header.boundsMin[2]);
+    box.max = glm::vec3(file.header.boundsMax[0], file.header.boundsMax[1], file.header.boundsMax[2]);
+    return box;
+}
+
+// I/O 线程: 按优先级读取队列中的页, 读入的页占用的内存超过 hostBudgetBytes 时等待上传释放
+void PageStreamer::ioLoop() {
+    size_t maxPageBytes = pageDataBytes(file.header.maxPageVertices, file.header.maxPageTriangles);
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        // 每个缓冲按最大页计入预算 (缓冲重复使用, 容量都是最大页); 至少允许一页
+        wake.wait(lock, [this, maxPageBytes] {
+            return stopping || (queueNext < queue.size() &&
+                                (pipelinePages == 0 || (pipelinePages + 1) * maxPageBytes <= options.hostBudgetBytes));
+        });
+        if (stopping) return;
+
+        uint32_t node = queue[queueNext++];
+        if (nodeInPipeline[node] != PAGE_IDLE) continue;
+        nodeInPipeline[node] = PAGE_LOADING;
+        ++pipelinePages;
+        size_t bytes = file.nodes[node].dataBytes;
+        stagedBytes += bytes;
+        std::vector<char> data;
+        if (!freeBuffers.empty()) {
+            data = std::move(freeBuffers.back());
+            freeBuffers.pop_back();
+        } else {
+            data.reserve(maxPageBytes); // 缓冲重复使用, 以后不再分配
+        }
+
+        lock.unlock();
+        data.resize(bytes);
+        bool ok = file.readPage(node, data.data());
+        lock.lock();
+
+        if (ok) {
+            staged.push_back({ node, std::move(data) });
+            bytesRead += bytes;
+            ++pagesRead;
+        } else {
+            std::cerr << "ERROR::PAGESTREAMER::Could not read page " << node << std::endl;
+            nodeInPipeline[node] = PAGE_FAILED;
+            --pipelinePages;
+            stagedBytes -= bytes;
+            freeBuffers.push_back(std::move(data));
+        }
+    }
+}
+
+void PageStreamer::Draw(ShaderVariants& shaders, uint32_t features, const SceneView& view, const glm::mat4& model) {
+    stats.drawnPages = 0;
+    stats.drawnTriangles = 0;
+    if (!opened) return;
+
+    ++frame;
+    slotsUsedThisFrame = 0;
+    selectNodes(view, model);
+    uploadPages();
+    submitRequests();
+    drawPages(shaders, features, model);
+    updateStats();
+}
+
+// 在模型空间中遍历: 均匀缩放时模型空间的误差 / 距离与世界空间相同
+void PageStreamer::selectNodes(const SceneView& view, const glm::mat4& model) {
+    drawList.clear();
+    requests.clear();
+    stats.wantedPages = 0;
+    stats.missingPages = 0;
+
+    Frustum frustum(view.viewProjection * model);
+    if (frustumCulling && frustum.classify(pageNodeBounds(file.nodes[0])) == CullResult::Outside) return;
+    glm::vec3 camera = glm::vec3(glm::inverse(model) * glm::vec4(view.cameraPos, 1.0f));
+    visit(0, frustum, camera, view.pixelsPerUnit, FLT_MAX);
+}
+
+void PageStreamer::visit(uint32_t node, const Frustum& frustum, const glm::vec3& camera, float pixelsPerUnit,
+                         float priority) {
+    const PageNode& page = file.nodes[node];
+    want(node, priority);
+    bool resident = nodeSlot[node] >= 0;
+
+    if (page.childCount > 0) {
+        // 投影误差: 到包围盒的最近距离处; 相机在包围盒内时一定细分
+        Aabb box = pageNodeBounds(page);
+        float distance = glm::length(camera - glm::clamp(camera, box.min, box.max));
+        float projected = distance > 0.0f ? page.error * pixelsPerUnit / distance : FLT_MAX;
+        if (projected > options.pixelError) {
+            uint32_t visible[8];
+            uint32_t visibleCount = 0;
+            bool ready = true;
+            for (uint32_t child = page.firstChild; child < page.firstChild + page.childCount; ++child) {
+                if (frustumCulling && frustum.classify(pageNodeBounds(file.nodes[child])) == CullResult::Outside) continue;
+                visible[visibleCount++] = child;
+                if (nodeSlot[child] < 0) ready = false;
+            }
+            // 子节点全部驻留 (或自己也不驻留, 没有可以代替的) 时改画子节点
+            if (ready || !resident) {
+                for (uint32_t i = 0; i < visibleCount; ++i) visit(visible[i], frustum, camera, pixelsPerUnit, projected);
+                return;
+            }
+            // 子节点还没到齐: 继续画自己, 子节点按需读取 (已驻留的保持驻留)
+            for (uint32_t i = 0; i < visibleCount; ++i) want(visible[i], projected);
+        }
+    }
+    if (resident) drawList.push_back(node);
+}
+
+// 节点本帧需要驻留: 已驻留的移到 LRU 表尾, 否则加入读取请求
+void PageStreamer::want(uint32_t node, float priority) {
+    nodeWantedFrame[node] = frame;
+    ++stats.wantedPages;
+    if (nodeSlot[node] >= 0) {
+        touch(nodeSlot[node]);
+    } else {
+        ++stats.missingPages;
+        requests.push_back({ node, priority });
+    }
+}
+
+void PageStreamer::touch(int32_t slot) {
+    if (slotFrame[slot] != frame) ++slotsUsedThisFrame;
+    slotFrame[slot] = frame;
+    if (slot == lruTail) return;
+
+    // 从链表中摘下, 接到表尾
+    if (lruPrev[slot] >= 0) lruNext[lruPrev[slot]] = lruNext[slot];
+    else lruHead = lruNext[slot];
+    lruPrev[lruNext[slot]] = lruPrev[slot];
+    lruPrev[slot] = lruTail;
+    lruNext[slot] = -1;
+    lruNext[lruTail] = slot;
+    lruTail = slot;
+}
+
+// 取表头的槽 (空槽或最久没有用到的页); 表头也是本帧用到的说明所有槽都在用, 返回 -1
+int32_t PageStreamer::allocateSlot() {
+    int32_t slot = lruHead;
+    if (slot < 0 || slotFrame[slot] == frame) return -1;
+    if (slotNode[slot] >= 0) {
+        nodeSlot[slotNode[slot]] = -1;
+        slotNode[slot] = -1;
+        --stats.residentPages;
+        ++stats.evictions;
+    }
+    return slot;
+}
+
+// 上传已读入的页 (每帧不超过 uploadBytesPerFrame, 至少一页); 最近两帧都没有选中的页直接丢弃
+void PageStreamer::uploadPages() {
+    uploads.clear();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t bytes = 0, count = 0;
+        while (count < staged.size() && (count == 0 || bytes + staged[count].data.size() <= options.uploadBytesPerFrame)) {
+            bytes += staged[count].data.size();
+            ++count;
+        }
+        for (size_t i = 0; i < count; ++i) uploads.push_back(std::move(staged[i]));
+        staged.erase(staged.begin(), staged.begin() + count);
+    }
+    if (uploads.empty()) return;
+
+    for (const StagedPage& page : uploads) {
+        const PageNode& node = file.nodes[page.node];
+        bool needed = nodeSlot[page.node] < 0 && nodeWantedFrame[page.node] + 1 >= frame;
+        int32_t slot = needed ? allocateSlot() : -1;
+        if (slot < 0) {
+            ++stats.droppedPages;
+            continue;
+        }
+        size_t vertexBytes = (size_t)node.vertexCount * sizeof(PackedVertex);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)((size_t)slot * slotVertices * sizeof(PackedVertex)),
+                        (GLsizeiptr)vertexBytes, page.data.data());
+        glBindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)((size_t)slot * slotIndices * sizeof(uint16_t)),
+                        (GLsizeiptr)(page.data.size() - vertexBytes), page.data.data() + vertexBytes);
+        slotNode[slot] = (int32_t)page.node;
+        nodeSlot[page.node] = slot;
+        touch(slot);
+        ++stats.residentPages;
+        stats.bytesUploaded += page.data.size();
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    // 缓冲还给 I/O 线程
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (StagedPage& page : uploads) {
+            nodeInPipeline[page.node] = PAGE_IDLE;
+            --pipelinePages;
+            stagedBytes -= page.data.size();
+            freeBuffers.push_back(std::move(page.data));
+        }
+    }
+    uploads.clear();
+    wake.notify_one();
+}
+
+// 用新的请求替换 I/O 队列 (投影误差大的先读); 只读本帧没有用到的槽放得下的页, 其余的读了也只能丢弃
+void PageStreamer::submitRequests() {
+    stats.poolFull = slotsUsedThisFrame + requests.size() > slotNode.size();
+    std::sort(requests.begin(), requests.end(), [](const Request& a, const Request& b) {
+        return a.priority != b.priority ? a.priority > b.priority : a.node < b.node;
+    });
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.clear();
+        queueNext = 0;
+        size_t freeSlots = slotNode.size() - std::min(slotsUsedThisFrame, slotNode.size());
+        size_t limit = freeSlots > pipelinePages ? freeSlots - pipelinePages : 0;
+        for (const Request& request : requests) {
+            if (queue.size() >= limit) break;
+            // 选择之后才上传的页已经驻留
+            if (nodeSlot[request.node] < 0 && nodeInPipeline[request.node] == PAGE_IDLE) queue.push_back(request.node);
+        }
+        stats.queuedPages = queue.size();
+    }
+    wake.notify_one();
+}
+
+// 每页一条命令, 实例属性带模型矩阵和页的反量化参数
+void PageStreamer::drawPages(ShaderVariants& shaders, uint32_t features, const glm::mat4& model) {
+    if (drawList.empty()) return;
+
+    InstanceData base;
+    base.model = model;
+    glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
+    for (int column = 0; column < 3; ++column) base.normalMatrix[column] = glm::vec4(normalMatrix[column], 0.0f);
+
+    instanceData.resize(drawList.size());
+    commands.resize(drawList.size());
+    for (size_t i = 0; i < drawList.size(); ++i) {
+        const PageNode& node = file.nodes[drawList[i]];
+        InstanceData& instance = instanceData[i];
+        instance = base;
+        instance.quantOffset = glm::vec4(node.quantOffset[0], node.quantOffset[1], node.quantOffset[2], 0.0f);
+        instance.quantScale = glm::vec4(node.quantScale[0], node.quantScale[1], node.quantScale[2], 0.0f);
+
+        DrawElementsIndirectCommand& command = commands[i];
+        int32_t slot = nodeSlot[drawList[i]];
+        command.count = node.triangleCount * 3;
+        command.instanceCount = 1;
+        command.firstIndex = (GLuint)slot * slotIndices;
+        command.baseVertex = (GLint)((uint32_t)slot * slotVertices);
+        command.baseInstance = (GLuint)i;
+        stats.drawnTriangles += node.triangleCount;
+    }
+    stats.drawnPages = drawList.size();
+
+    size_t instanceBytes = instanceData.size() * sizeof(InstanceData);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    if (instanceBytes > instanceCapacity) {
+        instanceCapacity = std::max(instanceBytes, instanceCapacity * 2);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)instanceCapacity, nullptr, GL_DYNAMIC_DRAW);
+    }
+    glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)instanceBytes, instanceData.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    shaders.get(features | SHADER_OCT_NORMALS | (file.hasNormals() ? SHADER_HAS_NORMALS : 0u)).use();
+    glBindVertexArray(VAO);
+    if (useMultiDrawIndirect) {
+        size_t commandBytes = commands.size() * sizeof(DrawElementsIndirectCommand);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+        if (commandBytes > indirectCapacity) {
+            indirectCapacity = std::max(commandBytes, indirectCapacity * 2);
+            glBufferData(GL_DRAW_INDIRECT_BUFFER, (GLsizeiptr)indirectCapacity, nullptr, GL_DYNAMIC_DRAW);
+        }
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, (GLsizeiptr)commandBytes, commands.data());
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, nullptr, (GLsizei)commands.size(), 0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    } else {
+        // 没有 baseInstance: 逐页移动实例属性指针
+        for (const DrawElementsIndirectCommand& command : commands) {
+            Scene::bindInstanceAttributes(instanceVBO, command.baseInstance);
+            glDrawElementsInstancedBaseVertex(GL_TRIANGLES, (GLsizei)command.count, GL_UNSIGNED_SHORT,
+                                              (void*)((size_t)command.firstIndex * sizeof(uint16_t)), 1, command.baseVertex);
+        }
+        Scene::bindInstanceAttributes(instanceVBO, 0);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void PageStreamer::updateStats() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.stagedPages = pipelinePages;
+        stats.stagedBytes = stagedBytes;
+        // 读取缓冲的容量都是最大页
+        size_t buffers = pipelinePages + freeBuffers.size();
+        stats.hostBytes = file.nodes.size() * sizeof(PageNode) +
+                          buffers * pageDataBytes(file.header.maxPageVertices, file.header.maxPageTriangles);
+    }
+    stats.pagesRead = pagesRead;
+    stats.bytesRead = bytesRead;
+
+    auto now = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(now - rateStart).count();
+    if (seconds >= 1.0) {
+        stats.readMBps = (double)(stats.bytesRead - rateBytesRead) / seconds / (1024.0 * 1024.0);
+        stats.uploadMBps = (double)(stats.bytesUploaded - rateBytesUploaded) / seconds / (1024.0 * 1024.0);
+        rateBytesRead = stats.bytesRead;
+        rateBytesUploaded = stats.bytesUploaded;
+        rateStart = now;
+    }
+}
@@ -0,0 +1,146 @@
+#ifndef PAGE_STREAMER_H
+#define PAGE_STREAMER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "PageFile.h"
+#include "Scene.h"
+#include "Shader.h"
+#include "InstanceData.h"
+
+// 流式加载的内存预算和细分阈值
+struct PageStreamOptions {
+    size_t gpuBudgetBytes = 256u * 1024 * 1024;     // GPU 页池 (顶点 + 索引缓冲), 按页容量划分成固定大小的槽
+    size_t hostBudgetBytes = 32u * 1024 * 1024;     // 读取缓冲 (正在读和等待上传的页, 每页按最大页计) 的内存上限
+    size_t uploadBytesPerFrame = 8u * 1024 * 1024;  // 每帧最多上传的字节数
+    float pixelError = 1.0f;                        // 投影误差不超过这个像素数的节点不再细分
+};
+
+// 驻留和带宽统计 (每帧更新; 累计值从 open 开始)
+struct PageStreamStats {
+    size_t slots = 0;               // GPU 页池的槽数
+    size_t residentPages = 0;
+    size_t wantedPages = 0;         // 本帧选中的节点 (包括还没有驻留的)
+    size_t missingPages = 0;        // 选中但没有驻留
+    size_t drawnPages = 0;
+    size_t drawnTriangles = 0;
+    size_t queuedPages = 0;         // 等待 I/O 线程读取
+    size_t stagedPages = 0;         // 已读入 (或正在读), 等待上传
+    size_t stagedBytes = 0;
+    size_t hostBytes = 0;           // 节点表 + 读取缓冲
+    size_t gpuBytes = 0;            // 页池缓冲
+    bool poolFull = false;          // 本帧选中的页放不进页池, 只读放得下的部分 (提高 pixelError 或预算)
+    uint64_t pagesRead = 0;
+    uint64_t bytesRead = 0;
+    uint64_t bytesUploaded = 0;
+    uint64_t evictions = 0;
+    uint64_t droppedPages = 0;      // 读入后已经不需要, 或没有可用的槽
+    double readMBps = 0.0;          // 最近一秒
+    double uploadMBps = 0.0;
+};
+
+// 分页网格 (.objpages, 见 PageFile.h) 的流式渲染, 模型可以比内存和显存都大
+// 每帧从根开始遍历八叉树: 视锥外的子树跳过; 投影误差 (error * pixelsPerUnit / 距离) 超过 pixelError 的节点细分,
+// 但只有可见的子节点全部驻留后才改画子节点, 否则继续画自己并请求子节点 (先粗后细, 不出现空洞).
+// 请求按投影误差排序交给 I/O 线程, 读入的页占用的内存不超过 hostBudgetBytes;
+// 渲染线程每帧最多上传 uploadBytesPerFrame 字节到固定大小的 GPU 页池, 槽用完时按 LRU 淘汰本帧没有用到的页.
+// 所有页共用一组顶点/索引缓冲, 每页一条命令 (实例属性带页的反量化参数), GL 4.3 时一次 MultiDrawIndirect.
+class PageStreamer {
+public:
+    PageStreamOptions options;      // 预算在 open 时生效, pixelError 和 uploadBytesPerFrame 可以随时修改
+    PageStreamStats stats;
+    bool frustumCulling = true;
+
+    explicit PageStreamer(const PageStreamOptions& options = PageStreamOptions());
+    ~PageStreamer();
+
+    PageStreamer(const PageStreamer&) = delete;
+    PageStreamer& operator=(const PageStreamer&) = delete;
+
+    // 读入节点表, 分配 GPU 页池并启动 I/O 线程 (在 GL 线程调用), 失败时打印错误并返回 false
+    bool open(const std::string& path);
+
+    const PageFileHeader& header() const { return file.header; }
+    size_t nodeCount() const { return file.nodes.size(); }
+    Aabb bounds() const;
+
+    // 选择节点, 提交读取请求, 上传已读入的页, 绘制驻留的选中节点;
+    // features 为着色模式, 与文件的特性 (法线, 压缩顶点) 合并后选择着色器版本
+    void Draw(ShaderVariants& shaders, uint32_t features, const SceneView& view, const glm::mat4& model);
+
+private:
+    struct StagedPage {
+        uint32_t node;
+        std::vector<char> data;
+    };
+    struct Request {
+        uint32_t node;
+        float priority;             // 投影误差, 越大越先读
+    };
+
+    PageFile file;                  // 打开后节点表只读; 页数据只由 I/O 线程读取
+    bool opened = false;
+
+    // GPU 页池
+    unsigned int VAO = 0, VBO = 0, EBO = 0, instanceVBO = 0, indirectBuffer = 0;
+    size_t instanceCapacity = 0, indirectCapacity = 0;
+    uint32_t slotVertices = 0, slotIndices = 0;
+    bool useMultiDrawIndirect = false;
+
+    // 槽的 LRU 链表: 表头最久没有用到 (空槽也在表头一侧), 表尾最近用到
+    std::vector<int32_t> slotNode;          // 槽里的节点, -1 为空
+    std::vector<uint32_t> slotFrame;        // 最后一次用到的帧
+    std::vector<int32_t> lruPrev, lruNext;
+    int32_t lruHead = -1, lruTail = -1;
+    size_t slotsUsedThisFrame = 0;
+
+    std::vector<int32_t> nodeSlot;          // 节点所在的槽, -1 为不驻留
+    std::vector<uint32_t> nodeWantedFrame;  // 最后一次被选中 (需要驻留) 的帧
+    uint32_t frame = 0;
+
+    // I/O 线程 (mutex 保护以下成员)
+    std::thread ioThread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::vector<uint32_t> queue;            // 按优先级排列, 每帧整体替换
+    size_t queueNext = 0;
+    std::vector<uint8_t> nodeInPipeline;    // 空闲 / 正在读或已读入等待上传 / 读取失败
+    std::vector<StagedPage> staged;
+    size_t pipelinePages = 0;               // 正在读和等待上传的页数
+    std::vector<std::vector<char>> freeBuffers;
+    size_t stagedBytes = 0;
+    std::atomic<uint64_t> bytesRead{ 0 };
+    std::atomic<uint64_t> pagesRead{ 0 };
+
+    // 每帧重用的临时数组
+    std::vector<uint32_t> drawList;
+    std::vector<Request> requests;
+    std::vector<StagedPage> uploads;
+    std::vector<InstanceData> instanceData;
+    std::vector<DrawElementsIndirectCommand> commands;
+
+    // 带宽统计窗口
+    std::chrono::steady_clock::time_point rateStart;
+    uint64_t rateBytesRead = 0, rateBytesUploaded = 0;
+
+    void ioLoop();
+    void selectNodes(const SceneView& view, const glm::mat4& model);
+    void visit(uint32_t node, const Frustum& frustum, const glm::vec3& camera, float pixelsPerUnit, float priority);
+    void want(uint32_t node, float priority);
+    void touch(int32_t slot);
+    int32_t allocateSlot();
+    void uploadPages();
+    void submitRequests();
+    void drawPages(ShaderVariants& shaders, uint32_t features, const glm::mat4& model);
+    void updateStats();
+};
+#endif
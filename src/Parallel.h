@@ -0,0 +1,40 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// 线程数: 0 表示使用全部硬件线程
+inline unsigned int resolveThreadCount(unsigned int requested) {
+    if (requested != 0) return requested;
+    unsigned int hw = std::thread::hardware_concurrency();
+    return hw == 0 ? 1 : hw;
+}
+
+// 简单的并行 for: workers 个线程从原子计数器领取 [0, count) 中的任务
+// workers <= 1 或只有一个任务时直接在调用线程上执行
+template <typename Func>
+void parallelFor(size_t count, unsigned int workers, Func&& func) {
+    workers = (unsigned int)std::min<size_t>(workers, count);
+    if (workers <= 1) {
+        for (size_t i = 0; i < count; ++i) func(i);
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+            func(i);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (unsigned int t = 1; t < workers; ++t) threads.emplace_back(worker);
+    worker(); // 调用线程也参与
+    for (auto& thread : threads) thread.join();
+}
+#endif
@@ -0,0 +1,263 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include "imgui.h"
+
+void ProfileHistory::push(float value) {
+    samples[next] = value;
+    next = (next + 1) % PROFILE_HISTORY;
+    count = std::min(count + 1, PROFILE_HISTORY);
+}
+
+// 最近秩分位数
+ProfileStats ProfileHistory::stats() const {
+    ProfileStats result;
+    if (count == 0) return result;
+    std::vector<float> sorted(count);
+    for (int i = 0; i < count; ++i) sorted[i] = samples[(next + PROFILE_HISTORY - count + i) % PROFILE_HISTORY];
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&sorted](float p) {
+        int rank = (int)std::ceil(p * (float)sorted.size());
+        return sorted[std::min((int)sorted.size(), std::max(rank, 1)) - 1];
+    };
+    float sum = 0.0f;
+    for (float sample : sorted) sum += sample;
+    result.mean = sum / (float)sorted.size();
+    result.p50 = percentile(0.50f);
+    result.p95 = percentile(0.95f);
+    result.p99 = percentile(0.99f);
+    result.max = sorted.back();
+    return result;
+}
+
+FrameProfiler::FrameProfiler() {
+    origin = std::chrono::steady_clock::now();
+}
+
+FrameProfiler::~FrameProfiler() {
+    for (FrameQueries& queries : frameQueries) {
+        for (GpuRange& range : queries.ranges) {
+            glDeleteQueries(1, &range.elapsedQuery);
+            glDeleteQueries(1, &range.timestampQuery);
+        }
+    }
+}
+
+double FrameProfiler::microsecondsSinceOrigin(std::chrono::steady_clock::time_point time) const {
+    return std::chrono::duration<double, std::micro>(time - origin).count();
+}
+
+int FrameProfiler::findSection(const char* name, bool gpu) {
+    for (size_t i = 0; i < sections.size(); ++i) {
+        if (sections[i].name == name) {
+            sections[i].gpu = sections[i].gpu || gpu;
+            return (int)i;
+        }
+    }
+    ProfileSection section;
+    section.name = name;
+    section.gpu = gpu;
+    sections.push_back(section);
+    return (int)sections.size() - 1;
+}
+
+void FrameProfiler::beginFrame() {
+    auto now = std::chrono::steady_clock::now();
+    if (hasFrame) frameMs.push(std::chrono::duration<float, std::milli>(now - frameStart).count());
+    frameStart = now;
+    hasFrame = true;
+
+    // 这一组查询是 PROFILE_LATENCY 帧之前发出的, 读出后重用
+    FrameQueries& queries = frameQueries[frameIndex % PROFILE_LATENCY];
+    collectGpuResults(queries);
+    queries.used = 0;
+
+    if (capturing()) calibrateGpuClock();
+    for (ProfileSection& section : sections) section.frameCpuMs = 0.0f;
+}
+
+void FrameProfiler::endFrame() {
+    auto now = std::chrono::steady_clock::now();
+    frameCpuMs.push(std::chrono::duration<float, std::milli>(now - frameStart).count());
+    for (ProfileSection& section : sections) section.cpuMs.push(section.frameCpuMs);
+
+    // 录制: 先录 captureFrames 帧, 再等 PROFILE_LATENCY 帧取回最后几帧的 GPU 结果
+    if (captureFrames > 0) {
+        if (--captureFrames == 0) captureFlushFrames = PROFILE_LATENCY;
+    } else if (captureFlushFrames > 0) {
+        if (--captureFlushFrames == 0) writeTrace();
+    }
+    ++frameIndex;
+}
+
+int FrameProfiler::beginSection(const char* name, bool gpu) {
+    OpenSection open;
+    open.section = findSection(name, gpu);
+    open.gpuRange = -1;
+
+    if (gpu && gpuTimers && !gpuRangeActive) {
+        FrameQueries& queries = frameQueries[frameIndex % PROFILE_LATENCY];
+        if (queries.used == queries.ranges.size()) {
+            GpuRange range;
+            glGenQueries(1, &range.elapsedQuery);
+            glGenQueries(1, &range.timestampQuery);
+            queries.ranges.push_back(range);
+        }
+        GpuRange& range = queries.ranges[queries.used];
+        range.section = open.section;
+        range.traced = captureFrames > 0;
+        glQueryCounter(range.timestampQuery, GL_TIMESTAMP);
+        glBeginQuery(GL_TIME_ELAPSED, range.elapsedQuery);
+        gpuRangeActive = true;
+        open.gpuRange = (int)queries.used++;
+    }
+
+    open.start = std::chrono::steady_clock::now();
+    openSections.push_back(open);
+    return (int)openSections.size() - 1;
+}
+
+void FrameProfiler::endSection(int section) {
+    auto now = std::chrono::steady_clock::now();
+    // 区段按作用域嵌套, 句柄总是栈顶
+    if (section != (int)openSections.size() - 1) return;
+    OpenSection open = openSections.back();
+    openSections.pop_back();
+
+    if (open.gpuRange >= 0) {
+        glEndQuery(GL_TIME_ELAPSED);
+        gpuRangeActive = false;
+    }
+
+    float ms = std::chrono::duration<float, std::milli>(now - open.start).count();
+    sections[open.section].frameCpuMs += ms;
+    if (captureFrames > 0) {
+        traceEvents.push_back({ open.section, false, microsecondsSinceOrigin(open.start), (double)ms * 1000.0 });
+    }
+}
+
+// 读取一组查询; 没就绪的结果丢弃, 不等待
+void FrameProfiler::collectGpuResults(FrameQueries& queries) {
+    std::vector<float> frameGpuMs(sections.size(), 0.0f);
+    std::vector<bool> hasResult(sections.size(), false);
+    for (size_t i = 0; i < queries.used; ++i) {
+        const GpuRange& range = queries.ranges[i];
+        GLint available = 0;
+        glGetQueryObjectiv(range.elapsedQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            ++droppedGpuResults;
+            continue;
+        }
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(range.elapsedQuery, GL_QUERY_RESULT, &elapsed);
+        frameGpuMs[range.section] += (float)((double)elapsed / 1.0e6);
+        hasResult[range.section] = true;
+
+        if (range.traced) {
+            GLuint64 timestamp = 0;
+            glGetQueryObjectui64v(range.timestampQuery, GL_QUERY_RESULT, &timestamp);
+            traceEvents.push_back({ range.section, true, (double)timestamp / 1000.0 + gpuToCpuUs, (double)elapsed / 1000.0 });
+        }
+    }
+    for (size_t s = 0; s < sections.size(); ++s) {
+        if (hasResult[s]) sections[s].gpuMs.push(frameGpuMs[s]);
+    }
+}
+
+// GPU 时钟和 CPU 时钟的对应关系 (录制期间每帧更新, 抵消漂移)
+void FrameProfiler::calibrateGpuClock() {
+    GLint64 gpuNow = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+    double cpuNow = microsecondsSinceOrigin(std::chrono::steady_clock::now());
+    gpuToCpuUs = cpuNow - (double)gpuNow / 1000.0;
+}
+
+void FrameProfiler::captureTrace(const std::string& path, int frames) {
+    if (capturing() || frames <= 0) return;
+    capturePath = path;
+    captureFrames = frames;
+    traceEvents.clear();
+    calibrateGpuClock();
+}
+
+// Chrome trace 格式: 完整事件 (ph = X), CPU 和 GPU 各占一条线程轨道
+void FrameProfiler::writeTrace() {
+    std::ofstream out(capturePath, std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "ERROR::PROFILER::Could not write trace: " << capturePath << std::endl;
+        traceEvents.clear();
+        return;
+    }
+    out << "{\"traceEvents\":[\n";
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n";
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+    char line[256];
+    for (const TraceEvent& event : traceEvents) {
+        snprintf(line, sizeof(line), ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                 sections[event.section].name.c_str(), event.gpu ? "gpu" : "cpu", event.gpu ? 2 : 1,
+                 event.startUs, event.durationUs);
+        out << line;
+    }
+    out << "\n]}\n";
+    std::cout << "Wrote Chrome trace: " << capturePath << " (" << traceEvents.size() << " events)" << std::endl;
+    tracePath = capturePath;
+    traceEvents.clear();
+}
+
+void FrameProfiler::drawWindow() {
+    ImGui::Begin("Profiler");
+
+    ProfileStats frame = frameMs.stats();
+    ImGui::Text("Frame: %.2f ms (%.0f FPS), p95 %.2f, p99 %.2f", frame.mean, frame.mean > 0.0f ? 1000.0f / frame.mean : 0.0f,
+                frame.p95, frame.p99);
+    char overlay[32];
+    snprintf(overlay, sizeof(overlay), "%.2f ms", frameMs.last());
+    ImGui::PlotLines("Frame", frameMs.samples.data(), PROFILE_HISTORY, frameMs.next, overlay, 0.0f,
+                     std::max(frame.max, 1.0f), ImVec2(0.0f, 60.0f));
+
+    // GPU 总时间图表 (各 GPU 区段之和)
+    ProfileHistory gpuTotal;
+    for (int i = 0; i < PROFILE_HISTORY; ++i) {
+        float sum = 0.0f;
+        for (const ProfileSection& section : sections) {
+            if (section.gpu) sum += section.gpuMs.samples[(section.gpuMs.next + i) % PROFILE_HISTORY];
+        }
+        gpuTotal.push(sum);
+    }
+    snprintf(overlay, sizeof(overlay), "%.2f ms", gpuTotal.last());
+    ImGui::PlotLines("GPU", gpuTotal.samples.data(), PROFILE_HISTORY, gpuTotal.next, overlay, 0.0f,
+                     std::max(gpuTotal.stats().max, 1.0f), ImVec2(0.0f, 60.0f));
+
+    ImGui::Checkbox("GPU Timers", &gpuTimers);
+    ImGui::SameLine();
+    ImGui::Text("Dropped GPU results: %zu", droppedGpuResults);
+
+    // 各区段: 平均 / p50 / p95 / p99 (毫秒)
+    ImGui::Separator();
+    ImGui::Text("%-14s %-27s %s", "Section", "CPU mean/p50/p95/p99", "GPU mean/p50/p95/p99");
+    for (const ProfileSection& section : sections) {
+        ProfileStats cpu = section.cpuMs.stats();
+        if (section.gpu) {
+            ProfileStats gpu = section.gpuMs.stats();
+            ImGui::Text("%-14s %5.2f %5.2f %5.2f %5.2f   %5.2f %5.2f %5.2f %5.2f", section.name.c_str(),
+                        cpu.mean, cpu.p50, cpu.p95, cpu.p99, gpu.mean, gpu.p50, gpu.p95, gpu.p99);
+        } else {
+            ImGui::Text("%-14s %5.2f %5.2f %5.2f %5.2f", section.name.c_str(), cpu.mean, cpu.p50, cpu.p95, cpu.p99);
+        }
+    }
+
+    // Chrome trace
+    ImGui::Separator();
+    if (capturing()) {
+        ImGui::Text("Capturing trace...");
+    } else {
+        if (ImGui::Button("Dump Chrome Trace (120 frames)")) captureTrace("trace.json", 120);
+        if (!tracePath.empty()) ImGui::Text("Last trace: %s", tracePath.c_str());
+    }
+
+    ImGui::End();
+}
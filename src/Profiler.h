@@ -0,0 +1,136 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <glad/glad.h>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 保留的历史帧数 (图表和分位数)
+const int PROFILE_HISTORY = 240;
+// GPU 查询对象的组数: 第 N 帧的结果在第 N + PROFILE_LATENCY 帧读取, 读取时结果通常早已就绪
+const int PROFILE_LATENCY = 3;
+
+// 一组样本的统计 (毫秒)
+struct ProfileStats {
+    float mean = 0.0f, p50 = 0.0f, p95 = 0.0f, p99 = 0.0f, max = 0.0f;
+};
+
+// 滚动历史 (环形缓冲)
+struct ProfileHistory {
+    std::vector<float> samples = std::vector<float>(PROFILE_HISTORY, 0.0f);
+    int next = 0;      // 下一个写入位置, 也是 PlotLines 的起点
+    int count = 0;
+
+    void push(float value);
+    float last() const { return samples[(next + PROFILE_HISTORY - 1) % PROFILE_HISTORY]; }
+    ProfileStats stats() const;
+};
+
+// 一个计时区段
+struct ProfileSection {
+    std::string name;
+    bool gpu = false;          // 是否有 GPU 计时
+    ProfileHistory cpuMs;
+    ProfileHistory gpuMs;
+    float frameCpuMs = 0.0f;   // 本帧累计 (同一区段一帧内可以进入多次)
+};
+
+// 帧分析器: CPU 区段用 steady_clock 计时, GPU 区段用 GL_TIME_ELAPSED 查询.
+// 查询对象按 PROFILE_LATENCY 组轮换, 读取前先检查 GL_QUERY_RESULT_AVAILABLE,
+// 没就绪的结果直接丢弃 (计入 droppedGpuResults), 因此不会让 CPU 等 GPU.
+// GL_TIME_ELAPSED 不能嵌套: GPU 区段必须依次排列, 嵌套的内层只记 CPU 时间.
+// 可以录制若干帧为 Chrome trace JSON (chrome://tracing 或 Perfetto 打开),
+// GPU 区段用 GL_TIMESTAMP 定位到 CPU 时间轴上.
+class FrameProfiler {
+public:
+    bool gpuTimers = true;
+    ProfileHistory frameMs;     // 帧间隔
+    ProfileHistory frameCpuMs;  // beginFrame 到 endFrame
+    std::vector<ProfileSection> sections;
+    size_t droppedGpuResults = 0;
+
+    FrameProfiler();
+    ~FrameProfiler();
+
+    FrameProfiler(const FrameProfiler&) = delete;
+    FrameProfiler& operator=(const FrameProfiler&) = delete;
+
+    void beginFrame();
+    void endFrame();
+
+    // 返回区段句柄, 交给 endSection
+    int beginSection(const char* name, bool gpu);
+    void endSection(int section);
+
+    // 录制接下来 frames 帧, 完成后写入 path
+    void captureTrace(const std::string& path, int frames);
+    bool capturing() const { return captureFrames > 0 || captureFlushFrames > 0; }
+    const std::string& lastTracePath() const { return tracePath; }
+
+    // ImGui 窗口: 帧时间图表和各区段的分位数
+    void drawWindow();
+
+private:
+    struct GpuRange {
+        int section = 0;
+        GLuint elapsedQuery = 0;
+        GLuint timestampQuery = 0;
+        bool traced = false;    // 录制中的帧, 结果写入 trace
+    };
+    struct FrameQueries {
+        std::vector<GpuRange> ranges;
+        size_t used = 0;
+    };
+    struct TraceEvent {
+        int section;
+        bool gpu;
+        double startUs;
+        double durationUs;
+    };
+    struct OpenSection {
+        int section;
+        std::chrono::steady_clock::time_point start;
+        int gpuRange;           // -1: 没有 GPU 计时
+    };
+
+    std::chrono::steady_clock::time_point origin;
+    std::chrono::steady_clock::time_point frameStart;
+    bool hasFrame = false;
+    uint64_t frameIndex = 0;
+
+    FrameQueries frameQueries[PROFILE_LATENCY];
+    std::vector<OpenSection> openSections;
+    bool gpuRangeActive = false;
+
+    // trace 录制
+    int captureFrames = 0;
+    int captureFlushFrames = 0;
+    std::string capturePath;
+    std::string tracePath;
+    std::vector<TraceEvent> traceEvents;
+    double gpuToCpuUs = 0.0;    // GPU 时间戳 (微秒) 加上它得到 CPU 时间轴
+
+    double microsecondsSinceOrigin(std::chrono::steady_clock::time_point time) const;
+    int findSection(const char* name, bool gpu);
+    void collectGpuResults(FrameQueries& queries);
+    void calibrateGpuClock();
+    void writeTrace();
+};
+
+// 作用域计时
+class ProfileScope {
+public:
+    ProfileScope(FrameProfiler& profiler, const char* name, bool gpu = false)
+        : profiler(profiler), section(profiler.beginSection(name, gpu)) {}
+    ~ProfileScope() { profiler.endSection(section); }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    FrameProfiler& profiler;
+    int section;
+};
+#endif
@@ -0,0 +1,128 @@
+#include "ProgramCache.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+const char PROGRAM_CACHE_MAGIC[8] = { 'O', 'B', 'J', 'P', 'R', 'O', 'G', '\0' };
+const uint32_t PROGRAM_CACHE_VERSION = 1;
+
+struct ProgramCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t format;        // glGetProgramBinary 返回的 binaryFormat
+    uint64_t key;
+    uint64_t length;        // 二进制的字节数
+};
+
+// FNV-1a 64 位
+uint64_t fnv1a(const void* data, size_t size, uint64_t hash) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+// 字符串连同结尾的 0 一起哈希, 拼接方式不同的输入不会得到相同的键
+uint64_t hashString(const char* text, uint64_t hash) {
+    if (text == nullptr) text = "";
+    return fnv1a(text, strlen(text) + 1, hash);
+}
+
+std::string pathFor(const std::string& cacheDir, uint64_t key) {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.glprogram", (unsigned long long)key);
+    return (std::filesystem::path(cacheDir) / name).string();
+}
+
+} // namespace
+
+bool ProgramCache::supported() {
+    if (!GLAD_GL_VERSION_4_1) return false;
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+uint64_t ProgramCache::key(const std::string& vertexSource, const std::string& fragmentSource) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    hash = fnv1a(&PROGRAM_CACHE_VERSION, sizeof(PROGRAM_CACHE_VERSION), hash);
+    hash = hashString(vertexSource.c_str(), hash);
+    hash = hashString(fragmentSource.c_str(), hash);
+    hash = hashString((const char*)glGetString(GL_VENDOR), hash);
+    hash = hashString((const char*)glGetString(GL_RENDERER), hash);
+    hash = hashString((const char*)glGetString(GL_VERSION), hash);
+    return hash;
+}
+
+GLuint ProgramCache::load(const std::string& cacheDir, uint64_t key) {
+    std::ifstream file(pathFor(cacheDir, key), std::ios::binary);
+    if (!file.is_open()) return 0; // 没有缓存, 不算错误
+
+    ProgramCacheHeader header{};
+    if (!file.read((char*)&header, sizeof(header)) ||
+        memcmp(header.magic, PROGRAM_CACHE_MAGIC, sizeof(PROGRAM_CACHE_MAGIC)) != 0 ||
+        header.version != PROGRAM_CACHE_VERSION || header.key != key ||
+        header.length == 0 || header.length > (uint64_t)INT32_MAX) {
+        return 0;
+    }
+    std::vector<char> binary((size_t)header.length);
+    if (!file.read(binary.data(), (std::streamsize)binary.size())) return 0;
+
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, (GLenum)header.format, binary.data(), (GLsizei)binary.size());
+    GLint linked = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        // 驱动不接受 (格式变了, 或二进制损坏)
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+bool ProgramCache::store(const std::string& cacheDir, uint64_t key, GLuint program) {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return false;
+    std::vector<char> binary((size_t)length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+    if (length <= 0) return false;
+
+    ProgramCacheHeader header{};
+    memcpy(header.magic, PROGRAM_CACHE_MAGIC, sizeof(PROGRAM_CACHE_MAGIC));
+    header.version = PROGRAM_CACHE_VERSION;
+    header.format = format;
+    header.key = key;
+    header.length = (uint64_t)length;
+
+    // 先写临时文件再改名, 避免留下半个文件
+    std::error_code ec;
+    std::filesystem::create_directories(cacheDir, ec);
+    std::string path = pathFor(cacheDir, key);
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open() || !file.write((const char*)&header, sizeof(header)) ||
+            !file.write(binary.data(), length)) {
+            std::cerr << "ERROR::PROGRAMCACHE::Could not write cache file: " << tempPath << std::endl;
+            file.close();
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+    }
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        std::cerr << "ERROR::PROGRAMCACHE::Could not replace cache file: " << path << std::endl;
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,26 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <string>
+
+// 着色器程序二进制缓存 (glGetProgramBinary / glProgramBinary, GL 4.1)
+// 键为最终交给 GL 的顶点/片元源码和 GL_VENDOR / GL_RENDERER / GL_VERSION 的哈希, 换驱动或改源码后自然失效.
+// 驱动仍然可以拒绝一个二进制 (glProgramBinary 之后链接状态为失败), 这时 load 返回 0,
+// 调用者完整编译一次再 store 覆盖.
+// 文件: <cacheDir>/<键的十六进制>.glprogram, 内容为 [ProgramCacheHeader][二进制]
+class ProgramCache {
+public:
+    // 当前上下文能否读写程序二进制 (需要先加载 GL 函数)
+    static bool supported();
+
+    static uint64_t key(const std::string& vertexSource, const std::string& fragmentSource);
+
+    // 从缓存创建并链接程序, 没有缓存或驱动拒绝时返回 0
+    static GLuint load(const std::string& cacheDir, uint64_t key);
+
+    // 保存已链接程序的二进制 (链接前应设置 GL_PROGRAM_BINARY_RETRIEVABLE_HINT)
+    static bool store(const std::string& cacheDir, uint64_t key, GLuint program);
+};
+#endif
@@ -0,0 +1,751 @@
+#include "Scene.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+
+namespace {
+
+// 从空闲范围中取出 bytes 字节 (首次适配), 没有足够大的范围时返回 false
+bool takeFreeRange(std::vector<PoolRange>& freeRanges, size_t bytes, size_t& offset) {
+    for (size_t i = 0; i < freeRanges.size(); ++i) {
+        PoolRange& range = freeRanges[i];
+        if (range.bytes < bytes) continue;
+        offset = range.offset;
+        range.offset += bytes;
+        range.bytes -= bytes;
+        if (range.bytes == 0) freeRanges.erase(freeRanges.begin() + i);
+        return true;
+    }
+    return false;
+}
+
+// 归还一段范围: 与前后相邻的空闲范围合并; 合并后位于已用部分末尾时直接缩短 used
+void releaseRange(std::vector<PoolRange>& freeRanges, size_t& used, PoolRange range) {
+    if (range.bytes == 0) return;
+    auto next = std::lower_bound(freeRanges.begin(), freeRanges.end(), range.offset,
+                                 [](const PoolRange& free, size_t offset) { return free.offset < offset; });
+    if (next != freeRanges.end() && range.offset + range.bytes == next->offset) {
+        range.bytes += next->bytes;
+        next = freeRanges.erase(next);
+    }
+    if (next != freeRanges.begin()) {
+        auto previous = next - 1;
+        if (previous->offset + previous->bytes == range.offset) {
+            range.offset = previous->offset;
+            range.bytes += previous->bytes;
+            next = freeRanges.erase(previous);
+        }
+    }
+    if (range.offset + range.bytes == used) {
+        used = range.offset;
+    } else {
+        freeRanges.insert(next, range);
+    }
+}
+
+} // namespace
+
+Scene::Scene() {
+    glGenBuffers(1, &instanceVBO);
+    glGenBuffers(1, &indirectBuffer);
+    // glMultiDrawElementsIndirect + baseInstance 需要 GL 4.3 (或 ARB_multi_draw_indirect)
+    useMultiDrawIndirect = GLAD_GL_VERSION_4_3 != 0;
+}
+
+Scene::~Scene() {
+    for (GeometryPool& pool : pools) {
+        if (pool.VAO != 0) glDeleteVertexArrays(1, &pool.VAO);
+        if (pool.VBO != 0) glDeleteBuffers(1, &pool.VBO);
+        if (pool.EBO != 0) glDeleteBuffers(1, &pool.EBO);
+    }
+    if (instanceVBO != 0) glDeleteBuffers(1, &instanceVBO);
+    if (indirectBuffer != 0) glDeleteBuffers(1, &indirectBuffer);
+}
+
+size_t Scene::addMesh(std::unique_ptr<Mesh> mesh) {
+    PooledMesh slot;
+    if (mesh->VAO != 0 && mesh->indexCount > 0) {
+        int poolIndex = poolFor(mesh->packed, mesh->indexType);
+        GeometryPool& pool = pools[poolIndex];
+        size_t indexSize = (mesh->indexType == GL_UNSIGNED_SHORT) ? sizeof(uint16_t) : sizeof(uint32_t);
+        size_t vertexBytes = mesh->vertexCount * mesh->vertexStride;
+        size_t indexBytes = mesh->indexCount * indexSize;
+        allocatePool(pool, vertexBytes, indexBytes, slot.vertexRange, slot.indexRange);
+
+        // GPU 端拷贝, 不经过 CPU
+        glBindBuffer(GL_COPY_READ_BUFFER, mesh->VBO);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, pool.VBO);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, (GLintptr)slot.vertexRange.offset, (GLsizeiptr)vertexBytes);
+        glBindBuffer(GL_COPY_READ_BUFFER, mesh->EBO);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, pool.EBO);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, (GLintptr)slot.indexRange.offset, (GLsizeiptr)indexBytes);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        slot.pool = poolIndex;
+        slot.baseVertex = (GLint)(slot.vertexRange.offset / mesh->vertexStride);
+        slot.firstIndex = (GLuint)(slot.indexRange.offset / indexSize);
+        slot.indexCount = (GLuint)mesh->indexCount;
+        slot.lods.resize(1);
+        slot.lods[0].firstIndex = slot.firstIndex;
+        slot.lods[0].indexCount = slot.indexCount;
+
+        mesh->releaseGpuBuffers();
+    }
+    size_t id = reserveMeshSlot();
+    meshes[id] = std::move(mesh);
+    pooledMeshes[id] = slot;
+    return id;
+}
+
+// removeMesh 留下的空位 (网格为空且不在加载中) 优先重用, 没有时追加
+size_t Scene::reserveMeshSlot() {
+    for (size_t m = 0; m < meshes.size(); ++m) {
+        if (meshes[m]) continue;
+        bool pending = std::any_of(pendingMeshes.begin(), pendingMeshes.end(),
+                                   [m](const PendingMesh& p) { return p.mesh == m; });
+        if (!pending) return m;
+    }
+    meshes.push_back(nullptr);
+    pooledMeshes.push_back(PooledMesh());
+    return meshes.size() - 1;
+}
+
+void Scene::removeMesh(size_t mesh) {
+    if (mesh >= meshes.size()) return;
+    for (size_t i = 0; i < pendingMeshes.size();) {
+        PendingMesh& pending = pendingMeshes[i];
+        if (pending.mesh != mesh) {
+            ++i;
+            continue;
+        }
+        // 上传中的新网格已经在池中预留了空间; future 析构时等待工作线程
+        if (pending.reload) releasePooledMesh(pending.replacementSlot);
+        pendingMeshes.erase(pendingMeshes.begin() + i);
+    }
+    releasePooledMesh(pooledMeshes[mesh]);
+    meshes[mesh].reset();
+    instances.erase(std::remove_if(instances.begin(), instances.end(),
+                                   [mesh](const SceneInstance& instance) { return instance.mesh == mesh; }),
+                    instances.end());
+}
+
+size_t Scene::gpuBufferBytes() const {
+    size_t bytes = instanceCapacity + indirectCapacity;
+    for (const GeometryPool& pool : pools) bytes += pool.vertexCapacity + pool.indexCapacity;
+    return bytes;
+}
+
+size_t Scene::addInstance(size_t mesh, const glm::mat4& transform) {
+    instances.push_back({ mesh, transform });
+    return instances.size() - 1;
+}
+
+// 工作线程只准备 CPU 端数据, 不调用 GL
+void Scene::startLoadJob(PendingMesh& pending, const std::string& path, const MeshLoadOptions& options) {
+    pending.progress = std::make_shared<MeshLoadProgress>();
+    pending.start = std::chrono::steady_clock::now();
+    MeshLoadOptions workerOptions = options;
+    workerOptions.deferUpload = true;
+    workerOptions.progress = pending.progress.get();
+    pending.job = std::async(std::launch::async, [path, workerOptions, progress = pending.progress]() {
+        return std::make_unique<Mesh>(path, workerOptions);
+    });
+}
+
+size_t Scene::addMeshAsync(const std::string& path, const MeshLoadOptions& options) {
+    size_t mesh = reserveMeshSlot();
+    PendingMesh pending;
+    pending.mesh = mesh;
+    startLoadJob(pending, path, options);
+    pendingMeshes.push_back(std::move(pending));
+    return mesh;
+}
+
+bool Scene::reloadMeshAsync(size_t mesh, const std::string& path, const MeshLoadOptions& options) {
+    if (mesh >= meshes.size()) return false;
+    for (const PendingMesh& pending : pendingMeshes) {
+        if (pending.mesh == mesh) return false;
+    }
+    PendingMesh pending;
+    pending.mesh = mesh;
+    pending.reload = true;
+    startLoadJob(pending, path, options);
+    pendingMeshes.push_back(std::move(pending));
+    return true;
+}
+
+MeshLoadStatus Scene::loadStatus(size_t mesh) const {
+    MeshLoadStatus status;
+    for (const PendingMesh& pending : pendingMeshes) {
+        if (pending.mesh != mesh) continue;
+        size_t total = pending.progress->bytesTotal;
+        status.stage = pending.progress->stage;
+        status.progress = total > 0 ? (float)((double)pending.progress->bytesDone / (double)total) : 0.0f;
+        return status;
+    }
+    if (mesh >= meshes.size() || !meshes[mesh] || !meshes[mesh]->loaded) {
+        status.stage = MeshLoadStage::Failed;
+        status.progress = 0.0f;
+    }
+    return status;
+}
+
+void Scene::update() {
+    if (updatedThisFrame) return;
+    updatedThisFrame = true;
+    updateLoads();
+    for (std::unique_ptr<Mesh>& mesh : meshes) {
+        if (mesh) mesh->takePickBvh(); // 后台构建完成的拾取 BVH
+    }
+}
+
+// 推进后台加载: 工作线程完成后在几何池中预留空间, 然后每帧按预算分批上传
+void Scene::updateLoads() {
+    size_t budget = uploadBytesPerFrame;
+    for (size_t i = 0; i < pendingMeshes.size();) {
+        PendingMesh& pending = pendingMeshes[i];
+        if (!pending.uploading) {
+            if (pending.job.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                ++i;
+                continue;
+            }
+            std::unique_ptr<Mesh> mesh = pending.job.get();
+            if (!mesh->loaded || !mesh->staged || mesh->indexCount == 0) {
+                pending.progress->stage = MeshLoadStage::Failed;
+                if (pending.reload) {
+                    // 保留旧网格
+                    lastReloadFailed = true;
+                    std::cerr << "ERROR::SCENE::Reload failed, keeping the previous mesh" << std::endl;
+                } else {
+                    meshes[pending.mesh] = std::move(mesh);
+                }
+                pendingMeshes.erase(pendingMeshes.begin() + i);
+                continue;
+            }
+            beginUpload(pending, std::move(mesh));
+        }
+
+        budget -= uploadStep(pending, budget);
+        if (pending.vertexDone == pending.vertexBytes && pending.indexDone == pending.indexBytes) {
+            // 全部驻留, 按保留策略留下 CPU 端几何, 释放上传数据 (从缓存加载时同时解除映射)
+            Mesh& uploaded = uploadTarget(pending);
+            uploaded.retainHostGeometry(*uploaded.staged);
+            uploaded.staged.reset();
+            if (pending.reload) {
+                // 替换网格, 旧网格的池空间归还给空闲列表, 供下一次重新加载或其他网格重用
+                meshes[pending.mesh] = std::move(pending.replacement);
+                releasePooledMesh(pooledMeshes[pending.mesh]);
+                pooledMeshes[pending.mesh] = pending.replacementSlot;
+                lastReloadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - pending.start).count();
+                lastReloadFailed = false;
+            }
+            pending.progress->stage = MeshLoadStage::Done;
+            pendingMeshes.erase(pendingMeshes.begin() + i);
+            continue;
+        }
+        ++i;
+    }
+}
+
+// 在几何池中预留整个网格的空间; 索引在上传之前不参与绘制 (lods[0].indexCount 为已驻留的索引数)
+void Scene::beginUpload(PendingMesh& pending, std::unique_ptr<Mesh> mesh) {
+    const MeshUploadData& upload = *mesh->staged;
+    int poolIndex = poolFor(mesh->packed, mesh->indexType);
+    GeometryPool& pool = pools[poolIndex];
+    pending.vertexBytes = upload.vertexCount * upload.vertexStride;
+    pending.indexBytes = upload.indexCount * upload.indexSize;
+    PooledMesh& slot = uploadSlot(pending);
+    allocatePool(pool, pending.vertexBytes, pending.indexBytes, slot.vertexRange, slot.indexRange);
+    pending.vertexOffset = slot.vertexRange.offset;
+    pending.indexOffset = slot.indexRange.offset;
+
+    slot.pool = poolIndex;
+    slot.baseVertex = (GLint)(slot.vertexRange.offset / upload.vertexStride);
+    slot.firstIndex = (GLuint)(slot.indexRange.offset / upload.indexSize);
+    slot.indexCount = (GLuint)upload.indexCount;
+    slot.lods.assign(1, MeshLod());
+    slot.lods[0].firstIndex = slot.firstIndex;
+
+    pending.progress->bytesDone = 0;
+    pending.progress->bytesTotal = pending.vertexBytes + pending.indexBytes;
+    pending.progress->stage = MeshLoadStage::Uploading;
+    pending.uploading = true;
+    if (pending.reload) {
+        pending.replacement = std::move(mesh);
+    } else {
+        meshes[pending.mesh] = std::move(mesh);
+    }
+}
+
+// 上传一批数据, 返回用掉的字节数
+// 顶点先全部上传 (索引可能引用任意顶点), 索引按整三角形上传, 已上传的部分立即可以绘制
+size_t Scene::uploadStep(PendingMesh& pending, size_t budget) {
+    const MeshUploadData& upload = *uploadTarget(pending).staged;
+    PooledMesh& slot = uploadSlot(pending);
+    const GeometryPool& pool = pools[slot.pool];
+    size_t used = 0;
+
+    if (pending.vertexDone < pending.vertexBytes && budget > 0) {
+        size_t bytes = std::min(budget, pending.vertexBytes - pending.vertexDone);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, pool.VBO);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)(pending.vertexOffset + pending.vertexDone), (GLsizeiptr)bytes,
+                        (const char*)upload.vertexData + pending.vertexDone);
+        pending.vertexDone += bytes;
+        used += bytes;
+    }
+    if (pending.vertexDone == pending.vertexBytes && pending.indexDone < pending.indexBytes && used < budget) {
+        size_t remaining = pending.indexBytes - pending.indexDone;
+        size_t bytes = std::min(budget - used, remaining);
+        if (bytes < remaining) bytes -= bytes % (3 * upload.indexSize);
+        if (bytes > 0) {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, pool.EBO);
+            glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)(pending.indexOffset + pending.indexDone), (GLsizeiptr)bytes,
+                            (const char*)upload.indexData + pending.indexDone);
+            pending.indexDone += bytes;
+            used += bytes;
+            slot.lods[0].indexCount = (uint32_t)(pending.indexDone / upload.indexSize);
+        }
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    pending.progress->bytesDone = pending.vertexDone + pending.indexDone;
+    return used;
+}
+
+// 查找或创建 (顶点布局, 索引类型) 对应的共享几何池
+int Scene::poolFor(bool packed, GLenum indexType) {
+    for (size_t i = 0; i < pools.size(); ++i) {
+        if (pools[i].packed == packed && pools[i].indexType == indexType) return (int)i;
+    }
+    GeometryPool pool;
+    pool.packed = packed;
+    pool.indexType = indexType;
+    pools.push_back(pool);
+    return (int)pools.size() - 1;
+}
+
+// 在池中分配顶点和索引范围: 先重用空出的范围, 否则追加在已用部分末尾 (必要时扩容)
+// 空闲范围的起点和长度都是顶点大小 / 索引大小的整数倍, 切分后仍然对齐
+void Scene::allocatePool(GeometryPool& pool, size_t vertexBytes, size_t indexBytes, PoolRange& vertexRange,
+                         PoolRange& indexRange) {
+    vertexRange = PoolRange();
+    indexRange = PoolRange();
+    vertexRange.bytes = vertexBytes;
+    indexRange.bytes = indexBytes;
+    bool vertexReused = vertexBytes == 0 || takeFreeRange(pool.freeVertexRanges, vertexBytes, vertexRange.offset);
+    bool indexReused = indexBytes == 0 || takeFreeRange(pool.freeIndexRanges, indexBytes, indexRange.offset);
+    size_t vertexEnd = pool.vertexBytes + (vertexReused ? 0 : vertexBytes);
+    size_t indexEnd = pool.indexBytes + (indexReused ? 0 : indexBytes);
+    reservePool(pool, vertexEnd, indexEnd);
+    if (!vertexReused) {
+        vertexRange.offset = pool.vertexBytes;
+        pool.vertexBytes = vertexEnd;
+    }
+    if (!indexReused) {
+        indexRange.offset = pool.indexBytes;
+        pool.indexBytes = indexEnd;
+    }
+}
+
+// 归还网格在几何池中占用的全部范围 (原网格和 LOD 索引)
+void Scene::releasePooledMesh(PooledMesh& slot) {
+    if (slot.pool >= 0) {
+        GeometryPool& pool = pools[slot.pool];
+        releaseRange(pool.freeVertexRanges, pool.vertexBytes, slot.vertexRange);
+        releaseRange(pool.freeIndexRanges, pool.indexBytes, slot.indexRange);
+        releaseRange(pool.freeIndexRanges, pool.indexBytes, slot.lodRange);
+    }
+    slot = PooledMesh();
+}
+
+// 容量不足时按两倍扩容, 已用部分 (包括其中空出的范围) 用 glCopyBufferSubData 搬到新缓冲
+void Scene::reservePool(GeometryPool& pool, size_t vertexBytes, size_t indexBytes) {
+    bool changed = false;
+    auto grow = [&changed](unsigned int& buffer, size_t& capacity, size_t used, size_t required) {
+        if (buffer != 0 && required <= capacity) return;
+        size_t newCapacity = std::max(required, capacity * 2);
+        unsigned int newBuffer = 0;
+        glGenBuffers(1, &newBuffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)newCapacity, nullptr, GL_STATIC_DRAW);
+        if (buffer != 0) {
+            if (used > 0) {
+                glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+                glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)used);
+                glBindBuffer(GL_COPY_READ_BUFFER, 0);
+            }
+            glDeleteBuffers(1, &buffer);
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        buffer = newBuffer;
+        capacity = newCapacity;
+        changed = true;
+    };
+    grow(pool.VBO, pool.vertexCapacity, pool.vertexBytes, vertexBytes);
+    grow(pool.EBO, pool.indexCapacity, pool.indexBytes, indexBytes);
+    if (changed) setupPoolVao(pool);
+}
+
+// 几何池的 VAO: 顶点属性来自池的 VBO, 每实例属性来自共享的实例缓冲
+void Scene::setupPoolVao(GeometryPool& pool) {
+    if (pool.VAO == 0) glGenVertexArrays(1, &pool.VAO);
+    glBindVertexArray(pool.VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, pool.VBO);
+    Mesh::setupVertexAttributes(pool.packed);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, pool.EBO);
+    bindInstanceAttributes(instanceVBO, 0);
+
+    glBindVertexArray(0);
+}
+
+// 每实例属性指针 (需要先绑定 VAO), firstInstance 用于没有 baseInstance 的回退路径
+void Scene::bindInstanceAttributes(GLuint buffer, size_t firstInstance) {
+    size_t base = firstInstance * sizeof(InstanceData);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    for (unsigned int column = 0; column < 4; ++column) {
+        GLuint location = INSTANCE_MODEL_LOCATION + column;
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                              (void*)(base + offsetof(InstanceData, model) + column * sizeof(glm::vec4)));
+        glVertexAttribDivisor(location, 1);
+    }
+    glEnableVertexAttribArray(INSTANCE_QUANT_OFFSET_LOCATION);
+    glVertexAttribPointer(INSTANCE_QUANT_OFFSET_LOCATION, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                          (void*)(base + offsetof(InstanceData, quantOffset)));
+    glVertexAttribDivisor(INSTANCE_QUANT_OFFSET_LOCATION, 1);
+
+    glEnableVertexAttribArray(INSTANCE_QUANT_SCALE_LOCATION);
+    glVertexAttribPointer(INSTANCE_QUANT_SCALE_LOCATION, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                          (void*)(base + offsetof(InstanceData, quantScale)));
+    glVertexAttribDivisor(INSTANCE_QUANT_SCALE_LOCATION, 1);
+
+    for (unsigned int column = 0; column < 3; ++column) {
+        GLuint location = INSTANCE_NORMAL_MATRIX_LOCATION + column;
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                              (void*)(base + offsetof(InstanceData, normalMatrix) + column * sizeof(glm::vec4)));
+        glVertexAttribDivisor(location, 1);
+    }
+}
+
+// 实例的世界空间包围盒; 实例数变化时重建 BVH, 否则只更新包围盒
+void Scene::updateInstanceBvh() {
+    instanceBounds.resize(instances.size());
+    for (size_t i = 0; i < instances.size(); ++i) {
+        const SceneInstance& instance = instances[i];
+        if (instance.mesh < meshes.size() && pooledMeshes[instance.mesh].pool >= 0) {
+            instanceBounds[i] = transformAabb(meshes[instance.mesh]->bounds, instance.transform);
+        } else {
+            instanceBounds[i] = Aabb();
+        }
+    }
+    if (!frustumCulling) return;
+    if (instanceBvh.itemCount() != instances.size()) {
+        instanceBvh.build(instanceBounds);
+    } else {
+        instanceBvh.refit(instanceBounds);
+    }
+}
+
+// 后台生成的 LOD 索引追加到几何池的索引缓冲末尾 (与原网格共用 baseVertex)
+void Scene::uploadLods(size_t mesh) {
+    Mesh& source = *meshes[mesh];
+    PooledMesh& slot = pooledMeshes[mesh];
+    if (slot.pool < 0 || source.lods.empty()) return;
+
+    GeometryPool& pool = pools[slot.pool];
+    bool shortIndices = pool.indexType == GL_UNSIGNED_SHORT;
+    size_t indexSize = shortIndices ? sizeof(uint16_t) : sizeof(uint32_t);
+    size_t indexBytes = source.lodIndices.size() * indexSize;
+    releaseRange(pool.freeIndexRanges, pool.indexBytes, slot.lodRange);
+    PoolRange unusedVertices;
+    allocatePool(pool, 0, indexBytes, unusedVertices, slot.lodRange);
+
+    std::vector<uint16_t> shortScratch;
+    const void* data = source.lodIndices.data();
+    if (shortIndices) {
+        shortScratch.assign(source.lodIndices.begin(), source.lodIndices.end());
+        data = shortScratch.data();
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, pool.EBO);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)slot.lodRange.offset, (GLsizeiptr)indexBytes, data);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    GLuint poolFirst = (GLuint)(slot.lodRange.offset / indexSize);
+    slot.lods.resize(1);
+    for (const MeshLod& lod : source.lods) {
+        MeshLod pooled = lod;
+        pooled.firstIndex = poolFirst + lod.firstIndex;
+        slot.lods.push_back(pooled);
+    }
+
+    // 已经在 GPU 上, 不再需要 CPU 端的副本
+    std::vector<uint32_t>().swap(source.lodIndices);
+}
+
+// 选择投影误差不超过 lodPixelError 的最粗级别
+int Scene::selectLod(size_t instance, const SceneView& view) const {
+    const PooledMesh& slot = pooledMeshes[instances[instance].mesh];
+    int levels = (int)slot.lods.size();
+    if (!useLods || levels <= 1) return 0;
+    if (forceLod >= 0) return std::min(forceLod, levels - 1);
+
+    // 到包围球表面的距离, 相机在包围球内时用原网格
+    const Aabb& bounds = instanceBounds[instance];
+    float radius = glm::length(bounds.extent()) * 0.5f;
+    float distance = glm::length(bounds.center() - view.cameraPos) - radius;
+    if (distance <= 0.0f) return 0;
+
+    // 误差是模型空间距离, 按实例的最大缩放换算到世界空间
+    const glm::mat4& m = instances[instance].transform;
+    float scale = std::max(glm::length(glm::vec3(m[0])), std::max(glm::length(glm::vec3(m[1])), glm::length(glm::vec3(m[2]))));
+    for (int level = levels - 1; level > 0; --level) {
+        float pixels = slot.lods[level].error * scale / distance * view.pixelsPerUnit;
+        if (pixels <= lodPixelError) return level;
+    }
+    return 0;
+}
+
+// 多簇网格的一个实例: 在模型空间裁剪簇和 meshlet, 索引缓冲中相邻的可见范围合并成一条命令
+void Scene::addClusterCommands(const SceneInstance& instance, const SceneView& view) {
+    const Mesh& mesh = *meshes[instance.mesh];
+    const PooledMesh& slot = pooledMeshes[instance.mesh];
+
+    // 异步上传中的网格只绘制索引已经全部驻留的簇
+    uint32_t residentIndices = slot.lods[0].indexCount;
+    auto resident = [&mesh, residentIndices](uint32_t c) {
+        return mesh.clusters[c].firstIndex + mesh.clusters[c].indexCount <= residentIndices;
+    };
+
+    Frustum frustum(view.viewProjection * instance.transform);
+    clusterList.clear();
+    if (frustumCulling) {
+        mesh.clusterBvh.cull(frustum, [this, &resident](uint32_t cluster) {
+            if (resident(cluster)) clusterList.push_back(cluster);
+        });
+        std::sort(clusterList.begin(), clusterList.end());
+    } else {
+        for (uint32_t c = 0; c < (uint32_t)mesh.clusters.size(); ++c) {
+            if (resident(c)) clusterList.push_back(c);
+        }
+    }
+    visibleClusters += clusterList.size();
+    if (clusterList.empty()) return;
+
+    GLuint baseInstance = (GLuint)instanceData.size();
+    instanceData.push_back(mesh.instanceData(instance.transform));
+
+    // 追加一段索引范围, 紧接上一条命令时直接延长它
+    std::vector<DrawElementsIndirectCommand>& out = batchCommands[batchFor(instance.mesh)];
+    auto emit = [&](uint32_t firstIndex, uint32_t indexCount) {
+        GLuint first = slot.firstIndex + firstIndex;
+        if (!out.empty() && out.back().baseInstance == baseInstance && out.back().firstIndex + out.back().count == first) {
+            out.back().count += indexCount;
+        } else {
+            DrawElementsIndirectCommand command;
+            command.count = indexCount;
+            command.instanceCount = 1;
+            command.firstIndex = first;
+            command.baseVertex = slot.baseVertex;
+            command.baseInstance = baseInstance;
+            out.push_back(command);
+        }
+        drawnTriangles += indexCount / 3;
+    };
+
+    bool cullMeshlets = meshletCulling && useMultiDrawIndirect && !mesh.meshlets.empty();
+    if (!cullMeshlets) {
+        for (uint32_t c : clusterList) emit(mesh.clusters[c].firstIndex, mesh.clusters[c].indexCount);
+        return;
+    }
+
+    // 背面测试在模型空间进行: 仿射变换不改变三角形相对相机的朝向, 但镜像变换会翻转绕序
+    glm::mat4 transform = instance.transform;
+    bool backfaceTest = meshletBackfaceCulling && glm::determinant(glm::mat3(transform)) > 0.0f;
+    glm::vec3 camera = backfaceTest ? glm::vec3(glm::inverse(transform) * glm::vec4(view.cameraPos, 1.0f)) : glm::vec3(0.0f);
+    for (uint32_t c : clusterList) {
+        const MeshCluster& cluster = mesh.clusters[c];
+        for (uint32_t m = cluster.firstMeshlet; m < cluster.firstMeshlet + cluster.meshletCount; ++m) {
+            const Meshlet& meshlet = mesh.meshlets[m];
+            if (frustumCulling && frustum.outside(meshlet.center, meshlet.radius)) {
+                ++frustumCulledMeshlets;
+                continue;
+            }
+            if (backfaceTest && meshletBackfacing(meshlet, camera)) {
+                ++backfaceCulledMeshlets;
+                continue;
+            }
+            ++visibleMeshlets;
+            emit(meshlet.firstIndex, meshlet.indexCount);
+        }
+    }
+}
+
+void Scene::Draw(ShaderVariants& shaders, uint32_t features, const SceneView& view) {
+    drawCalls = 0;
+    drawnTriangles = 0;
+    visibleInstances = 0;
+    visibleClusters = 0;
+    culledClusters = 0;
+    visibleMeshlets = 0;
+    frustumCulledMeshlets = 0;
+    backfaceCulledMeshlets = 0;
+    std::fill(std::begin(lodInstances), std::end(lodInstances), 0);
+    std::fill(std::begin(lodTriangles), std::end(lodTriangles), 0);
+    update();
+    updatedThisFrame = false;
+    if (instances.empty() || pools.empty()) return;
+
+    // 后台生成完成的 LOD 链 (异步加载的网格在原网格上传完成之后再追加)
+    for (size_t m = 0; m < meshes.size(); ++m) {
+        const PooledMesh& slot = pooledMeshes[m];
+        if (!meshes[m] || slot.pool < 0 || slot.lods[0].indexCount != slot.indexCount) continue;
+        if (meshes[m]->takeLods()) uploadLods(m);
+    }
+
+    // 实例级视锥裁剪
+    updateInstanceBvh();
+    visibleList.clear();
+    if (frustumCulling) {
+        instanceBvh.cull(Frustum(view.viewProjection), [this](uint32_t i) { visibleList.push_back(i); });
+    } else {
+        for (uint32_t i = 0; i < (uint32_t)instances.size(); ++i) visibleList.push_back(i);
+    }
+
+    // 被整体裁掉的实例计入裁掉的簇
+    size_t totalClusters = 0;
+    for (const SceneInstance& instance : instances) {
+        if (instance.mesh < meshes.size() && pooledMeshes[instance.mesh].pool >= 0) {
+            totalClusters += std::max<size_t>(meshes[instance.mesh]->clusters.size(), 1);
+        }
+    }
+
+    // 每个可见实例选择 LOD; 简化级别和单簇网格按 (网格, 级别) 分组 (计数排序),
+    // 同一组的实例在实例缓冲中连续存放, 用一条实例化命令绘制
+    visibleLods.resize(visibleList.size());
+    meshInstanceStart.assign(meshes.size() * MAX_LOD_LEVELS + 1, 0);
+    for (size_t v = 0; v < visibleList.size(); ++v) {
+        const SceneInstance& instance = instances[visibleList[v]];
+        if (instance.mesh >= meshes.size() || pooledMeshes[instance.mesh].pool < 0) continue;
+        ++visibleInstances;
+        int lod = selectLod(visibleList[v], view);
+        visibleLods[v] = (uint8_t)lod;
+        ++lodInstances[lod];
+        if (lod > 0 || meshes[instance.mesh]->clusters.size() <= 1) {
+            ++meshInstanceStart[instance.mesh * MAX_LOD_LEVELS + lod + 1];
+        }
+    }
+    size_t groupCount = meshes.size() * MAX_LOD_LEVELS;
+    for (size_t g = 0; g < groupCount; ++g) meshInstanceStart[g + 1] += meshInstanceStart[g];
+
+    instanceData.resize(meshInstanceStart[groupCount]);
+    {
+        std::vector<size_t> cursor(meshInstanceStart.begin(), meshInstanceStart.end() - 1);
+        for (size_t v = 0; v < visibleList.size(); ++v) {
+            const SceneInstance& instance = instances[visibleList[v]];
+            if (instance.mesh >= meshes.size() || pooledMeshes[instance.mesh].pool < 0) continue;
+            if (visibleLods[v] == 0 && meshes[instance.mesh]->clusters.size() > 1) continue;
+            size_t group = instance.mesh * MAX_LOD_LEVELS + visibleLods[v];
+            instanceData[cursor[group]++] = meshes[instance.mesh]->instanceData(instance.transform);
+        }
+    }
+
+    // 绘制命令: 按几何池分段, 每组一条实例化命令
+    batchCommands.resize(pools.size() * 2);
+    for (std::vector<DrawElementsIndirectCommand>& list : batchCommands) list.clear();
+    for (size_t g = 0; g < groupCount; ++g) {
+        const PooledMesh& slot = pooledMeshes[g / MAX_LOD_LEVELS];
+        size_t lod = g % MAX_LOD_LEVELS;
+        GLuint count = (GLuint)(meshInstanceStart[g + 1] - meshInstanceStart[g]);
+        if (slot.pool < 0 || count == 0 || slot.lods[lod].indexCount == 0) continue;
+
+        DrawElementsIndirectCommand command;
+        command.count = slot.lods[lod].indexCount;
+        command.instanceCount = count;
+        command.firstIndex = slot.lods[lod].firstIndex;
+        command.baseVertex = slot.baseVertex;
+        command.baseInstance = (GLuint)meshInstanceStart[g];
+        batchCommands[batchFor(g / MAX_LOD_LEVELS)].push_back(command);
+        visibleClusters += count * std::max<size_t>(meshes[g / MAX_LOD_LEVELS]->clusters.size(), 1);
+        drawnTriangles += (size_t)command.count / 3 * count;
+        lodTriangles[lod] += (size_t)command.count / 3 * count;
+    }
+
+    // 用原网格绘制的多簇网格逐实例裁剪簇 (实例数据追加在分组实例之后)
+    for (size_t v = 0; v < visibleList.size(); ++v) {
+        const SceneInstance& instance = instances[visibleList[v]];
+        if (instance.mesh >= meshes.size() || pooledMeshes[instance.mesh].pool < 0) continue;
+        if (visibleLods[v] == 0 && meshes[instance.mesh]->clusters.size() > 1) {
+            size_t before = drawnTriangles;
+            addClusterCommands(instance, view);
+            lodTriangles[0] += drawnTriangles - before;
+        }
+    }
+    culledClusters = totalClusters - std::min(totalClusters, visibleClusters);
+
+    commands.clear();
+    std::vector<size_t> batchCommandStart(batchCommands.size() + 1, 0);
+    for (size_t b = 0; b < batchCommands.size(); ++b) {
+        batchCommandStart[b] = commands.size();
+        commands.insert(commands.end(), batchCommands[b].begin(), batchCommands[b].end());
+    }
+    batchCommandStart[batchCommands.size()] = commands.size();
+    if (commands.empty()) return;
+
+    // 上传实例数据 (容量不够时重新分配, 否则整体覆盖)
+    size_t instanceBytes = instanceData.size() * sizeof(InstanceData);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    if (instanceBytes > instanceCapacity) {
+        instanceCapacity = std::max(instanceBytes, instanceCapacity * 2);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)instanceCapacity, nullptr, GL_DYNAMIC_DRAW);
+    }
+    glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)instanceBytes, instanceData.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (useMultiDrawIndirect) {
+        size_t commandBytes = commands.size() * sizeof(DrawElementsIndirectCommand);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+        if (commandBytes > indirectCapacity) {
+            indirectCapacity = std::max(commandBytes, indirectCapacity * 2);
+            glBufferData(GL_DRAW_INDIRECT_BUFFER, (GLsizeiptr)indirectCapacity, nullptr, GL_DYNAMIC_DRAW);
+        }
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, (GLsizeiptr)commandBytes, commands.data());
+    }
+
+    for (size_t b = 0; b < batchCommands.size(); ++b) {
+        size_t first = batchCommandStart[b];
+        size_t count = batchCommandStart[b + 1] - first;
+        if (count == 0) continue;
+
+        const GeometryPool& pool = pools[b / 2];
+        size_t indexSize = (pool.indexType == GL_UNSIGNED_SHORT) ? sizeof(uint16_t) : sizeof(uint32_t);
+        uint32_t batchFeatures = features | (pool.packed ? SHADER_OCT_NORMALS : 0u) | (b % 2 ? SHADER_HAS_NORMALS : 0u);
+        shaders.get(batchFeatures).use();
+        glBindVertexArray(pool.VAO);
+
+        if (useMultiDrawIndirect) {
+            // 一次调用提交这一组的全部网格和实例
+            glMultiDrawElementsIndirect(GL_TRIANGLES, pool.indexType,
+                                        (void*)(first * sizeof(DrawElementsIndirectCommand)),
+                                        (GLsizei)count, 0);
+            ++drawCalls;
+        } else {
+            // GL 3.3 没有 baseInstance: 逐条命令把实例属性指针移到该命令的实例段
+            for (size_t c = first; c < first + count; ++c) {
+                const DrawElementsIndirectCommand& command = commands[c];
+                bindInstanceAttributes(instanceVBO, command.baseInstance);
+                glDrawElementsInstancedBaseVertex(GL_TRIANGLES, (GLsizei)command.count, pool.indexType,
+                                                  (void*)(command.firstIndex * indexSize),
+                                                  (GLsizei)command.instanceCount, command.baseVertex);
+                ++drawCalls;
+            }
+            bindInstanceAttributes(instanceVBO, 0);
+        }
+    }
+    glBindVertexArray(0);
+    if (useMultiDrawIndirect) glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
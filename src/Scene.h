@@ -0,0 +1,217 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Mesh.h"
+#include "Shader.h"
+#include "InstanceData.h"
+#include "Bvh.h"
+
+// glMultiDrawElementsIndirect 的命令格式
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint  baseVertex;
+    GLuint baseInstance;
+};
+
+// 场景中的一个物体: 引用一个网格 + 自己的变换
+struct SceneInstance {
+    size_t mesh;
+    glm::mat4 transform;
+};
+
+// 几何池缓冲中的一段, 单位: 字节
+struct PoolRange {
+    size_t offset = 0;
+    size_t bytes = 0;
+};
+
+// 共享几何缓冲: 顶点布局和索引类型相同的网格打包在一起, 每个池只需要一次绘制调用
+struct GeometryPool {
+    bool packed = false;
+    GLenum indexType = GL_UNSIGNED_INT;
+    unsigned int VAO = 0, VBO = 0, EBO = 0;
+    size_t vertexCapacity = 0, vertexBytes = 0; // 单位: 字节; vertexBytes / indexBytes 为已用部分的末尾
+    size_t indexCapacity = 0, indexBytes = 0;
+    // 网格被替换或移除后空出的范围 (按 offset 排序, 相邻的已合并), 分配时先在这里找 (首次适配)
+    std::vector<PoolRange> freeVertexRanges, freeIndexRanges;
+};
+
+// 网格在共享缓冲中的位置
+struct PooledMesh {
+    int pool = -1;          // -1: 网格加载失败, 不参与绘制
+    GLint baseVertex = 0;
+    GLuint firstIndex = 0;
+    GLuint indexCount = 0;
+    std::vector<MeshLod> lods; // lods[0] 为原网格; firstIndex 为池索引缓冲中的绝对位置
+    PoolRange vertexRange, indexRange, lodRange; // 占用的池空间, 网格被替换或移除时归还
+};
+
+// 后台加载中的网格
+struct PendingMesh {
+    size_t mesh = 0;                                // meshes 中预留的位置
+    std::shared_ptr<MeshLoadProgress> progress;     // 工作线程同时持有
+    std::future<std::unique_ptr<Mesh>> job;
+    bool uploading = false;                         // CPU 端完成, 正在分批上传
+    size_t vertexBytes = 0, indexBytes = 0;         // 需要上传的字节数
+    size_t vertexDone = 0, indexDone = 0;           // 已上传的字节数
+    size_t vertexOffset = 0, indexOffset = 0;       // 在几何池缓冲中的起始字节
+
+    // 重新加载: 上传完成之前继续绘制旧网格, 全部驻留后一次替换 (meshes / pooledMeshes 不会出现半个新网格)
+    bool reload = false;
+    std::unique_ptr<Mesh> replacement;
+    PooledMesh replacementSlot;
+    std::chrono::steady_clock::time_point start;
+};
+
+// 网格的加载状态 (供界面显示)
+struct MeshLoadStatus {
+    MeshLoadStage stage = MeshLoadStage::Done;
+    float progress = 1.0f; // 当前阶段的完成比例
+};
+
+// 绘制时的相机参数
+struct SceneView {
+    glm::mat4 viewProjection = glm::mat4(1.0f);
+    glm::vec3 cameraPos = glm::vec3(0.0f);
+    float pixelsPerUnit = 1.0f; // 距离为 1 处单位长度投影到屏幕上的像素数 (projection[1][1] * 视口高度 / 2)
+};
+
+// 多物体场景
+// 同一网格的所有实例用一条实例化绘制命令完成 (每实例矩阵放在实例化顶点属性中),
+// GL 4.3 可用时, 每个共享几何池的全部命令用一次 glMultiDrawElementsIndirect 提交;
+// 否则逐条命令调用 glDrawElementsInstancedBaseVertex.
+// 着色器按 (几何池, 网格是否有法线) 选择特化版本, 有法线和没有法线的网格在同一个池中时分两次提交.
+// 绘制前先用实例的 BVH 做视锥裁剪; 分成多个簇的大网格再用簇的 BVH 逐实例裁剪,
+// 只提交可见的簇; 可见簇内的 meshlet 再按包围球 (视锥) 和法线锥 (背面) 剔除,
+// 索引缓冲中相邻的存活范围合并成一条命令.
+// 网格有 LOD 链时按简化误差投影到屏幕上的像素数为每个实例选择级别.
+// 异步加载的网格在工作线程解析, 完成后每帧上传一部分到几何池,
+// 已上传的三角形 (按簇) 立即参与绘制, 渲染循环不会被阻塞.
+class Scene {
+public:
+    std::vector<std::unique_ptr<Mesh>> meshes;
+    std::vector<SceneInstance> instances;
+
+    // 统计 (每次 Draw 更新)
+    size_t drawCalls = 0;
+    size_t drawnTriangles = 0;
+    bool useMultiDrawIndirect = false;
+
+    // 视锥裁剪统计 (只有一个簇的网格, 每个实例算一个簇)
+    bool frustumCulling = true;
+    size_t visibleInstances = 0;
+    size_t visibleClusters = 0;
+    size_t culledClusters = 0;
+
+    // meshlet 剔除 (只在 MultiDrawIndirect 下进行: 回退路径每条命令一次绘制调用, 切碎命令得不偿失)
+    // 背面剔除会去掉开放网格从背面看到的三角形
+    bool meshletCulling = true;
+    bool meshletBackfaceCulling = true;
+    size_t visibleMeshlets = 0;
+    size_t frustumCulledMeshlets = 0;
+    size_t backfaceCulledMeshlets = 0;
+
+    // LOD 选择: 投影误差不超过 lodPixelError 像素的最粗级别; forceLod >= 0 时固定级别
+    bool useLods = true;
+    float lodPixelError = 1.0f;
+    int forceLod = -1;
+    size_t lodInstances[MAX_LOD_LEVELS] = {};
+    size_t lodTriangles[MAX_LOD_LEVELS] = {};
+
+    // 异步加载时每帧最多上传的字节数
+    size_t uploadBytesPerFrame = 16 * 1024 * 1024;
+
+    Scene();
+    ~Scene();
+
+    Scene(const Scene&) = delete;
+    Scene& operator=(const Scene&) = delete;
+
+    // 加入网格: 几何数据拷贝到共享缓冲 (GPU 端拷贝), 网格自己的缓冲随即释放
+    size_t addMesh(std::unique_ptr<Mesh> mesh);
+    size_t addInstance(size_t mesh, const glm::mat4& transform);
+
+    // 移除网格: 等待它的后台加载结束, 释放网格 (CPU 端数据, 拾取 BVH 等) 并归还几何池空间,
+    // 引用它的实例一并删除; 编号留空 (meshes[mesh] 为空), 之后加入的网格会重用
+    void removeMesh(size_t mesh);
+
+    // 在工作线程加载网格, 立即返回预留的网格编号 (加载完成前 meshes[mesh] 为空),
+    // 之后 Draw 每帧推进上传; 实例可以马上加入, 几何数据驻留后就会显示
+    size_t addMeshAsync(const std::string& path, const MeshLoadOptions& options = MeshLoadOptions());
+    MeshLoadStatus loadStatus(size_t mesh) const;
+    bool loading() const { return !pendingMeshes.empty(); }
+
+    // 在工作线程重新解析网格 (缓存有效时直接读缓存), 旧网格一直绘制到新网格全部上传, 实例不变.
+    // 这个网格已经在加载中时返回 false (调用者稍后再试)
+    bool reloadMeshAsync(size_t mesh, const std::string& path, const MeshLoadOptions& options = MeshLoadOptions());
+
+    // 最近一次重新加载从 reloadMeshAsync 到替换完成的时间 (毫秒), 失败时 lastReloadFailed 为 true
+    double lastReloadMs = -1.0;
+    bool lastReloadFailed = false;
+
+    // 推进后台加载 (取回完成的网格和拾取 BVH, 按预算上传一批). Draw 开头会调用, 两次 Draw 之间只生效一次;
+    // 需要在绘制之前看到刚加载完的网格时 (例如按包围盒适配视野) 先调用
+    void update();
+
+    // 绘制视锥内的实例; features 为着色模式 (HEADLIGHT / FLAT / WIREFRAME),
+    // 每批命令再加上网格的特性 (法线, 压缩顶点) 选择着色器版本
+    void Draw(ShaderVariants& shaders, uint32_t features, const SceneView& view);
+
+    // 场景的 GPU 缓冲按容量的总字节数 (几何池 + 实例 + 间接命令), 包括几何池扩容留下的余量
+    size_t gpuBufferBytes() const;
+
+    // 每实例属性 (InstanceData) 指针指向 buffer 中第 firstInstance 个实例 (需要先绑定 VAO), PageStreamer 共用
+    static void bindInstanceAttributes(GLuint buffer, size_t firstInstance);
+
+private:
+    std::vector<GeometryPool> pools;
+    std::vector<PooledMesh> pooledMeshes;
+    std::vector<PendingMesh> pendingMeshes;
+    bool updatedThisFrame = false; // update 已在这一帧 (下一次 Draw 之前) 调用过
+
+    unsigned int instanceVBO = 0, indirectBuffer = 0;
+    size_t instanceCapacity = 0, indirectCapacity = 0; // 单位: 字节
+
+    // 实例的 BVH: 实例数变化时重建, 否则每帧按新的变换更新包围盒
+    Bvh instanceBvh;
+    std::vector<Aabb> instanceBounds;
+
+    // 每帧重用的临时数组
+    std::vector<uint32_t> visibleList;
+    std::vector<uint8_t> visibleLods;
+    std::vector<uint32_t> clusterList;
+    std::vector<size_t> meshInstanceStart;
+    std::vector<InstanceData> instanceData;
+    std::vector<std::vector<DrawElementsIndirectCommand>> batchCommands; // 按 batchFor 分组
+    std::vector<DrawElementsIndirectCommand> commands;
+
+    size_t reserveMeshSlot();
+    int poolFor(bool packed, GLenum indexType);
+    void reservePool(GeometryPool& pool, size_t vertexBytes, size_t indexBytes);
+    void allocatePool(GeometryPool& pool, size_t vertexBytes, size_t indexBytes, PoolRange& vertexRange,
+                      PoolRange& indexRange);
+    void releasePooledMesh(PooledMesh& slot);
+    void setupPoolVao(GeometryPool& pool);
+    void updateLoads();
+    void startLoadJob(PendingMesh& pending, const std::string& path, const MeshLoadOptions& options);
+    void beginUpload(PendingMesh& pending, std::unique_ptr<Mesh> mesh);
+    Mesh& uploadTarget(PendingMesh& pending) { return pending.reload ? *pending.replacement : *meshes[pending.mesh]; }
+    PooledMesh& uploadSlot(PendingMesh& pending) { return pending.reload ? pending.replacementSlot : pooledMeshes[pending.mesh]; }
+    size_t uploadStep(PendingMesh& pending, size_t budget);
+    void updateInstanceBvh();
+    void uploadLods(size_t mesh);
+    int selectLod(size_t instance, const SceneView& view) const;
+    // 命令分组: 几何池 x 网格是否有法线 (两者都决定着色器版本), 每组一次 MultiDraw
+    size_t batchFor(size_t mesh) const { return (size_t)pooledMeshes[mesh].pool * 2 + (meshes[mesh]->hasNormals ? 1 : 0); }
+    void addClusterCommands(const SceneInstance& instance, const SceneView& view);
+};
+#endif
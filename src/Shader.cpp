@@ -1,11 +1,40 @@
 #include "Shader.h"
+#include <chrono>
+#include "FrameUniforms.h"
+#include "ProgramCache.h"
+
+std::string Shader::programCacheDir;
+
+namespace {
+
+// 把 defines 插到 #version 行之后 (GLSL 要求 #version 在最前面)
+std::string injectDefines(const std::string& source, const std::string& defines) {
+    if (defines.empty()) return source;
+    size_t version = source.find("#version");
+    if (version == std::string::npos) return defines + source;
+    size_t lineEnd = source.find('\n', version);
+    if (lineEnd == std::string::npos) return source + "\n" + defines;
+    return source.substr(0, lineEnd + 1) + defines + source.substr(lineEnd + 1);
+}
+
+} // namespace
+
+std::string shaderFeatureDefines(uint32_t features) {
+    static const char* names[SHADER_FEATURE_COUNT] = { "HAS_NORMALS", "OCT_NORMALS", "HEADLIGHT", "FLAT", "WIREFRAME" };
+    std::string defines;
+    for (uint32_t i = 0; i < SHADER_FEATURE_COUNT; ++i) {
+        if (features & (1u << i)) defines += std::string("#define ") + names[i] + "\n";
+    }
+    return defines;
+}
 
 // 构造函数
-Shader::Shader(const char* vPath, const char* fPath)
+Shader::Shader(const char* vPath, const char* fPath, const std::string& defines)
 {
     // 记住路径
     this->vertexPath = vPath;
     this->fragmentPath = fPath;
+    this->defines = defines;
     this->ID = 0; // 初始化 ID 为 0 (非常重要!)
 
     // 编译
@@ -15,6 +44,11 @@ Shader::Shader(const char* vPath, const char* fPath)
 // 重新加载着色器
 void Shader::reload()
 {
+    auto startTime = std::chrono::steady_clock::now();
+    auto elapsedMs = [&startTime]() {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    };
+
     // 从文件路径读取 GLSL 源码
     std::string vertexCode;
     std::string fragmentCode;
@@ -36,8 +70,8 @@ void Shader::reload()
         vShaderFile.close();
         fShaderFile.close();
         
-        vertexCode   = vShaderStream.str();
-        fragmentCode = fShaderStream.str();     
+        vertexCode   = injectDefines(vShaderStream.str(), defines);
+        fragmentCode = injectDefines(fShaderStream.str(), defines);
     }
     catch(std::ifstream::failure &e)
     {
@@ -46,6 +80,21 @@ void Shader::reload()
         return; // 退出 reload，保留旧的着色器
     }
     
+    // 先查二进制缓存, 命中时跳过编译和链接
+    bool useCache = !programCacheDir.empty() && ProgramCache::supported();
+    uint64_t cacheKey = 0;
+    if (useCache) {
+        cacheKey = ProgramCache::key(vertexCode, fragmentCode);
+        unsigned int cached = ProgramCache::load(programCacheDir, cacheKey);
+        if (cached != 0) {
+            replaceProgram(cached);
+            buildMs = elapsedMs();
+            fromProgramCache = true;
+            std::cout << "Shader loaded from program cache in " << buildMs << " ms" << std::endl;
+            return;
+        }
+    }
+
     const char* vShaderCode = vertexCode.c_str();
     const char* fShaderCode = fragmentCode.c_str();
 
@@ -66,6 +115,7 @@ void Shader::reload()
     unsigned int newID = glCreateProgram(); // 创建一个"备用"程序
     glAttachShader(newID, vertex);
     glAttachShader(newID, fragment);
+    if (useCache) glProgramParameteri(newID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(newID);
 
     // 检查"链接"是否成功
@@ -86,21 +136,31 @@ void Shader::reload()
     }
 
     // 链接成功
-    
+    replaceProgram(newID);
+
+    // 清理掉不再需要的着色器对象
+    glDeleteShader(vertex);
+    glDeleteShader(fragment);
+    buildMs = elapsedMs();
+    fromProgramCache = false;
+
+    // 写入二进制缓存 (不计入构建时间)
+    if (useCache) ProgramCache::store(programCacheDir, cacheKey, newID);
+
+    std::cout << "Shader reloaded successfully! (compiled in " << buildMs << " ms)" << std::endl;
+}
+
+void Shader::replaceProgram(unsigned int newID)
+{
     // 删除原有程序
     if (this->ID != 0)
     {
         glDeleteProgram(this->ID);
     }
-    
-    // 替换
-    this->ID = newID;
-
-    // 清理掉不再需要的着色器对象
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
 
-    std::cout << "Shader reloaded successfully!" << std::endl;
+    // 替换 (位置缓存随程序一起失效)
+    this->ID = newID;
+    cacheUniforms();
 }
 
 // 激活着色器
@@ -110,24 +170,60 @@ void Shader::use() {
 
 // 封装Uniform Setter函数
 
+GLint Shader::getUniformLocation(const std::string &name) const{
+    auto it = uniformLocations.find(name);
+    return it != uniformLocations.end() ? it->second : -1;
+}
+
 void Shader::setBool(const std::string &name, bool value) const{         
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value); 
+    glUniform1i(getUniformLocation(name), (int)value); 
 }
 
 void Shader::setInt(const std::string &name, int value) const{ 
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), value); 
+    glUniform1i(getUniformLocation(name), value); 
 }
 
 void Shader::setFloat(const std::string &name, float value) const{ 
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value); 
+    glUniform1f(getUniformLocation(name), value); 
 }
 
 void Shader::setVec3(const std::string &name, const glm::vec3 &value) const{ 
-    glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+    glUniform3fv(getUniformLocation(name), 1, &value[0]); 
 }
 
 void Shader::setMat4(const std::string &name, const glm::mat4 &mat) const{
-    glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
+}
+
+// 缓存 uniform 位置
+void Shader::cacheUniforms(){
+    uniformLocations.clear();
+
+    GLint count = 0, maxLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::string name(maxLength > 0 ? maxLength : 1, '\0');
+
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(ID, (GLuint)i, (GLsizei)name.size(), &length, &size, &type, &name[0]);
+        std::string uniformName(name.c_str(), length);
+
+        // uniform block 中的成员没有位置, 由 UBO 提供
+        GLint location = glGetUniformLocation(ID, uniformName.c_str());
+        if (location < 0) continue;
+        uniformLocations[uniformName] = location;
+
+        // 数组 "foo[0]" 也可以用 "foo" 访问
+        size_t bracket = uniformName.find('[');
+        if (bracket != std::string::npos) uniformLocations[uniformName.substr(0, bracket)] = location;
+    }
+
+    // 每帧数据的 uniform block 绑定到固定的绑定点
+    GLuint frameBlock = glGetUniformBlockIndex(ID, "FrameData");
+    if (frameBlock != GL_INVALID_INDEX) glUniformBlockBinding(ID, frameBlock, FRAME_DATA_BINDING);
 }
 
 // 错误检查
@@ -149,4 +245,23 @@ void Shader::checkCompileErrors(unsigned int shader, std::string type){
             std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
         }
     }
-}
\ No newline at end of file
+}
+
+ShaderVariants::ShaderVariants(const std::string& vertexPath, const std::string& fragmentPath)
+    : vertexPath(vertexPath), fragmentPath(fragmentPath)
+{
+}
+
+Shader& ShaderVariants::get(uint32_t features)
+{
+    std::unique_ptr<Shader>& variant = variants[features];
+    if (!variant) {
+        variant = std::make_unique<Shader>(vertexPath.c_str(), fragmentPath.c_str(), shaderFeatureDefines(features));
+    }
+    return *variant;
+}
+
+void ShaderVariants::reload()
+{
+    for (auto& entry : variants) entry.second->reload();
+}
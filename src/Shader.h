@@ -4,11 +4,27 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 
+// 着色器特性: 编译期 #define (见 ShaderVariants), 每个组合编译成一个单独的程序, 片元着色器里没有动态分支
+enum ShaderFeature : uint32_t {
+    SHADER_HAS_NORMALS = 1u << 0,   // HAS_NORMALS: 顶点带法线 (否则用屏幕空间导数算面法线)
+    SHADER_OCT_NORMALS = 1u << 1,   // OCT_NORMALS: 压缩顶点, 法线为八面体编码
+    SHADER_HEADLIGHT   = 1u << 2,   // HEADLIGHT: 光源在摄像机位置 (忽略 lightPos)
+    SHADER_FLAT        = 1u << 3,   // FLAT: 按面着色 (忽略顶点法线)
+    SHADER_WIREFRAME   = 1u << 4,   // WIREFRAME: 不计算光照, 输出线框颜色 (配合 glPolygonMode)
+};
+const uint32_t SHADER_FEATURE_COUNT = 5;
+
+// 特性位对应的 #define 行
+std::string shaderFeatureDefines(uint32_t features);
+
 class Shader
 {
 public:
@@ -19,12 +35,25 @@ public:
     std::string vertexPath;
     std::string fragmentPath;
 
+    // 程序二进制缓存目录 (见 ProgramCache.h), 为空时每次都从源码编译
+    static std::string programCacheDir;
+
+    // 最近一次成功构建程序的耗时 (读源码 + 编译链接, 或读取二进制缓存), 单位毫秒
+    double buildMs = 0.0;
+    bool fromProgramCache = false;
+
+    // 编译前插入到 #version 行之后的内容 (通常是 #define)
+    std::string defines;
+
     // 构造函数: 读取并构建着色器
-    Shader(const char* vertexPath, const char* fragmentPath);
+    Shader(const char* vertexPath, const char* fragmentPath, const std::string& defines = "");
 
     // 激活着色器
     void use();
 
+    // 查询 uniform 位置 (来自缓存, 不存在时返回 -1)
+    GLint getUniformLocation(const std::string &name) const;
+
     // uniform 工具函数 (setter)
     void setBool(const std::string &name, bool value) const;
     void setInt(const std::string &name, int value) const;
@@ -36,7 +65,34 @@ public:
     void reload();
 
 private:
+    // uniform 位置缓存, 每次链接成功替换程序后重建
+    std::unordered_map<std::string, GLint> uniformLocations;
+
+    // 换上新链接好的程序
+    void replaceProgram(unsigned int newID);
     // 检查编译/链接错误的辅助函数
     void checkCompileErrors(unsigned int shader, std::string type);
+    // 枚举程序中的 uniform 并缓存位置, 同时绑定 uniform block
+    void cacheUniforms();
+};
+// 同一对源文件的特化版本: 按特性位掩码注入 #define, 第一次用到时编译, 之后直接从表中取
+class ShaderVariants
+{
+public:
+    std::string vertexPath;
+    std::string fragmentPath;
+
+    ShaderVariants(const std::string& vertexPath, const std::string& fragmentPath);
+
+    // 取 (必要时编译) 一个版本; 编译失败的版本 ID 为 0, 绘制时什么也不画
+    Shader& get(uint32_t features);
+
+    // 重新编译所有已经用到的版本 (热重载)
+    void reload();
+
+    size_t size() const { return variants.size(); }
+
+private:
+    std::unordered_map<uint32_t, std::unique_ptr<Shader>> variants;
 };
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,296 @@
+#include "SimdKernels.h"
+#include <cfloat>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SIMD_KERNELS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#define TARGET_AVX2
+#else
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace {
+
+// ---- 标量版本 (也用于 SIMD 版本剩下的尾部) ----
+
+// 比较结果为假 (含 NaN) 时保留原值, 与 _mm_min_ps(v, current) 的语义相同
+inline float minKeep(float v, float current) { return v < current ? v : current; }
+inline float maxKeep(float v, float current) { return v > current ? v : current; }
+
+void boundsScalar(const float* x, const float* y, const float* z, size_t begin, size_t count, Aabb& box) {
+    for (size_t i = begin; i < count; ++i) {
+        box.min.x = minKeep(x[i], box.min.x);
+        box.min.y = minKeep(y[i], box.min.y);
+        box.min.z = minKeep(z[i], box.min.z);
+        box.max.x = maxKeep(x[i], box.max.x);
+        box.max.y = maxKeep(y[i], box.max.y);
+        box.max.z = maxKeep(z[i], box.max.z);
+    }
+}
+
+void transformScalar(const glm::mat4& m, float* x, float* y, float* z, size_t begin, size_t count) {
+    for (size_t i = begin; i < count; ++i) {
+        float px = x[i], py = y[i], pz = z[i];
+        // 与 glm 的 mat4 * vec4 相同的结合顺序: (m0 x + m1 y) + (m2 z + m3)
+        x[i] = (m[0][0] * px + m[1][0] * py) + (m[2][0] * pz + m[3][0]);
+        y[i] = (m[0][1] * px + m[1][1] * py) + (m[2][1] * pz + m[3][1]);
+        z[i] = (m[0][2] * px + m[1][2] * py) + (m[2][2] * pz + m[3][2]);
+    }
+}
+
+void normalizeScalar(float* x, float* y, float* z, size_t begin, size_t count, const glm::vec3& fallback) {
+    for (size_t i = begin; i < count; ++i) {
+        float length = std::sqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+        if (length > 0.0f && length <= FLT_MAX) {
+            x[i] /= length;
+            y[i] /= length;
+            z[i] /= length;
+        } else {
+            x[i] = fallback.x;
+            y[i] = fallback.y;
+            z[i] = fallback.z;
+        }
+    }
+}
+
+void crossScalar(const float* ax, const float* ay, const float* az, const float* bx, const float* by, const float* bz,
+                 float* outX, float* outY, float* outZ, size_t begin, size_t count) {
+    for (size_t i = begin; i < count; ++i) {
+        outX[i] += ay[i] * bz[i] - by[i] * az[i];
+        outY[i] += az[i] * bx[i] - bz[i] * ax[i];
+        outZ[i] += ax[i] * by[i] - bx[i] * ay[i];
+    }
+}
+
+Aabb boundsScalarAll(const float* x, const float* y, const float* z, size_t count) {
+    Aabb box;
+    boundsScalar(x, y, z, 0, count, box);
+    return box;
+}
+
+void transformScalarAll(const glm::mat4& m, float* x, float* y, float* z, size_t count) {
+    transformScalar(m, x, y, z, 0, count);
+}
+
+void normalizeScalarAll(float* x, float* y, float* z, size_t count, const glm::vec3& fallback) {
+    normalizeScalar(x, y, z, 0, count, fallback);
+}
+
+void crossScalarAll(const float* ax, const float* ay, const float* az, const float* bx, const float* by, const float* bz,
+                    float* outX, float* outY, float* outZ, size_t count) {
+    crossScalar(ax, ay, az, bx, by, bz, outX, outY, outZ, 0, count);
+}
+
+#ifdef SIMD_KERNELS_X86
+
+// ---- SSE2 (x86-64 的基线指令集, 不需要检测) ----
+
+// 4 个通道按标量的比较规则归约
+float reduceMin4(__m128 v, float current) {
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, v);
+    for (float lane : lanes) current = minKeep(lane, current);
+    return current;
+}
+
+float reduceMax4(__m128 v, float current) {
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, v);
+    for (float lane : lanes) current = maxKeep(lane, current);
+    return current;
+}
+
+Aabb boundsSse2(const float* x, const float* y, const float* z, size_t count) {
+    __m128 minX = _mm_set1_ps(FLT_MAX), minY = minX, minZ = minX;
+    __m128 maxX = _mm_set1_ps(-FLT_MAX), maxY = maxX, maxZ = maxX;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 vx = _mm_loadu_ps(x + i), vy = _mm_loadu_ps(y + i), vz = _mm_loadu_ps(z + i);
+        minX = _mm_min_ps(vx, minX); maxX = _mm_max_ps(vx, maxX);
+        minY = _mm_min_ps(vy, minY); maxY = _mm_max_ps(vy, maxY);
+        minZ = _mm_min_ps(vz, minZ); maxZ = _mm_max_ps(vz, maxZ);
+    }
+    Aabb box;
+    box.min = glm::vec3(reduceMin4(minX, FLT_MAX), reduceMin4(minY, FLT_MAX), reduceMin4(minZ, FLT_MAX));
+    box.max = glm::vec3(reduceMax4(maxX, -FLT_MAX), reduceMax4(maxY, -FLT_MAX), reduceMax4(maxZ, -FLT_MAX));
+    boundsScalar(x, y, z, i, count, box);
+    return box;
+}
+
+void transformSse2(const glm::mat4& m, float* x, float* y, float* z, size_t count) {
+    __m128 m00 = _mm_set1_ps(m[0][0]), m10 = _mm_set1_ps(m[1][0]), m20 = _mm_set1_ps(m[2][0]), m30 = _mm_set1_ps(m[3][0]);
+    __m128 m01 = _mm_set1_ps(m[0][1]), m11 = _mm_set1_ps(m[1][1]), m21 = _mm_set1_ps(m[2][1]), m31 = _mm_set1_ps(m[3][1]);
+    __m128 m02 = _mm_set1_ps(m[0][2]), m12 = _mm_set1_ps(m[1][2]), m22 = _mm_set1_ps(m[2][2]), m32 = _mm_set1_ps(m[3][2]);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 px = _mm_loadu_ps(x + i), py = _mm_loadu_ps(y + i), pz = _mm_loadu_ps(z + i);
+        __m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, px), _mm_mul_ps(m10, py)), _mm_add_ps(_mm_mul_ps(m20, pz), m30));
+        __m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m01, px), _mm_mul_ps(m11, py)), _mm_add_ps(_mm_mul_ps(m21, pz), m31));
+        __m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m02, px), _mm_mul_ps(m12, py)), _mm_add_ps(_mm_mul_ps(m22, pz), m32));
+        _mm_storeu_ps(x + i, rx);
+        _mm_storeu_ps(y + i, ry);
+        _mm_storeu_ps(z + i, rz);
+    }
+    transformScalar(m, x, y, z, i, count);
+}
+
+// 按掩码选择: mask ? a : b (SSE2 没有 blendv)
+inline __m128 select4(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+void normalizeSse2(float* x, float* y, float* z, size_t count, const glm::vec3& fallback) {
+    __m128 zero = _mm_setzero_ps(), largest = _mm_set1_ps(FLT_MAX);
+    __m128 fx = _mm_set1_ps(fallback.x), fy = _mm_set1_ps(fallback.y), fz = _mm_set1_ps(fallback.z);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 vx = _mm_loadu_ps(x + i), vy = _mm_loadu_ps(y + i), vz = _mm_loadu_ps(z + i);
+        __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz)));
+        __m128 valid = _mm_and_ps(_mm_cmpgt_ps(length, zero), _mm_cmple_ps(length, largest));
+        _mm_storeu_ps(x + i, select4(valid, _mm_div_ps(vx, length), fx));
+        _mm_storeu_ps(y + i, select4(valid, _mm_div_ps(vy, length), fy));
+        _mm_storeu_ps(z + i, select4(valid, _mm_div_ps(vz, length), fz));
+    }
+    normalizeScalar(x, y, z, i, count, fallback);
+}
+
+void crossSse2(const float* ax, const float* ay, const float* az, const float* bx, const float* by, const float* bz,
+               float* outX, float* outY, float* outZ, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 vax = _mm_loadu_ps(ax + i), vay = _mm_loadu_ps(ay + i), vaz = _mm_loadu_ps(az + i);
+        __m128 vbx = _mm_loadu_ps(bx + i), vby = _mm_loadu_ps(by + i), vbz = _mm_loadu_ps(bz + i);
+        _mm_storeu_ps(outX + i, _mm_add_ps(_mm_loadu_ps(outX + i), _mm_sub_ps(_mm_mul_ps(vay, vbz), _mm_mul_ps(vby, vaz))));
+        _mm_storeu_ps(outY + i, _mm_add_ps(_mm_loadu_ps(outY + i), _mm_sub_ps(_mm_mul_ps(vaz, vbx), _mm_mul_ps(vbz, vax))));
+        _mm_storeu_ps(outZ + i, _mm_add_ps(_mm_loadu_ps(outZ + i), _mm_sub_ps(_mm_mul_ps(vax, vby), _mm_mul_ps(vbx, vay))));
+    }
+    crossScalar(ax, ay, az, bx, by, bz, outX, outY, outZ, i, count);
+}
+
+// ---- AVX2 (运行时检测后才调用; GCC/Clang 只对这些函数启用 AVX2 代码生成) ----
+
+TARGET_AVX2 float reduceMin8(__m256 v, float current) {
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, v);
+    for (float lane : lanes) current = minKeep(lane, current);
+    return current;
+}
+
+TARGET_AVX2 float reduceMax8(__m256 v, float current) {
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, v);
+    for (float lane : lanes) current = maxKeep(lane, current);
+    return current;
+}
+
+TARGET_AVX2 Aabb boundsAvx2(const float* x, const float* y, const float* z, size_t count) {
+    __m256 minX = _mm256_set1_ps(FLT_MAX), minY = minX, minZ = minX;
+    __m256 maxX = _mm256_set1_ps(-FLT_MAX), maxY = maxX, maxZ = maxX;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 vx = _mm256_loadu_ps(x + i), vy = _mm256_loadu_ps(y + i), vz = _mm256_loadu_ps(z + i);
+        minX = _mm256_min_ps(vx, minX); maxX = _mm256_max_ps(vx, maxX);
+        minY = _mm256_min_ps(vy, minY); maxY = _mm256_max_ps(vy, maxY);
+        minZ = _mm256_min_ps(vz, minZ); maxZ = _mm256_max_ps(vz, maxZ);
+    }
+    Aabb box;
+    box.min = glm::vec3(reduceMin8(minX, FLT_MAX), reduceMin8(minY, FLT_MAX), reduceMin8(minZ, FLT_MAX));
+    box.max = glm::vec3(reduceMax8(maxX, -FLT_MAX), reduceMax8(maxY, -FLT_MAX), reduceMax8(maxZ, -FLT_MAX));
+    boundsScalar(x, y, z, i, count, box);
+    return box;
+}
+
+TARGET_AVX2 void transformAvx2(const glm::mat4& m, float* x, float* y, float* z, size_t count) {
+    __m256 m00 = _mm256_set1_ps(m[0][0]), m10 = _mm256_set1_ps(m[1][0]), m20 = _mm256_set1_ps(m[2][0]), m30 = _mm256_set1_ps(m[3][0]);
+    __m256 m01 = _mm256_set1_ps(m[0][1]), m11 = _mm256_set1_ps(m[1][1]), m21 = _mm256_set1_ps(m[2][1]), m31 = _mm256_set1_ps(m[3][1]);
+    __m256 m02 = _mm256_set1_ps(m[0][2]), m12 = _mm256_set1_ps(m[1][2]), m22 = _mm256_set1_ps(m[2][2]), m32 = _mm256_set1_ps(m[3][2]);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 px = _mm256_loadu_ps(x + i), py = _mm256_loadu_ps(y + i), pz = _mm256_loadu_ps(z + i);
+        __m256 rx = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m00, px), _mm256_mul_ps(m10, py)), _mm256_add_ps(_mm256_mul_ps(m20, pz), m30));
+        __m256 ry = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m01, px), _mm256_mul_ps(m11, py)), _mm256_add_ps(_mm256_mul_ps(m21, pz), m31));
+        __m256 rz = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m02, px), _mm256_mul_ps(m12, py)), _mm256_add_ps(_mm256_mul_ps(m22, pz), m32));
+        _mm256_storeu_ps(x + i, rx);
+        _mm256_storeu_ps(y + i, ry);
+        _mm256_storeu_ps(z + i, rz);
+    }
+    transformScalar(m, x, y, z, i, count);
+}
+
+TARGET_AVX2 void normalizeAvx2(float* x, float* y, float* z, size_t count, const glm::vec3& fallback) {
+    __m256 zero = _mm256_setzero_ps(), largest = _mm256_set1_ps(FLT_MAX);
+    __m256 fx = _mm256_set1_ps(fallback.x), fy = _mm256_set1_ps(fallback.y), fz = _mm256_set1_ps(fallback.z);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 vx = _mm256_loadu_ps(x + i), vy = _mm256_loadu_ps(y + i), vz = _mm256_loadu_ps(z + i);
+        __m256 length = _mm256_sqrt_ps(
+            _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(vx, vx), _mm256_mul_ps(vy, vy)), _mm256_mul_ps(vz, vz)));
+        __m256 valid = _mm256_and_ps(_mm256_cmp_ps(length, zero, _CMP_GT_OQ), _mm256_cmp_ps(length, largest, _CMP_LE_OQ));
+        _mm256_storeu_ps(x + i, _mm256_blendv_ps(fx, _mm256_div_ps(vx, length), valid));
+        _mm256_storeu_ps(y + i, _mm256_blendv_ps(fy, _mm256_div_ps(vy, length), valid));
+        _mm256_storeu_ps(z + i, _mm256_blendv_ps(fz, _mm256_div_ps(vz, length), valid));
+    }
+    normalizeScalar(x, y, z, i, count, fallback);
+}
+
+TARGET_AVX2 void crossAvx2(const float* ax, const float* ay, const float* az, const float* bx, const float* by,
+                           const float* bz, float* outX, float* outY, float* outZ, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 vax = _mm256_loadu_ps(ax + i), vay = _mm256_loadu_ps(ay + i), vaz = _mm256_loadu_ps(az + i);
+        __m256 vbx = _mm256_loadu_ps(bx + i), vby = _mm256_loadu_ps(by + i), vbz = _mm256_loadu_ps(bz + i);
+        _mm256_storeu_ps(outX + i, _mm256_add_ps(_mm256_loadu_ps(outX + i), _mm256_sub_ps(_mm256_mul_ps(vay, vbz), _mm256_mul_ps(vby, vaz))));
+        _mm256_storeu_ps(outY + i, _mm256_add_ps(_mm256_loadu_ps(outY + i), _mm256_sub_ps(_mm256_mul_ps(vaz, vbx), _mm256_mul_ps(vbz, vax))));
+        _mm256_storeu_ps(outZ + i, _mm256_add_ps(_mm256_loadu_ps(outZ + i), _mm256_sub_ps(_mm256_mul_ps(vax, vby), _mm256_mul_ps(vbx, vay))));
+    }
+    crossScalar(ax, ay, az, bx, by, bz, outX, outY, outZ, i, count);
+}
+
+#endif // SIMD_KERNELS_X86
+
+struct KernelTable {
+    Aabb (*bounds)(const float*, const float*, const float*, size_t);
+    void (*transform)(const glm::mat4&, float*, float*, float*, size_t);
+    void (*normalize)(float*, float*, float*, size_t, const glm::vec3&);
+    void (*cross)(const float*, const float*, const float*, const float*, const float*, const float*,
+                  float*, float*, float*, size_t);
+};
+
+const KernelTable SCALAR_KERNELS = { boundsScalarAll, transformScalarAll, normalizeScalarAll, crossScalarAll };
+#ifdef SIMD_KERNELS_X86
+const KernelTable SSE2_KERNELS = { boundsSse2, transformSse2, normalizeSse2, crossSse2 };
+const KernelTable AVX2_KERNELS = { boundsAvx2, transformAvx2, normalizeAvx2, crossAvx2 };
+#endif
+
+const KernelTable& kernelsFor(SimdLevel level) {
+#ifdef SIMD_KERNELS_X86
+    if (level == SimdLevel::Avx2) return AVX2_KERNELS;
+    if (level == SimdLevel::Sse2) return SSE2_KERNELS;
+#else
+    (void)level;
+#endif
+    return SCALAR_KERNELS;
+}
+
+} // namespace
+
+Aabb simdBounds(const float* x, const float* y, const float* z, size_t count) {
+    return kernelsFor(simdLevel()).bounds(x, y, z, count);
+}
+
+void simdTransformPoints(const glm::mat4& m, float* x, float* y, float* z, size_t count) {
+    kernelsFor(simdLevel()).transform(m, x, y, z, count);
+}
+
+void simdNormalize(float* x, float* y, float* z, size_t count, const glm::vec3& fallback) {
+    kernelsFor(simdLevel()).normalize(x, y, z, count, fallback);
+}
+
+void simdAccumulateCross(const float* ax, const float* ay, const float* az,
+                         const float* bx, const float* by, const float* bz,
+                         float* outX, float* outY, float* outZ, size_t count) {
+    kernelsFor(simdLevel()).cross(ax, ay, az, bx, by, bz, outX, outY, outZ, count);
+}
@@ -0,0 +1,28 @@
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include "Bounds.h"
+#include "SimdLevel.h"
+
+// 几何批处理内核: 输入为 SoA 数组 (x, y, z 分开存放), 按 CPU 支持的指令集在运行时选择实现.
+// x86-64 上有 SSE2 (4 路) 和 AVX2 (8 路) 版本, 其他平台只有标量版本.
+// 各版本的运算顺序相同 (不使用 FMA), 结果逐位一致, 也与对应的 glm 写法一致 (NaN 的处理见各函数).
+// 交错存放的 Vertex 数组整体转成 SoA 再算并不比 glm 循环快 (受内存带宽限制);
+// 加载时簇的包围盒 (buildMeshClusters) 把每个簇的角点收集到缓存内的 SoA 数组后用 simdBounds 归约
+
+// 包围盒 (min/max 归约); NaN 坐标被忽略, count 为 0 时返回空包围盒
+Aabb simdBounds(const float* x, const float* y, const float* z, size_t count);
+
+// 就地做仿射变换 p = m * vec4(p, 1) (忽略 m 的投影行)
+void simdTransformPoints(const glm::mat4& m, float* x, float* y, float* z, size_t count);
+
+// 就地归一化; 长度为 0 或不是有限数时写入 fallback
+void simdNormalize(float* x, float* y, float* z, size_t count, const glm::vec3& fallback);
+
+// out += a x b (逐元素叉积累加, out 可以与 a, b 不同)
+void simdAccumulateCross(const float* ax, const float* ay, const float* az,
+                         const float* bx, const float* by, const float* bz,
+                         float* outX, float* outY, float* outZ, size_t count);
+#endif
@@ -0,0 +1,67 @@
+#include "SimdLevel.h"
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SIMD_LEVEL_X86 1
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+#endif
+
+namespace {
+
+#ifdef SIMD_LEVEL_X86
+bool cpuHasAvx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    // AVX2 指令 (CPUID.7.EBX[5]) 且操作系统保存 YMM 寄存器 (OSXSAVE + XCR0 的 XMM/YMM 位)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0, avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+// 第一次使用时按检测结果初始化 (静态局部变量的初始化是线程安全的)
+SimdLevel& currentLevel() {
+    static SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+} // namespace
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::Scalar: return "scalar";
+    case SimdLevel::Sse2:   return "sse2";
+    case SimdLevel::Avx2:   return "avx2";
+    }
+    return "unknown";
+}
+
+SimdLevel detectSimdLevel() {
+#ifdef SIMD_LEVEL_X86
+    static const SimdLevel detected = cpuHasAvx2() ? SimdLevel::Avx2 : SimdLevel::Sse2;
+    return detected;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+SimdLevel simdLevel() {
+    return currentLevel();
+}
+
+SimdLevel setSimdLevel(SimdLevel level) {
+    level = std::min(level, detectSimdLevel());
+    currentLevel() = level;
+    return level;
+}
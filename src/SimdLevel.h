@@ -0,0 +1,20 @@
+#ifndef SIMD_LEVEL_H
+#define SIMD_LEVEL_H
+
+// 运行时选择的 SIMD 指令集级别. x86-64 上至少为 SSE2 (基线指令集), 其他平台只有标量
+enum class SimdLevel {
+    Scalar,
+    Sse2,
+    Avx2
+};
+
+const char* simdLevelName(SimdLevel level);
+
+// CPU 支持的最高级别
+SimdLevel detectSimdLevel();
+
+// 当前使用的级别 (默认为 detectSimdLevel); setSimdLevel 超出 CPU 支持时取支持的最高级别, 返回实际级别.
+// 用于基准和对比测试, 不要在其他线程正在使用 SIMD 路径时修改
+SimdLevel simdLevel();
+SimdLevel setSimdLevel(SimdLevel level);
+#endif
@@ -0,0 +1,163 @@
+#include "SyntheticMesh.h"
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+// 追加 OBJ 文本, 数字用 to_chars / snprintf 格式化
+class ObjWriter {
+public:
+    ObjWriter(std::string& out, bool crlf) : out(out), newline(crlf ? "\r\n" : "\n") {}
+
+    void text(const char* s) { out += s; }
+    void number(float value) {
+        char temp[32];
+        int length = snprintf(temp, sizeof(temp), " %.6g", value);
+        out.append(temp, (size_t)length);
+    }
+    void index(long long value) {
+        char temp[24];
+        char* end = std::to_chars(temp, temp + sizeof(temp), value).ptr;
+        out.append(temp, end);
+    }
+    void endLine() { out += newline; }
+
+private:
+    std::string& out;
+    const char* newline;
+};
+
+} // namespace
+
+SyntheticObjInfo generateSphereObj(const SyntheticObjOptions& options, std::string& text) {
+    // slices = 2 * stacks, 三角形数 = 2 * slices * (stacks - 1)
+    size_t stacks = 2;
+    while (2 * (2 * stacks) * (stacks - 1) < options.minTriangles) ++stacks;
+    size_t slices = 2 * stacks;
+
+    SyntheticObjInfo info;
+    info.positions = 2 + (stacks - 1) * (slices + 1);
+    info.triangles = 2 * slices * (stacks - 1);
+
+    // 每个顶点约 90 字节, 每个三角形约 30 字节
+    text.clear();
+    text.reserve(info.positions * 90 + info.triangles * 30);
+    ObjWriter writer(text, options.crlf);
+    writer.text("# synthetic sphere");
+    writer.endLine();
+    if (options.groups) {
+        writer.text("mtllib synthetic.mtl");
+        writer.endLine();
+    }
+
+    // 顶点: 两极各一个, 中间每圈 slices + 1 个 (接缝处 UV 不同)
+    const float pi = 3.14159265358979f;
+    auto vertex = [&writer](float x, float y, float z, float u, float v) {
+        writer.text("v");  writer.number(x); writer.number(y); writer.number(z); writer.endLine();
+        writer.text("vt"); writer.number(u); writer.number(v); writer.endLine();
+        writer.text("vn"); writer.number(x); writer.number(y); writer.number(z); writer.endLine();
+    };
+    vertex(0.0f, 1.0f, 0.0f, 0.5f, 1.0f);
+    for (size_t i = 1; i < stacks; ++i) {
+        float phi = pi * (float)i / (float)stacks;
+        for (size_t j = 0; j <= slices; ++j) {
+            float theta = 2.0f * pi * (float)j / (float)slices;
+            vertex(std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta),
+                   (float)j / (float)slices, 1.0f - (float)i / (float)stacks);
+        }
+    }
+    vertex(0.0f, -1.0f, 0.0f, 0.5f, 0.0f);
+
+    // 面 (OBJ 索引从 1 开始, v/vt/vn 使用同一编号; 负索引相对于已写出的 info.positions 个顶点)
+    size_t faceCount = 0;
+    auto corner = [&](size_t i, ObjFaceFormat format) {
+        long long value = options.negativeIndices ? (long long)i - (long long)info.positions - 1 : (long long)i;
+        writer.text(" ");
+        writer.index(value);
+        switch (format) {
+        case ObjFaceFormat::PositionTexCoord:
+            writer.text("/"); writer.index(value);
+            break;
+        case ObjFaceFormat::PositionNormal:
+            writer.text("//"); writer.index(value);
+            break;
+        case ObjFaceFormat::PositionTexCoordNormal:
+            writer.text("/"); writer.index(value); writer.text("/"); writer.index(value);
+            break;
+        default:
+            break;
+        }
+    };
+    auto faceFormat = [&]() {
+        if (options.format != ObjFaceFormat::Mixed) return options.format;
+        return (ObjFaceFormat)(faceCount % 4);
+    };
+    auto triangle = [&](size_t a, size_t b, size_t c) {
+        ObjFaceFormat format = faceFormat();
+        writer.text("f"); corner(a, format); corner(b, format); corner(c, format); writer.endLine();
+        ++faceCount;
+    };
+    auto quad = [&](size_t a, size_t b, size_t c, size_t d) {
+        ObjFaceFormat format = faceFormat();
+        writer.text("f"); corner(a, format); corner(b, format); corner(c, format); corner(d, format); writer.endLine();
+        ++faceCount;
+    };
+    auto beginRing = [&](size_t ring) {
+        if (options.comments) {
+            writer.endLine();
+            writer.text("# ring ");
+            writer.index((long long)ring);
+            writer.endLine();
+        }
+        if (options.groups) {
+            writer.text("o ring_"); writer.index((long long)ring); writer.endLine();
+            writer.text("g ring_"); writer.index((long long)ring); writer.endLine();
+            writer.text("usemtl material_"); writer.index((long long)(ring % 4)); writer.endLine();
+            writer.text("s 1"); writer.endLine();
+        }
+    };
+
+    size_t ring = slices + 1;
+    size_t bottom = 2 + (stacks - 1) * ring;
+    beginRing(0);
+    for (size_t j = 0; j < slices; ++j) triangle(1, 2 + j + 1, 2 + j);
+    for (size_t i = 0; i + 2 < stacks; ++i) {
+        beginRing(i + 1);
+        size_t row = 2 + i * ring;
+        for (size_t j = 0; j < slices; ++j) {
+            size_t a = row + j, b = row + j + 1, c = row + ring + j, d = row + ring + j + 1;
+            if (options.quads) {
+                quad(a, b, d, c);
+            } else {
+                triangle(a, b, d);
+                triangle(a, d, c);
+            }
+        }
+    }
+    beginRing(stacks);
+    size_t lastRow = 2 + (stacks - 2) * ring;
+    for (size_t j = 0; j < slices; ++j) triangle(lastRow + j, lastRow + j + 1, bottom);
+    return info;
+}
+
+size_t writeSphereObj(const std::string& path, size_t minTriangles) {
+    SyntheticObjOptions options;
+    options.minTriangles = minTriangles;
+    std::string text;
+    SyntheticObjInfo info = generateSphereObj(options, text);
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "ERROR::SYNTHETIC::Could not write file: " << path << std::endl;
+        return 0;
+    }
+    out.write(text.data(), (std::streamsize)text.size());
+    if (!out) {
+        std::cerr << "ERROR::SYNTHETIC::Failed writing file: " << path << std::endl;
+        return 0;
+    }
+    return info.triangles;
+}
@@ -0,0 +1,38 @@
+#ifndef SYNTHETIC_MESH_H
+#define SYNTHETIC_MESH_H
+
+#include <cstddef>
+#include <string>
+
+// 面的写法
+enum class ObjFaceFormat {
+    Position,               // f 1 2 3
+    PositionTexCoord,       // f 1/1 2/2 3/3
+    PositionNormal,         // f 1//1 2//2 3//3
+    PositionTexCoordNormal, // f 1/1/1 2/2/2 3/3/3
+    Mixed                   // 逐面轮换以上四种 (缺少的属性按 0 处理, 顶点数会变多)
+};
+
+// 测试用 OBJ 的生成选项
+struct SyntheticObjOptions {
+    size_t minTriangles = 100000;
+    ObjFaceFormat format = ObjFaceFormat::PositionTexCoordNormal;
+    bool quads = false;           // 中间各圈写成四边形 (解析时扇形三角化)
+    bool negativeIndices = false; // 用相对 (负) 索引
+    bool crlf = false;            // Windows 换行
+    bool comments = false;        // 穿插注释和空行
+    bool groups = false;          // 每圈一组 o/g/usemtl
+};
+
+// 生成的网格规模, 用来校验解析结果
+struct SyntheticObjInfo {
+    size_t triangles = 0;       // 三角化之后
+    size_t positions = 0;       // 'v' 行数 (格式统一时也是去重后的顶点数)
+};
+
+// 生成经纬球的 OBJ 文本 (v/vt/vn 数量相同, 各行编号一致), 三角形数不少于 minTriangles
+SyntheticObjInfo generateSphereObj(const SyntheticObjOptions& options, std::string& text);
+
+// 按默认选项生成并写入文件; 成功时返回三角形数, 失败返回 0
+size_t writeSphereObj(const std::string& path, size_t minTriangles);
+#endif
@@ -0,0 +1,641 @@
+#include "TriangleBvh.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include "Parallel.h"
+#include "SimdLevel.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define TRIANGLE_BVH_SSE 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+const int SAH_BINS = 16;
+const uint32_t LEAF_TRIANGLES = 4;       // 不超过一个块时总是做叶子
+const uint32_t MAX_LEAF_TRIANGLES = 16;  // SAH 认为不划分更好时, 叶子最多的三角形数
+const uint32_t MAX_DEPTH = 48;           // 超过时强制做叶子, 遍历栈 (64) 不会溢出
+const float TRAVERSAL_COST = 1.0f;       // 访问一个内部节点的代价, 以一次三角形块测试为 1
+
+// 构建任务的粒度: 每个线程约 8 个子树; 再小的子树不值得单独起任务
+const uint32_t MIN_SUBTREE_TRIANGLES = 16384;
+const size_t TRIANGLE_BLOCK = 16384; // 计算三角形包围盒时每个并行任务的三角形数
+const size_t RAY_BLOCK = 1024;
+
+struct PrimRef {
+    Aabb box;
+    uint32_t triangle;
+};
+
+inline uint32_t blockCount(uint32_t triangles) { return (triangles + 3) / 4; }
+
+inline float halfArea(const Aabb& box) {
+    glm::vec3 e = box.extent();
+    return e.x * e.y + e.y * e.z + e.z * e.x;
+}
+
+inline float centroid(const PrimRef& ref, int axis) { return (ref.box.min[axis] + ref.box.max[axis]) * 0.5f; }
+
+inline int binOf(const PrimRef& ref, int axis, float minCenter, float scale) {
+    return std::min(SAH_BINS - 1, (int)((centroid(ref, axis) - minCenter) * scale));
+}
+
+// 待划分的三角形范围 refs[first, first + count); 包围盒由父节点划分时算出, 不必再扫描一遍
+struct BuildRange {
+    uint32_t first = 0, count = 0, depth = 0;
+    Aabb bounds;  // 三角形包围盒的并集
+    Aabb centers; // 三角形中心的包围盒
+};
+
+void measureRange(const PrimRef* refs, BuildRange& range) {
+    range.bounds = Aabb();
+    range.centers = Aabb();
+    for (uint32_t i = range.first; i < range.first + range.count; ++i) {
+        range.bounds.grow(refs[i].box);
+        range.centers.grow(refs[i].box.center());
+    }
+}
+
+// 按分箱 SAH 划分 range (就地重排 refs); 返回 false 表示应做叶子
+bool splitRange(PrimRef* refs, const BuildRange& range, BuildRange& left, BuildRange& right) {
+    uint32_t count = range.count;
+    if (count <= LEAF_TRIANGLES || range.depth >= MAX_DEPTH) return false;
+    left.depth = right.depth = range.depth + 1;
+    left.first = range.first;
+
+    // 三个轴各分 SAH_BINS 个箱, 一次扫描同时分三个轴
+    glm::vec3 extent = range.centers.extent();
+    glm::vec3 scale;
+    for (int axis = 0; axis < 3; ++axis) scale[axis] = extent[axis] > 0.0f ? (float)SAH_BINS * 0.9999f / extent[axis] : 0.0f;
+    Aabb binBounds[3][SAH_BINS];
+    uint32_t binCounts[3][SAH_BINS] = {};
+    const PrimRef* begin = refs + range.first;
+    for (uint32_t i = 0; i < count; ++i) {
+        const PrimRef& ref = begin[i];
+        for (int axis = 0; axis < 3; ++axis) {
+            int bin = binOf(ref, axis, range.centers.min[axis], scale[axis]);
+            binBounds[axis][bin].grow(ref.box);
+            ++binCounts[axis][bin];
+        }
+    }
+
+    float bestCost = FLT_MAX;
+    int bestAxis = -1, bestBin = 0;
+    for (int axis = 0; axis < 3; ++axis) {
+        if (!(extent[axis] > 0.0f)) continue;
+        const Aabb* bins = binBounds[axis];
+        const uint32_t* counts = binCounts[axis];
+        // 从右向左累积右半的面积, 再从左向右求代价
+        float rightArea[SAH_BINS];
+        uint32_t rightCount[SAH_BINS];
+        Aabb rightBox;
+        uint32_t rightTotal = 0;
+        for (int bin = SAH_BINS - 1; bin > 0; --bin) {
+            rightBox.grow(bins[bin]);
+            rightTotal += counts[bin];
+            rightArea[bin] = rightBox.valid() ? halfArea(rightBox) : 0.0f;
+            rightCount[bin] = rightTotal;
+        }
+        Aabb leftBox;
+        uint32_t leftTotal = 0;
+        for (int bin = 0; bin < SAH_BINS - 1; ++bin) {
+            leftBox.grow(bins[bin]);
+            leftTotal += counts[bin];
+            if (leftTotal == 0 || rightCount[bin + 1] == 0) continue;
+            float cost = halfArea(leftBox) * (float)blockCount(leftTotal) + rightArea[bin + 1] * (float)blockCount(rightCount[bin + 1]);
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestBin = bin;
+            }
+        }
+    }
+
+    if (bestAxis < 0) {
+        // 所有中心重合: 三角形多时按当前顺序对半分, 以免叶子太大
+        if (count <= MAX_LEAF_TRIANGLES) return false;
+        left.count = count / 2;
+        right.first = range.first + left.count;
+        right.count = count - left.count;
+        measureRange(refs, left);
+        measureRange(refs, right);
+        return true;
+    }
+    float area = halfArea(range.bounds);
+    float leafCost = area * (float)blockCount(count);
+    if (count <= MAX_LEAF_TRIANGLES && leafCost <= TRAVERSAL_COST * area + bestCost) return false;
+
+    // 两侧的包围盒直接由箱合并; 中心的包围盒在重排时顺便求出
+    left.bounds = Aabb();
+    right.bounds = Aabb();
+    for (int bin = 0; bin < SAH_BINS; ++bin) (bin <= bestBin ? left.bounds : right.bounds).grow(binBounds[bestAxis][bin]);
+    left.centers = Aabb();
+    right.centers = Aabb();
+    float minCenter = range.centers.min[bestAxis];
+    float axisScale = scale[bestAxis];
+    auto goesLeft = [&](const PrimRef& ref) { return binOf(ref, bestAxis, minCenter, axisScale) <= bestBin; };
+    PrimRef* lo = refs + range.first;
+    PrimRef* hi = lo + count;
+    for (;;) {
+        while (lo < hi && goesLeft(*lo)) left.centers.grow((lo++)->box.center());
+        while (lo < hi && !goesLeft(hi[-1])) right.centers.grow((--hi)->box.center());
+        if (lo >= hi) break;
+        std::swap(*lo, hi[-1]);
+    }
+    left.count = (uint32_t)(lo - (refs + range.first));
+    right.first = range.first + left.count;
+    right.count = count - left.count;
+    return true;
+}
+
+// 构建时的二叉树节点, 按深度优先顺序存放: 内部节点的左子节点紧跟在后面
+struct BinaryNode {
+    Aabb bounds;
+    uint32_t offset = 0; // 内部节点: 右子节点下标; 叶子: 第一个三角形块
+    uint32_t blocks = 0; // 叶子的三角形块数, 0 为内部节点
+};
+
+// 在一个线程内构建的子树 (节点和块的下标从 0 开始, 拼接时再加上偏移)
+struct Subtree {
+    std::vector<BinaryNode> nodes;
+    std::vector<TriangleBlock> blocks;
+    uint32_t depth = 0;
+};
+
+void appendLeaf(const PrimRef* refs, uint32_t count, const glm::vec3* positions, const uint32_t* indices,
+                std::vector<TriangleBlock>& blocks) {
+    for (uint32_t first = 0; first < count; first += 4) {
+        TriangleBlock block = {};
+        for (uint32_t lane = 0; lane < 4; ++lane) {
+            if (first + lane >= count) {
+                block.id[lane] = NO_TRIANGLE; // 边为 0 的退化三角形, 不会命中
+                continue;
+            }
+            uint32_t triangle = refs[first + lane].triangle;
+            glm::vec3 p0 = positions[indices[3 * (size_t)triangle + 0]];
+            glm::vec3 e1 = positions[indices[3 * (size_t)triangle + 1]] - p0;
+            glm::vec3 e2 = positions[indices[3 * (size_t)triangle + 2]] - p0;
+            for (int axis = 0; axis < 3; ++axis) {
+                block.v0[axis][lane] = p0[axis];
+                block.e1[axis][lane] = e1[axis];
+                block.e2[axis][lane] = e2[axis];
+            }
+            block.id[lane] = triangle;
+        }
+        blocks.push_back(block);
+    }
+}
+
+// 串行构建一个子树, 节点按深度优先顺序排列
+void buildSubtree(PrimRef* refs, const BuildRange& root, const glm::vec3* positions, const uint32_t* indices,
+                  Subtree& out) {
+    struct Task {
+        BuildRange range;
+        uint32_t parent; // 需要填入右子节点下标的父节点, 左子节点为 NO_TRIANGLE
+    };
+    std::vector<Task> stack;
+    stack.push_back({ root, NO_TRIANGLE });
+    while (!stack.empty()) {
+        Task task = stack.back();
+        stack.pop_back();
+
+        uint32_t index = (uint32_t)out.nodes.size();
+        if (task.parent != NO_TRIANGLE) out.nodes[task.parent].offset = index;
+        out.depth = std::max(out.depth, task.range.depth);
+
+        BinaryNode node;
+        node.bounds = task.range.bounds;
+        BuildRange left, right;
+        if (!splitRange(refs, task.range, left, right)) {
+            node.offset = (uint32_t)out.blocks.size();
+            node.blocks = blockCount(task.range.count);
+            appendLeaf(refs + task.range.first, task.range.count, positions, indices, out.blocks);
+            out.nodes.push_back(node);
+            continue;
+        }
+        out.nodes.push_back(node);
+        // 左子节点先出栈, 正好紧跟在父节点之后
+        stack.push_back({ right, index });
+        stack.push_back({ left, NO_TRIANGLE });
+    }
+}
+
+// 上层的划分结果: 内部节点, 或交给一个线程构建的子树
+struct TopNode {
+    Aabb bounds;
+    int left = -1, right = -1;
+    int subtree = -1;
+};
+
+int splitTop(PrimRef* refs, const BuildRange& range, uint32_t grain, std::vector<TopNode>& top,
+             std::vector<BuildRange>& tasks) {
+    int index = (int)top.size();
+    top.emplace_back();
+    top[index].bounds = range.bounds;
+    BuildRange left, right;
+    if (range.count <= grain || !splitRange(refs, range, left, right)) {
+        top[index].subtree = (int)tasks.size();
+        tasks.push_back(range);
+        return index;
+    }
+    int leftIndex = splitTop(refs, left, grain, top, tasks);
+    int rightIndex = splitTop(refs, right, grain, top, tasks);
+    top[index].left = leftIndex;
+    top[index].right = rightIndex;
+    return index;
+}
+
+// 按深度优先顺序输出上层节点, 子树整体拷入并加上偏移
+void emitTop(const std::vector<TopNode>& top, int index, std::vector<Subtree>& subtrees,
+             std::vector<BinaryNode>& nodes, std::vector<TriangleBlock>& blocks) {
+    const TopNode& topNode = top[index];
+    if (topNode.subtree >= 0) {
+        Subtree& subtree = subtrees[topNode.subtree];
+        uint32_t nodeBase = (uint32_t)nodes.size();
+        uint32_t blockBase = (uint32_t)blocks.size();
+        for (BinaryNode node : subtree.nodes) {
+            node.offset += node.blocks == 0 ? nodeBase : blockBase;
+            nodes.push_back(node);
+        }
+        blocks.insert(blocks.end(), subtree.blocks.begin(), subtree.blocks.end());
+        std::vector<BinaryNode>().swap(subtree.nodes);
+        std::vector<TriangleBlock>().swap(subtree.blocks);
+        return;
+    }
+    uint32_t nodeIndex = (uint32_t)nodes.size();
+    BinaryNode node;
+    node.bounds = topNode.bounds;
+    nodes.push_back(node);
+    emitTop(top, topNode.left, subtrees, nodes, blocks);
+    nodes[nodeIndex].offset = (uint32_t)nodes.size();
+    emitTop(top, topNode.right, subtrees, nodes, blocks);
+}
+
+// 二叉树合并成 4 叉树: 每个 4 叉节点从二叉节点的两个子节点出发, 反复展开表面积最大的内部子节点, 直到凑满 4 个.
+// 返回 4 叉节点下标
+uint32_t collapse(const std::vector<BinaryNode>& binary, uint32_t index, std::vector<TriangleBvhNode>& nodes) {
+    uint32_t slots[4];
+    int slotCount = 0;
+    if (binary[index].blocks == 0) {
+        slots[slotCount++] = index + 1;
+        slots[slotCount++] = binary[index].offset;
+    } else {
+        slots[slotCount++] = index; // 根节点本身就是叶子
+    }
+    while (slotCount < 4) {
+        int widest = -1;
+        float widestArea = -1.0f;
+        for (int i = 0; i < slotCount; ++i) {
+            const BinaryNode& node = binary[slots[i]];
+            if (node.blocks == 0 && halfArea(node.bounds) > widestArea) {
+                widest = i;
+                widestArea = halfArea(node.bounds);
+            }
+        }
+        if (widest < 0) break;
+        uint32_t expanded = slots[widest];
+        slots[widest] = expanded + 1;
+        slots[slotCount++] = binary[expanded].offset;
+    }
+
+    uint32_t nodeIndex = (uint32_t)nodes.size();
+    TriangleBvhNode wide;
+    for (int i = 0; i < 4; ++i) {
+        for (int axis = 0; axis < 3; ++axis) {
+            wide.bounds[axis][i] = i < slotCount ? binary[slots[i]].bounds.min[axis] : INFINITY;
+            wide.bounds[axis + 3][i] = i < slotCount ? binary[slots[i]].bounds.max[axis] : -INFINITY;
+        }
+        wide.child[i] = 0;
+        wide.blocks[i] = 0;
+    }
+    nodes.push_back(wide);
+    // 子节点的下标在递归之后才知道, 不能持有 nodes 中元素的引用
+    for (int i = 0; i < slotCount; ++i) {
+        const BinaryNode& node = binary[slots[i]];
+        uint32_t child = node.blocks == 0 ? collapse(binary, slots[i], nodes) : node.offset;
+        nodes[nodeIndex].child[i] = child;
+        nodes[nodeIndex].blocks[i] = node.blocks;
+    }
+    return nodeIndex;
+}
+
+// 射线的预计算: 每个轴按方向的正负选近/远平面, 省去 min/max
+struct TraversalRay {
+    glm::vec3 origin;
+    glm::vec3 invDirection;
+    int nearPlane[3], farPlane[3];
+
+    explicit TraversalRay(const Ray& ray) : origin(ray.origin), invDirection(1.0f / ray.direction) {
+        for (int axis = 0; axis < 3; ++axis) {
+            bool negative = invDirection[axis] < 0.0f;
+            nearPlane[axis] = negative ? axis + 3 : axis;
+            farPlane[axis] = negative ? axis : axis + 3;
+        }
+    }
+};
+
+// 4 个子节点的包围盒: 返回命中的位掩码, tNear 为各自的进入距离.
+// 空槽的近平面在 +inf, 远平面在 -inf, 总是不命中; 0 * inf 得到的 NaN 不限制区间
+int hitBoxesScalar(const TriangleBvhNode& node, const TraversalRay& ray, float tMax, float tNear[4]) {
+    int mask = 0;
+    for (int i = 0; i < 4; ++i) {
+        float enter = 0.0f, exit = tMax;
+        for (int axis = 0; axis < 3; ++axis) {
+            float t0 = (node.bounds[ray.nearPlane[axis]][i] - ray.origin[axis]) * ray.invDirection[axis];
+            float t1 = (node.bounds[ray.farPlane[axis]][i] - ray.origin[axis]) * ray.invDirection[axis];
+            enter = t0 > enter ? t0 : enter;
+            exit = t1 < exit ? t1 : exit;
+        }
+        tNear[i] = enter;
+        if (enter <= exit) mask |= 1 << i;
+    }
+    return mask;
+}
+
+// 一个块的 4 个三角形: 比 best 更近的命中更新 best 和 lane, 返回是否更新
+bool hitBlockScalar(const TriangleBlock& block, const Ray& ray, float& best, int& lane) {
+    bool found = false;
+    for (int i = 0; i < 4; ++i) {
+        glm::vec3 e1(block.e1[0][i], block.e1[1][i], block.e1[2][i]);
+        glm::vec3 e2(block.e2[0][i], block.e2[1][i], block.e2[2][i]);
+        glm::vec3 p = glm::cross(ray.direction, e2);
+        float det = glm::dot(e1, p);
+        if (det == 0.0f) continue;
+        float inv = 1.0f / det;
+        glm::vec3 s = ray.origin - glm::vec3(block.v0[0][i], block.v0[1][i], block.v0[2][i]);
+        float u = glm::dot(s, p) * inv;
+        glm::vec3 q = glm::cross(s, e1);
+        float v = glm::dot(ray.direction, q) * inv;
+        float t = glm::dot(e2, q) * inv;
+        if (u >= 0.0f && v >= 0.0f && u + v <= 1.0f && t > 0.0f && t < best) {
+            best = t;
+            lane = i;
+            found = true;
+        }
+    }
+    return found;
+}
+
+#ifdef TRIANGLE_BVH_SSE
+// 射线各分量广播到 4 路
+struct SseRay {
+    __m128 ox, oy, oz, dx, dy, dz;
+    __m128 ix, iy, iz;
+
+    explicit SseRay(const TraversalRay& traversal, const Ray& ray)
+        : ox(_mm_set1_ps(ray.origin.x)), oy(_mm_set1_ps(ray.origin.y)), oz(_mm_set1_ps(ray.origin.z)),
+          dx(_mm_set1_ps(ray.direction.x)), dy(_mm_set1_ps(ray.direction.y)), dz(_mm_set1_ps(ray.direction.z)),
+          ix(_mm_set1_ps(traversal.invDirection.x)), iy(_mm_set1_ps(traversal.invDirection.y)),
+          iz(_mm_set1_ps(traversal.invDirection.z)) {}
+};
+
+// 与 hitBoxesScalar 相同; _mm_max_ps / _mm_min_ps 在第一个参数为 NaN 时返回第二个参数
+int hitBoxesSse(const TriangleBvhNode& node, const TraversalRay& ray, const SseRay& sse, float tMax, float tNear[4]) {
+    __m128 enter = _mm_setzero_ps();
+    __m128 exit = _mm_set1_ps(tMax);
+    enter = _mm_max_ps(_mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.bounds[ray.nearPlane[0]]), sse.ox), sse.ix), enter);
+    enter = _mm_max_ps(_mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.bounds[ray.nearPlane[1]]), sse.oy), sse.iy), enter);
+    enter = _mm_max_ps(_mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.bounds[ray.nearPlane[2]]), sse.oz), sse.iz), enter);
+    exit = _mm_min_ps(_mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.bounds[ray.farPlane[0]]), sse.ox), sse.ix), exit);
+    exit = _mm_min_ps(_mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.bounds[ray.farPlane[1]]), sse.oy), sse.iy), exit);
+    exit = _mm_min_ps(_mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.bounds[ray.farPlane[2]]), sse.oz), sse.iz), exit);
+    _mm_storeu_ps(tNear, enter);
+    return _mm_movemask_ps(_mm_cmple_ps(enter, exit));
+}
+
+// 与 hitBlockScalar 相同的运算, 4 个三角形同时做
+bool hitBlockSse(const TriangleBlock& block, const SseRay& ray, float& best, int& lane) {
+    __m128 e1x = _mm_load_ps(block.e1[0]), e1y = _mm_load_ps(block.e1[1]), e1z = _mm_load_ps(block.e1[2]);
+    __m128 e2x = _mm_load_ps(block.e2[0]), e2y = _mm_load_ps(block.e2[1]), e2z = _mm_load_ps(block.e2[2]);
+
+    __m128 px = _mm_sub_ps(_mm_mul_ps(ray.dy, e2z), _mm_mul_ps(ray.dz, e2y));
+    __m128 py = _mm_sub_ps(_mm_mul_ps(ray.dz, e2x), _mm_mul_ps(ray.dx, e2z));
+    __m128 pz = _mm_sub_ps(_mm_mul_ps(ray.dx, e2y), _mm_mul_ps(ray.dy, e2x));
+    __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+    __m128 inv = _mm_div_ps(_mm_set1_ps(1.0f), det);
+
+    __m128 sx = _mm_sub_ps(ray.ox, _mm_load_ps(block.v0[0]));
+    __m128 sy = _mm_sub_ps(ray.oy, _mm_load_ps(block.v0[1]));
+    __m128 sz = _mm_sub_ps(ray.oz, _mm_load_ps(block.v0[2]));
+    __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), inv);
+
+    __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+    __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+    __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+    __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(ray.dx, qx), _mm_mul_ps(ray.dy, qy)), _mm_mul_ps(ray.dz, qz)), inv);
+    __m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), inv);
+
+    __m128 zero = _mm_setzero_ps();
+    __m128 mask = _mm_cmpneq_ps(det, zero);
+    mask = _mm_and_ps(mask, _mm_cmpge_ps(u, zero));
+    mask = _mm_and_ps(mask, _mm_cmpge_ps(v, zero));
+    mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.0f)));
+    mask = _mm_and_ps(mask, _mm_cmpgt_ps(t, zero));
+    mask = _mm_and_ps(mask, _mm_cmplt_ps(t, _mm_set1_ps(best)));
+    int bits = _mm_movemask_ps(mask);
+    if (bits == 0) return false;
+
+    alignas(16) float ts[4];
+    _mm_store_ps(ts, t);
+    for (int i = 0; i < 4; ++i) {
+        if ((bits & (1 << i)) && ts[i] < best) {
+            best = ts[i];
+            lane = i;
+        }
+    }
+    return true;
+}
+#endif
+
+template <bool UseSse>
+RayHit traverse(const std::vector<TriangleBvhNode>& nodes, const std::vector<TriangleBlock>& blocks, const Ray& ray) {
+    RayHit hit;
+    if (nodes.empty()) return hit;
+    TraversalRay traversal(ray);
+#ifdef TRIANGLE_BVH_SSE
+    SseRay sseRay(traversal, ray);
+#endif
+
+    // 栈中是已经命中包围盒的子节点 (内部节点或叶子); 每层最多压入 3 个, 深度不超过 MAX_DEPTH
+    struct Entry {
+        uint32_t child;
+        uint32_t blocks;
+        float tNear;
+    };
+    Entry stack[3 * MAX_DEPTH + 4];
+    int top = 0;
+    stack[top++] = { 0, 0, 0.0f };
+    float best = ray.tMax;
+    uint32_t bestBlock = 0;
+    int bestLane = -1;
+
+    while (top > 0) {
+        Entry entry = stack[--top];
+        if (entry.tNear > best) continue; // 进入距离已经比最近的命中还远
+
+        if (entry.blocks > 0) {
+            for (uint32_t b = entry.child; b < entry.child + entry.blocks; ++b) {
+                int lane = 0;
+#ifdef TRIANGLE_BVH_SSE
+                bool found = UseSse ? hitBlockSse(blocks[b], sseRay, best, lane) : hitBlockScalar(blocks[b], ray, best, lane);
+#else
+                bool found = hitBlockScalar(blocks[b], ray, best, lane);
+#endif
+                if (found) {
+                    bestBlock = b;
+                    bestLane = lane;
+                }
+            }
+            continue;
+        }
+
+        const TriangleBvhNode& node = nodes[entry.child];
+        alignas(16) float tNear[4];
+#ifdef TRIANGLE_BVH_SSE
+        int mask = UseSse ? hitBoxesSse(node, traversal, sseRay, best, tNear) : hitBoxesScalar(node, traversal, best, tNear);
+#else
+        int mask = hitBoxesScalar(node, traversal, best, tNear);
+#endif
+        // 按进入距离从远到近压栈, 最近的先出栈 (插入排序, 最多 4 个)
+        int first = top;
+        for (int i = 0; i < 4; ++i) {
+            if (!(mask & (1 << i))) continue;
+            Entry child = { node.child[i], node.blocks[i], tNear[i] };
+            int j = top++;
+            while (j > first && stack[j - 1].tNear < child.tNear) {
+                stack[j] = stack[j - 1];
+                --j;
+            }
+            stack[j] = child;
+        }
+    }
+
+    if (bestLane < 0) return hit;
+    const TriangleBlock& block = blocks[bestBlock];
+    glm::vec3 e1(block.e1[0][bestLane], block.e1[1][bestLane], block.e1[2][bestLane]);
+    glm::vec3 e2(block.e2[0][bestLane], block.e2[1][bestLane], block.e2[2][bestLane]);
+    glm::vec3 normal = glm::normalize(glm::cross(e1, e2));
+    hit.hit = true;
+    hit.t = best;
+    hit.position = ray.origin + ray.direction * best;
+    hit.normal = glm::dot(normal, ray.direction) > 0.0f ? -normal : normal;
+    hit.triangle = block.id[bestLane];
+    return hit;
+}
+
+} // namespace
+
+TriangleBvhStats TriangleBvh::build(const glm::vec3* positions, const uint32_t* indices, size_t triangleCount,
+                                    unsigned int threads) {
+    auto startTime = std::chrono::steady_clock::now();
+    clear();
+    TriangleBvhStats stats;
+    unsigned int workers = resolveThreadCount(threads);
+
+    // 1. 每个三角形的包围盒; 坐标不是有限数的三角形不参与 (不会被命中)
+    std::vector<PrimRef> refs(triangleCount);
+    parallelFor((triangleCount + TRIANGLE_BLOCK - 1) / TRIANGLE_BLOCK, workers, [&](size_t block) {
+        size_t end = std::min(triangleCount, (block + 1) * TRIANGLE_BLOCK);
+        for (size_t t = block * TRIANGLE_BLOCK; t < end; ++t) {
+            PrimRef& ref = refs[t];
+            ref.triangle = (uint32_t)t;
+            for (int corner = 0; corner < 3; ++corner) {
+                const glm::vec3& p = positions[indices[3 * t + corner]];
+                if (!std::isfinite(p.x) || !std::isfinite(p.y) || !std::isfinite(p.z)) ref.triangle = NO_TRIANGLE;
+                ref.box.grow(p);
+            }
+        }
+    });
+    refs.erase(std::remove_if(refs.begin(), refs.end(), [](const PrimRef& ref) { return ref.triangle == NO_TRIANGLE; }),
+               refs.end());
+    stats.triangles = refs.size();
+    if (refs.empty()) {
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        return stats;
+    }
+
+    // 2. 上层串行划分到每个线程约 8 个子树, 3. 子树并行构建, 4. 按深度优先顺序拼接
+    BuildRange root;
+    root.count = (uint32_t)refs.size();
+    measureRange(refs.data(), root);
+    uint32_t grain = workers <= 1 ? root.count : std::max(MIN_SUBTREE_TRIANGLES, root.count / (workers * 8));
+    std::vector<TopNode> top;
+    std::vector<BuildRange> tasks;
+    splitTop(refs.data(), root, grain, top, tasks);
+
+    std::vector<Subtree> subtrees(tasks.size());
+    // 大的子树先领取, 线程结束的时间更接近
+    std::vector<uint32_t> order(tasks.size());
+    for (uint32_t i = 0; i < (uint32_t)order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return tasks[a].count > tasks[b].count; });
+    parallelFor(tasks.size(), workers, [&](size_t i) {
+        const BuildRange& task = tasks[order[i]];
+        Subtree& subtree = subtrees[order[i]];
+        subtree.nodes.reserve((size_t)task.count / 2 + 1);
+        subtree.blocks.reserve((size_t)blockCount(task.count) + task.count / 8);
+        buildSubtree(refs.data(), task, positions, indices, subtree);
+    });
+
+    size_t nodeTotal = 0, blockTotal = 0;
+    for (const Subtree& subtree : subtrees) {
+        nodeTotal += subtree.nodes.size();
+        blockTotal += subtree.blocks.size();
+        stats.depth = std::max(stats.depth, subtree.depth);
+    }
+    std::vector<BinaryNode> binary;
+    binary.reserve(nodeTotal + top.size());
+    blocks.reserve(blockTotal);
+    emitTop(top, 0, subtrees, binary, blocks);
+
+    // 统计: SAH 代价按表面积比 (进入节点的概率) 加权
+    float rootArea = std::max(halfArea(binary[0].bounds), FLT_MIN);
+    for (const BinaryNode& node : binary) {
+        float probability = halfArea(node.bounds) / rootArea;
+        if (node.blocks == 0) {
+            stats.sahCost += TRAVERSAL_COST * probability;
+        } else {
+            stats.sahCost += (double)node.blocks * probability;
+            ++stats.leaves;
+        }
+    }
+
+    // 5. 合并成 4 叉树 (内部节点数约为二叉树的三分之一)
+    nodes.reserve(binary.size() / 4 + 1);
+    collapse(binary, 0, nodes);
+    nodes.shrink_to_fit();
+    stats.nodes = nodes.size();
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return stats;
+}
+
+void TriangleBvh::clear() {
+    std::vector<TriangleBvhNode>().swap(nodes);
+    std::vector<TriangleBlock>().swap(blocks);
+}
+
+size_t TriangleBvh::memoryBytes() const {
+    return nodes.capacity() * sizeof(TriangleBvhNode) + blocks.capacity() * sizeof(TriangleBlock);
+}
+
+RayHit TriangleBvh::intersect(const Ray& ray) const {
+#ifdef TRIANGLE_BVH_SSE
+    if (simdLevel() >= SimdLevel::Sse2) return traverse<true>(nodes, blocks, ray);
+#endif
+    return traverse<false>(nodes, blocks, ray);
+}
+
+size_t TriangleBvh::intersect(const Ray* rays, RayHit* hits, size_t count, unsigned int threads) const {
+    std::atomic<size_t> hitCount(0);
+    parallelFor((count + RAY_BLOCK - 1) / RAY_BLOCK, resolveThreadCount(threads), [&](size_t block) {
+        size_t end = std::min(count, (block + 1) * RAY_BLOCK);
+        size_t blockHits = 0;
+        for (size_t i = block * RAY_BLOCK; i < end; ++i) {
+            hits[i] = intersect(rays[i]);
+            if (hits[i].hit) ++blockHits;
+        }
+        hitCount += blockHits;
+    });
+    return hitCount;
+}
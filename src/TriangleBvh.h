@@ -0,0 +1,78 @@
+#ifndef TRIANGLE_BVH_H
+#define TRIANGLE_BVH_H
+
+#include <glm/glm.hpp>
+#include <cfloat>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Bounds.h"
+
+const uint32_t NO_TRIANGLE = 0xFFFFFFFFu;
+
+// 射线 (direction 不必是单位长度, t 以 direction 的长度为单位)
+struct Ray {
+    glm::vec3 origin = glm::vec3(0.0f);
+    glm::vec3 direction = glm::vec3(0.0f, 0.0f, -1.0f);
+    float tMax = FLT_MAX;
+};
+
+// 射线命中的三角形; 法线为几何法线 (单位长度, 翻转到朝向射线来的一侧)
+struct RayHit {
+    bool hit = false;
+    float t = FLT_MAX;
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::vec3 normal = glm::vec3(0.0f);
+    uint32_t triangle = NO_TRIANGLE; // 构建时的三角形编号 (索引 3 * triangle 起的三个角点)
+};
+
+// 4 叉节点, 128 字节 (两条缓存行), 按深度优先顺序存放; 4 个子节点的包围盒按 SoA 存放, 一次 SSE 测试 4 个.
+// 不足 4 个子节点时空槽的包围盒为空 (min = +inf, max = -inf), 不会被命中
+struct alignas(64) TriangleBvhNode {
+    float bounds[6][4];  // minX, minY, minZ, maxX, maxY, maxZ
+    uint32_t child[4];   // 内部子节点: 节点下标; 叶子: 第一个三角形块
+    uint32_t blocks[4];  // 叶子的三角形块数, 0 为内部子节点
+};
+
+// 4 个三角形一组 (SoA), 射线测试一次处理一组; 不满 4 个时用退化三角形补齐 (id 为 NO_TRIANGLE)
+struct alignas(16) TriangleBlock {
+    float v0[3][4];
+    float e1[3][4]; // v1 - v0
+    float e2[3][4]; // v2 - v0
+    uint32_t id[4];
+};
+
+struct TriangleBvhStats {
+    size_t triangles = 0;
+    size_t nodes = 0;     // 4 叉节点数
+    size_t leaves = 0;
+    uint32_t depth = 0;   // 二叉树的深度
+    double sahCost = 0.0; // 二叉树每条射线的期望代价 (以一次三角形块测试为 1)
+    double seconds = 0.0;
+};
+
+// 三角形 BVH, 用于 CPU 端的射线拾取和测量
+// 构建: 分箱 SAH (每轴 16 个箱) 的二叉树, 上层串行划分, 下层子树多线程构建后拼接, 最后合并成 4 叉树
+// 遍历: 命中的子节点按进入距离由近到远访问, 节点的 4 个包围盒和叶子中的 4 个三角形各用一次 SSE 测试
+// (三角形用 Möller-Trumbore, 双面)
+// 三角形数据拷贝在块中 (每个三角形 40 字节), 不依赖网格保留的几何
+class TriangleBvh {
+public:
+    std::vector<TriangleBvhNode> nodes;
+    std::vector<TriangleBlock> blocks;
+
+    // indices 为 triangleCount 个三角形的角点; threads 为 0 时使用全部硬件线程
+    TriangleBvhStats build(const glm::vec3* positions, const uint32_t* indices, size_t triangleCount,
+                           unsigned int threads = 0);
+
+    void clear();
+    bool empty() const { return nodes.empty(); }
+    size_t memoryBytes() const;
+
+    // 最近的命中 (ray.tMax 之内)
+    RayHit intersect(const Ray& ray) const;
+
+    // 一批射线, 多线程; 返回命中数
+    size_t intersect(const Ray* rays, RayHit* hits, size_t count, unsigned int threads = 0) const;
+};
+#endif
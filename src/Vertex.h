@@ -0,0 +1,12 @@
+#ifndef VERTEX_H
+#define VERTEX_H
+
+#include <glm/glm.hpp>
+
+// 顶点数据 (与 Mesh::setupMesh 上传到 VBO 的布局一致)
+struct Vertex {
+    glm::vec3 Position;
+    glm::vec3 Normal;
+    glm::vec2 TexCoords;
+};
+#endif
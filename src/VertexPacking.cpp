@@ -0,0 +1,177 @@
+#include "VertexPacking.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+inline float signNotZero(float v) {
+    return v >= 0.0f ? 1.0f : -1.0f;
+}
+
+inline int16_t toSnorm16(float v) {
+    return (int16_t)std::lround(std::min(std::max(v, -1.0f), 1.0f) * 32767.0f);
+}
+
+inline float fromSnorm16(int16_t v) {
+    return std::max((float)v / 32767.0f, -1.0f);
+}
+
+inline float angleDegrees(const glm::vec3& a, const glm::vec3& b) {
+    float c = glm::dot(a, b) / (glm::length(a) * glm::length(b));
+    return glm::degrees(std::acos(std::min(std::max(c, -1.0f), 1.0f)));
+}
+
+// 八面体编码后量化到 snorm16: 在相邻的 4 个量化点里选误差最小的
+void encodeNormal(const glm::vec3& normal, int16_t out[2]) {
+    glm::vec2 e = octEncode(normal);
+    float fx = std::floor(std::min(std::max(e.x, -1.0f), 1.0f) * 32767.0f);
+    float fy = std::floor(std::min(std::max(e.y, -1.0f), 1.0f) * 32767.0f);
+
+    float bestError = -2.0f;
+    for (int i = 0; i < 4; ++i) {
+        int16_t qx = (int16_t)std::min(fx + (float)(i & 1), 32767.0f);
+        int16_t qy = (int16_t)std::min(fy + (float)(i >> 1), 32767.0f);
+        glm::vec3 decoded = octDecode(glm::vec2(fromSnorm16(qx), fromSnorm16(qy)));
+        float similarity = glm::dot(decoded, normal);
+        if (similarity > bestError) {
+            bestError = similarity;
+            out[0] = qx;
+            out[1] = qy;
+        }
+    }
+}
+
+} // namespace
+
+uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    uint32_t absBits = bits & 0x7FFFFFFFu;
+
+    if (absBits >= 0x7F800000u) { // Inf / NaN
+        return (uint16_t)(sign | 0x7C00u | (absBits > 0x7F800000u ? 0x200u : 0u));
+    }
+    if (absBits >= 0x477FF000u) { // 舍入后超出 half 范围
+        return (uint16_t)(sign | 0x7C00u);
+    }
+    if (absBits < 0x38800000u) { // half 的非规格化数
+        float absValue;
+        memcpy(&absValue, &absBits, sizeof(absValue));
+        uint32_t mantissa = (uint32_t)std::nearbyint(absValue * 16777216.0f); // * 2^24
+        return (uint16_t)(sign | mantissa);
+    }
+
+    uint32_t exponent = (absBits >> 23) - 127 + 15;
+    uint32_t mantissa = absBits & 0x7FFFFFu;
+    uint32_t half = (exponent << 10) | (mantissa >> 13);
+    uint32_t rest = mantissa & 0x1FFFu;
+    if (rest > 0x1000u || (rest == 0x1000u && (half & 1u))) ++half; // 进位可以直接进到指数
+    return (uint16_t)(sign | half);
+}
+
+float halfToFloat(uint16_t value) {
+    uint32_t sign = (uint32_t)(value & 0x8000u) << 16;
+    uint32_t exponent = (value >> 10) & 0x1Fu;
+    uint32_t mantissa = value & 0x3FFu;
+
+    float result;
+    if (exponent == 0) {
+        result = (float)mantissa / 16777216.0f;
+        return sign ? -result : result;
+    }
+    uint32_t bits = (exponent == 31)
+        ? (sign | 0x7F800000u | (mantissa << 13))
+        : (sign | ((exponent - 15 + 127) << 23) | (mantissa << 13));
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+glm::vec2 octEncode(const glm::vec3& normal) {
+    float l1 = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+    if (l1 == 0.0f) return glm::vec2(0.0f, 0.0f);
+
+    glm::vec2 p(normal.x / l1, normal.y / l1);
+    if (normal.z < 0.0f) {
+        p = glm::vec2((1.0f - std::fabs(p.y)) * signNotZero(p.x),
+                      (1.0f - std::fabs(p.x)) * signNotZero(p.y));
+    }
+    return p;
+}
+
+glm::vec3 octDecode(const glm::vec2& e) {
+    glm::vec3 v(e.x, e.y, 1.0f - std::fabs(e.x) - std::fabs(e.y));
+    if (v.z < 0.0f) {
+        float x = (1.0f - std::fabs(v.y)) * signNotZero(v.x);
+        float y = (1.0f - std::fabs(v.x)) * signNotZero(v.y);
+        v.x = x;
+        v.y = y;
+    }
+    return glm::normalize(v);
+}
+
+Vertex unpackVertex(const PackedVertex& packed, const glm::vec3& offset, const glm::vec3& scale) {
+    Vertex v;
+    for (int axis = 0; axis < 3; ++axis) {
+        v.Position[axis] = offset[axis] + (float)packed.Position[axis] / 65535.0f * scale[axis];
+    }
+    if (packed.Normal[0] != 0 || packed.Normal[1] != 0) {
+        v.Normal = octDecode(glm::vec2(fromSnorm16(packed.Normal[0]), fromSnorm16(packed.Normal[1])));
+    } else {
+        v.Normal = glm::vec3(0.0f);
+    }
+    v.TexCoords = glm::vec2(halfToFloat(packed.TexCoords[0]), halfToFloat(packed.TexCoords[1]));
+    return v;
+}
+
+QuantizationInfo packVertices(const std::vector<Vertex>& vertices, std::vector<PackedVertex>& packed) {
+    QuantizationInfo info;
+    packed.resize(vertices.size());
+    if (vertices.empty()) return info;
+
+    // 包围盒
+    glm::vec3 minPos = vertices[0].Position;
+    glm::vec3 maxPos = vertices[0].Position;
+    for (const Vertex& v : vertices) {
+        minPos = glm::min(minPos, v.Position);
+        maxPos = glm::max(maxPos, v.Position);
+    }
+    glm::vec3 extent = maxPos - minPos;
+    info.offset = minPos;
+    info.scale = extent;
+    info.positionErrorBound = 0.5f * glm::length(extent) / 65535.0f;
+
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        const Vertex& v = vertices[i];
+        PackedVertex& out = packed[i];
+
+        // 位置: 包围盒内 16 位量化
+        glm::vec3 decoded;
+        for (int axis = 0; axis < 3; ++axis) {
+            float t = extent[axis] > 0.0f ? (v.Position[axis] - minPos[axis]) / extent[axis] : 0.0f;
+            out.Position[axis] = (uint16_t)std::lround(std::min(std::max(t, 0.0f), 1.0f) * 65535.0f);
+            decoded[axis] = minPos[axis] + (float)out.Position[axis] / 65535.0f * extent[axis];
+        }
+        out.Position[3] = 0;
+        info.maxPositionError = std::max(info.maxPositionError, glm::length(decoded - v.Position));
+
+        // 法线: 八面体编码 (零法线编码为 (0, 0), 仅在没有法线的模型中出现)
+        if (glm::dot(v.Normal, v.Normal) > 0.0f) {
+            encodeNormal(v.Normal, out.Normal);
+            glm::vec3 n = octDecode(glm::vec2(fromSnorm16(out.Normal[0]), fromSnorm16(out.Normal[1])));
+            info.maxNormalErrorDegrees = std::max(info.maxNormalErrorDegrees, angleDegrees(n, v.Normal));
+        } else {
+            out.Normal[0] = 0;
+            out.Normal[1] = 0;
+        }
+
+        // UV: half float
+        for (int c = 0; c < 2; ++c) {
+            out.TexCoords[c] = floatToHalf(v.TexCoords[c]);
+            info.maxTexCoordError = std::max(info.maxTexCoordError,
+                                             std::fabs(halfToFloat(out.TexCoords[c]) - v.TexCoords[c]));
+        }
+    }
+    return info;
+}
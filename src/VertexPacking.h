@@ -0,0 +1,42 @@
+#ifndef VERTEX_PACKING_H
+#define VERTEX_PACKING_H
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+#include "Vertex.h"
+
+// 压缩顶点 (16 字节, 原 Vertex 为 32 字节)
+//   Position : 3 x unorm16, 在包围盒内量化, 第 4 个分量仅用于对齐
+//   Normal   : 2 x snorm16, 八面体 (octahedral) 编码
+//   TexCoords: 2 x half float
+struct PackedVertex {
+    uint16_t Position[4];
+    int16_t Normal[2];
+    uint16_t TexCoords[2];
+};
+
+// 反量化参数与实际误差
+struct QuantizationInfo {
+    glm::vec3 offset = glm::vec3(0.0f);  // 位置 = offset + unorm * scale
+    glm::vec3 scale = glm::vec3(1.0f);
+    float positionErrorBound = 0.0f;    // 理论上界 (欧氏距离): 每个轴的误差不超过该轴步长 (scale / 65535) 的一半, 合起来为 0.5 * |scale| / 65535
+    float maxPositionError = 0.0f;      // 实测最大误差 (欧氏距离)
+    float maxNormalErrorDegrees = 0.0f; // 实测最大法线夹角误差
+    float maxTexCoordError = 0.0f;      // 实测最大 UV 误差
+};
+
+// 把顶点压缩成 PackedVertex, 返回反量化参数和误差统计
+QuantizationInfo packVertices(const std::vector<Vertex>& vertices, std::vector<PackedVertex>& packed);
+
+// 解压一个顶点 (与着色器中的反量化一致)
+Vertex unpackVertex(const PackedVertex& packed, const glm::vec3& offset, const glm::vec3& scale);
+
+// half float 转换 (就近舍入到偶数)
+uint16_t floatToHalf(float value);
+float halfToFloat(uint16_t value);
+
+// 八面体法线编码/解码 ([-1, 1] 范围)
+glm::vec2 octEncode(const glm::vec3& normal);
+glm::vec3 octDecode(const glm::vec2& encoded);
+#endif
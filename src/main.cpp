@@ -1,11 +1,24 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <iostream>
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <memory>
 
 // 包含我们自己的类
 #include "Shader.h"
 #include "Mesh.h"
+#include "Scene.h"
+#include "FrameUniforms.h"
+#include "Benchmark.h"
+#include "Profiler.h"
+#include "FileWatcher.h"
+#include "PageStreamer.h"
 
 // 包含 GLM
 #include <glm/glm.hpp>
@@ -30,6 +43,10 @@ glm::vec3 lightColor = glm::vec3(1.0f, 1.0f, 1.0f);     // 光源颜色
 bool isHeadLightMode = true; // true = 头灯模式, false = 固定光线模式
 bool isHeadLightModePressed = false; // 用于按键防抖
 
+// 着色模式 (选择着色器版本, 见 ShaderFeature)
+bool isFlatShading = false;
+bool isWireframe = false;
+
 // 自由视角
 glm::vec3 cameraPos   = glm::vec3(0.0f, 0.0f, 3.0f);    // 摄像机位置
 glm::vec3 cameraFront = glm::vec3(0.0f, 0.0f, -1.0f);   // 摄像机正前方
@@ -54,6 +71,11 @@ bool firstMouse = true;
 glm::vec3 modelPosition = glm::vec3(0.0f, 0.0f, 0.0f);
 glm::vec3 modelRotation = glm::vec3(0.0f, 0.0f, 0.0f); 
 glm::vec3 modelScale    = glm::vec3(1.0f, 1.0f, 1.0f);
+bool autoFit = true; // 加载新模型后按包围盒把模型移到原点并缩放到视野内 (相机看向原点)
+
+// 场景: 网格阵列
+int gridSize = 10;          // 每边的副本数
+float gridSpacing = 3.0f;   // 副本间距
 
 
 // 帧时间
@@ -68,14 +90,143 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 
 // 重新读取防抖
 bool isReloadPressed = false;
-int main()
+
+// 拾取 (鼠标左键): 按住 Alt 释放鼠标时取光标处, 否则取屏幕中心
+bool isPickPressed = false; // 用于按键防抖
+bool pickRequested = false;
+// 启动后经过的秒数 (测量首帧时间)
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// .objpages (obj_pages 转换的分页网格) 流式加载, 其他路径按 OBJ 加载
+static bool isPageFile(const std::string& path) {
+    const std::string extension = ".objpages";
+    return path.size() >= extension.size() && path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+// 包围盒缩放到对角线为 2, 中心移到原点 (扫描或 CAD 模型的坐标常常远离原点, 尺度也差很多)
+static void fitModelToBounds(const Aabb& bounds) {
+    float size = glm::length(bounds.extent());
+    float scale = size > 0.0f ? 2.0f / size : 1.0f;
+    modelPosition = -bounds.center() * scale;
+    modelRotation = glm::vec3(0.0f);
+    modelScale = glm::vec3(scale);
+}
+
+// 屏幕上的一点 (像素, 原点在左上角) 对应的射线, 变换到模型空间; t 从近平面 (0) 到远平面 (1)
+static Ray screenRay(const glm::vec2& pixel, const glm::vec2& screen, const glm::mat4& modelViewProjection) {
+    glm::vec2 ndc(pixel.x / screen.x * 2.0f - 1.0f, 1.0f - pixel.y / screen.y * 2.0f);
+    glm::mat4 toModel = glm::inverse(modelViewProjection);
+    glm::vec4 nearPoint = toModel * glm::vec4(ndc.x, ndc.y, -1.0f, 1.0f);
+    glm::vec4 farPoint = toModel * glm::vec4(ndc.x, ndc.y, 1.0f, 1.0f);
+    Ray ray;
+    ray.origin = glm::vec3(nearPoint) / nearPoint.w;
+    ray.direction = glm::vec3(farPoint) / farPoint.w - ray.origin;
+    ray.tMax = 1.0f;
+    return ray;
+}
+
+// 模型空间的点投影到屏幕 (像素), 在摄像机后面时返回 false
+static bool projectToScreen(const glm::vec3& point, const glm::vec2& screen, const glm::mat4& modelViewProjection,
+                            glm::vec2& pixel) {
+    glm::vec4 clip = modelViewProjection * glm::vec4(point, 1.0f);
+    if (clip.w <= 0.0f) return false;
+    pixel = glm::vec2((clip.x / clip.w * 0.5f + 0.5f) * screen.x, (0.5f - clip.y / clip.w * 0.5f) * screen.y);
+    return true;
+}
+
+// 打开分页网格, 失败时返回空 (错误已经打印)
+static std::unique_ptr<PageStreamer> openPageFile(const std::string& path, const PageStreamOptions& options) {
+    std::unique_ptr<PageStreamer> streamer = std::make_unique<PageStreamer>(options);
+    if (!streamer->open(path)) return nullptr;
+    return streamer;
+}
+
+static const char* loadStageName(MeshLoadStage stage) {
+    switch (stage) {
+    case MeshLoadStage::Queued:    return "Queued";
+    case MeshLoadStage::Parsing:   return "Parsing";
+    case MeshLoadStage::Building:  return "Building";
+    case MeshLoadStage::Uploading: return "Uploading";
+    case MeshLoadStage::Done:      return "Done";
+    case MeshLoadStage::Failed:    return "Failed";
+    }
+    return "";
+}
+
+int main(int argc, char** argv)
 {
+    auto startTime = std::chrono::steady_clock::now();
+
+    // 命令行参数
+    MeshLoadOptions loadOptions;
+    loadOptions.buildPickBvh = true;
+    bool benchmark = false;
+    bool meshletCulling = true;
+    bool useProgramCache = true;
+    std::string tracePath;
+    std::string objPath = std::string(RES_PATH) + "/models/teapot.obj";
+    PageStreamOptions pageOptions;
+    BenchmarkOptions benchmarkOptions;
+    benchmarkOptions.outputPath = "benchmark.json";
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--packed") loadOptions.packVertices = true; // 使用 16 字节压缩顶点
+        if (arg == "--lod") loadOptions.buildLods = true;       // 后台生成 LOD 链
+        if (arg == "--flat") loadOptions.generateNormals = false; // 没有法线的模型不生成法线, 按面着色
+        if (arg == "--area-normals") loadOptions.normals.weighting = NormalWeighting::Area;
+        if (arg == "--no-reorder") loadOptions.optimizeOrder = false; // 保持 OBJ 中的三角形顺序
+        if (arg == "--no-meshlet-culling") meshletCulling = false; // 只按簇裁剪
+        if (arg == "--crease" && i + 1 < argc) loadOptions.normals.creaseAngle = (float)atof(argv[++i]); // 折痕角 (度)
+        if (arg == "--benchmark") {                             // 无窗口基准测试, 可以跟结果路径
+            benchmark = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') benchmarkOptions.outputPath = argv[++i];
+        }
+        if (arg == "--frames" && i + 1 < argc) benchmarkOptions.frames = std::max(1, atoi(argv[++i]));
+        if (arg == "--trace" && i + 1 < argc) tracePath = argv[++i];   // 录制开头 120 帧的 Chrome trace
+        if (arg == "--no-program-cache") useProgramCache = false;      // 每次都从源码编译着色器
+        if (arg == "--model" && i + 1 < argc) objPath = argv[++i];      // .obj 或 .objpages
+        if (arg == "--retain" && i + 1 < argc) {                        // 上传后保留的 CPU 端几何: drop / pick / compressed
+            std::string policy = argv[++i];
+            if (policy == "pick") loadOptions.retention = HostRetention::KeepForPicking;
+            else if (policy == "compressed") loadOptions.retention = HostRetention::KeepCompressed;
+            else loadOptions.retention = HostRetention::Drop;
+        }
+        if (arg == "--page-budget" && i + 1 < argc) pageOptions.gpuBudgetBytes = (size_t)std::max(1, atoi(argv[++i])) * 1024 * 1024;
+        if (arg == "--page-staging" && i + 1 < argc) pageOptions.hostBudgetBytes = (size_t)std::max(1, atoi(argv[++i])) * 1024 * 1024;
+        if (arg == "--no-fit") autoFit = false; // 保持模型文件中的坐标
+        if (arg == "--no-pick") loadOptions.buildPickBvh = false; // 不构建拾取 BVH (每个三角形约 50 字节)
+    }
+
+    // 着色器程序二进制缓存 (驱动支持时), 热启动跳过编译和链接
+    if (useProgramCache) Shader::programCacheDir = std::string(RES_PATH) + "/shaders/.programcache";
+
+    if (benchmark) {
+        // 固定的模型集: 自带的两个模型 + 逐级增大的生成网格; 不读写缓存, 加载时间测的是解析
+        benchmarkOptions.vertexShaderPath = std::string(RES_PATH) + "/shaders/obj_viewer.vs";
+        benchmarkOptions.fragmentShaderPath = std::string(RES_PATH) + "/shaders/obj_viewer.fs";
+        benchmarkOptions.models = { std::string(RES_PATH) + "/models/teapot.obj",
+                                    std::string(RES_PATH) + "/models/bunny_10k.obj" };
+        benchmarkOptions.syntheticTriangles = { 100000, 500000, 2000000 };
+        benchmarkOptions.loadOptions = loadOptions;
+        benchmarkOptions.loadOptions.useCache = false;
+        benchmarkOptions.meshletCulling = meshletCulling;
+        return runBenchmark(benchmarkOptions);
+    }
+
     // --- 1. 初始化 GLFW 和 GLAD ---
     glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    // 优先创建 4.3 上下文 (MultiDrawIndirect), 不支持时退回 3.3
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "OBJ Viewer", NULL, NULL);
+    if (window == NULL) {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "OBJ Viewer", NULL, NULL);
+    }
     if (window == NULL) {
         std::cout << "Failed to create GLFW window" << std::endl;
         glfwTerminate();
@@ -100,11 +251,58 @@ int main()
     // 加载着色器
     std::string vsPath = std::string(RES_PATH) + "/shaders/obj_viewer.vs";
     std::string fsPath = std::string(RES_PATH) + "/shaders/obj_viewer.fs";
-    Shader ourShader(vsPath.c_str(), fsPath.c_str());
+    // 着色器按特性编译成多个版本, 用到时才编译; 启动时先编译默认的一个 (有法线 + 头灯)
+    ShaderVariants shaders(vsPath, fsPath);
+    Shader& startupShader = shaders.get(SHADER_HAS_NORMALS | SHADER_HEADLIGHT | (loadOptions.packVertices ? SHADER_OCT_NORMALS : 0u));
+
+    // 每帧数据的 UBO (view, projection, 摄像机和光源), 每帧上传一次
+    FrameUniformBuffer frameUniforms;
+
+    // 在后台加载模型, 放入场景 (实例 0 由 "Model Transform" 窗口控制)
+    // 渲染循环立即开始, 几何数据上传到 GPU 的部分会逐帧显示出来
+    // 分页网格不进场景, 由 PageStreamer 按视点读取和绘制 (同样用 "Model Transform" 的变换)
+    std::unique_ptr<Scene> scene = std::make_unique<Scene>();
+    scene->meshletCulling = meshletCulling;
+    std::unique_ptr<PageStreamer> pages;
+    size_t ourMesh = SIZE_MAX;
+    bool fitPending = false; // 网格的包围盒在后台加载完成后才知道, 等网格出现后再适配
+
+    // 拾取结果和两点测量 (模型空间); 网格更换后清空, 三角形编号不再有效
+    const Mesh* pickedMesh = nullptr;
+    RayHit lastPick;
+    bool pickAttempted = false;
+    double lastPickUs = 0.0;
+    bool measureMode = false;
+    std::vector<glm::vec3> measurePoints;
+    if (isPageFile(objPath)) {
+        pages = openPageFile(objPath, pageOptions);
+        if (pages && autoFit) fitModelToBounds(pages->bounds());
+    } else {
+        fitPending = autoFit;
+        ourMesh = scene->addMeshAsync(objPath, loadOptions);
+        scene->addInstance(ourMesh, glm::mat4(1.0f));
+    }
 
-    // 加载模型
-    std::string objPath = std::string(RES_PATH) + "/models/teapot.obj";
-    Mesh ourMesh(objPath.c_str());
+    // 监视着色器和模型文件, 保存后自动重新加载 (debounce 之后)
+    FileWatcher watcher;
+    watcher.watch(shaders.vertexPath);
+    watcher.watch(shaders.fragmentPath);
+    watcher.watch(objPath);
+    bool modelReloadRequested = false;   // 文件已变化, 等前一次加载结束后开始重新加载
+    bool modelReloading = false;
+    std::chrono::steady_clock::time_point modelChangeTime, modelReloadChangeTime; // 等待中的 / 进行中的那次变化
+    double shaderReloadMs = -1.0;        // 从文件变化到新程序可用
+    double modelReloadMs = -1.0;         // 从文件变化到新网格第一次绘制
+
+    // "Open" 的路径输入
+    char openPath[512] = {};
+    strncpy(openPath, objPath.c_str(), sizeof(openPath) - 1);
+
+    // 加载计时: 首帧, 首次画出几何, 全部驻留 (从 main 开始或从点击 Open 开始)
+    double firstFrameSeconds = -1.0;
+    double firstGeometrySeconds = -1.0;
+    double loadedSeconds = -1.0;
+    auto loadStartTime = startTime;
 
     // 初始化ImGui
     IMGUI_CHECKVERSION();
@@ -119,9 +317,15 @@ int main()
     ImGui_ImplGlfw_InitForOpenGL(window, true);
     ImGui_ImplOpenGL3_Init("#version 330");
 
+    // 帧分析器 (CPU 区段 + GPU 计时查询)
+    std::unique_ptr<FrameProfiler> profiler = std::make_unique<FrameProfiler>();
+    if (!tracePath.empty()) profiler->captureTrace(tracePath, 120);
+
     // 渲染循环
     while (!glfwWindowShouldClose(window))
     {
+        profiler->beginFrame();
+
         // 准备绘制新一帧ImGui
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
@@ -134,27 +338,49 @@ int main()
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
 
-        // 检查输入
-        processInput(window); 
+        {
+            ProfileScope scope(*profiler, "Input");
 
+            // 检查输入
+            processInput(window); 
 
-        // 热读取Shader
-        if (isReloadPressed)
-        {
-            ourShader.reload();
-            isReloadPressed = false; // 重置按键，防止每帧都 reload
+
+            // 热读取Shader
+            if (isReloadPressed)
+            {
+                shaders.reload();
+                isReloadPressed = false; // 重置按键，防止每帧都 reload
+            }
+
+            // 文件变化: 着色器在这里重新编译; 模型在工作线程重新解析, 旧网格一直绘制到新网格全部上传
+            for (const FileWatcher::Change& change : watcher.poll()) {
+                if (change.path == shaders.vertexPath || change.path == shaders.fragmentPath) {
+                    shaders.reload();
+                    shaderReloadMs = secondsSince(change.firstEvent) * 1000.0;
+                    std::cout << "Reloaded shaders after change to " << change.path << " (" << shaderReloadMs << " ms)" << std::endl;
+                } else if (change.path == objPath && isPageFile(objPath)) {
+                    // 转换工具写完后才改名, 文件变化时已经完整; 重新打开, 保留当前变换
+                    pages = openPageFile(objPath, pageOptions);
+                    modelReloadMs = secondsSince(change.firstEvent) * 1000.0;
+                } else if (change.path == objPath) {
+                    if (!modelReloadRequested) modelChangeTime = change.firstEvent;
+                    modelReloadRequested = true;
+                }
+            }
+            if (modelReloadRequested && !modelReloading && scene->reloadMeshAsync(ourMesh, objPath, loadOptions)) {
+                modelReloadRequested = false;
+                modelReloading = true;
+                modelReloadChangeTime = modelChangeTime;
+            }
         }
         
         // 清理
-        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); 
-
-        // 激活着色器
-        ourShader.use();
-        // 检查法线
-        ourShader.setBool("u_hasNormals", ourMesh.hasNormals);
-        // 设置 MVP 矩阵和 Uniform
-        
+        {
+            ProfileScope scope(*profiler, "Clear", true);
+            glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); 
+        }
+
         glm::mat4 view;
         
         // 根据模式计算 View 矩阵
@@ -176,18 +402,32 @@ int main()
             view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
         }
 
-        // 把摄像机位置传给着色器
-        ourShader.setVec3("viewPos", cameraPos);
-        ourShader.setMat4("view", view);
-        // 把光源信息传给着色器
-        if(isHeadLightMode)lightPos = cameraPos;
-        ourShader.setVec3("lightPos", lightPos);
-        ourShader.setVec3("lightColor", lightColor);
-
-
         // 透视投影矩阵
         glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
-        ourShader.setMat4("projection", projection);
+
+        // 头灯模式下光源跟随摄像机
+        if(isHeadLightMode)lightPos = cameraPos;
+
+        // 上传每帧数据 (所有着色器程序通过 FrameData 共享)
+        FrameUniforms frameData;
+        frameData.view = view;
+        frameData.projection = projection;
+        frameData.viewProjection = projection * view;
+        frameData.viewPos = glm::vec4(cameraPos, 1.0f);
+        frameData.lightPos = glm::vec4(lightPos, 1.0f);
+        frameData.lightColor = glm::vec4(lightColor, 1.0f);
+        frameUniforms.update(frameData);
+
+        // 先推进后台加载再算模型矩阵: 小网格在一次 Draw 内就会全部上传, 适配必须在这一帧绘制之前完成
+        scene->update();
+        if (fitPending) {
+            const Mesh* fitMesh = ourMesh < scene->meshes.size() ? scene->meshes[ourMesh].get() : nullptr;
+            if (fitMesh || scene->loadStatus(ourMesh).stage == MeshLoadStage::Failed) {
+                // 网格开始上传时包围盒已经算好
+                if (fitMesh && fitMesh->bounds.valid()) fitModelToBounds(fitMesh->bounds);
+                fitPending = false;
+            }
+        }
 
         // 模型矩阵
         glm::mat4 model = glm::mat4(1.0f);
@@ -200,12 +440,81 @@ int main()
         model = glm::rotate(model, glm::radians(modelRotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
         // 缩放
         model = glm::scale(model, modelScale);
-        ourShader.setMat4("model", model);
+        if (!scene->instances.empty()) scene->instances[0].transform = model;
 
-        // 绘制
-        ourMesh.Draw(ourShader);
+        // 绘制 (视锥裁剪后, 同一网格的实例合并为一次实例化绘制)
+        SceneView sceneView;
+        sceneView.viewProjection = projection * view;
+        sceneView.cameraPos = cameraPos;
+        sceneView.pixelsPerUnit = projection[1][1] * (float)SCR_HEIGHT * 0.5f;
+        {
+            ProfileScope scope(*profiler, "Scene Draw", true);
+            uint32_t shadingFeatures = (isHeadLightMode ? SHADER_HEADLIGHT : 0u) | (isFlatShading ? SHADER_FLAT : 0u) |
+                                       (isWireframe ? SHADER_WIREFRAME : 0u);
+            if (isWireframe) glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+            scene->Draw(shaders, shadingFeatures, sceneView);
+            if (pages) pages->Draw(shaders, shadingFeatures, sceneView, model);
+            if (isWireframe) glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        }
+
+        // 加载计时
+        // 分页网格: 当前视点选中的页全部驻留算加载完成
+        MeshLoadStatus loadStatus = scene->loadStatus(ourMesh);
+        const Mesh* currentMesh = ourMesh < scene->meshes.size() ? scene->meshes[ourMesh].get() : nullptr;
+        if (pages) {
+            loadStatus.stage = pages->stats.missingPages == 0 && pages->stats.drawnPages > 0 ? MeshLoadStage::Done
+                                                                                              : MeshLoadStage::Uploading;
+            loadStatus.progress = pages->stats.wantedPages > 0
+                ? 1.0f - (float)pages->stats.missingPages / (float)pages->stats.wantedPages : 0.0f;
+        }
+        size_t drawnTriangles = scene->drawnTriangles + (pages ? pages->stats.drawnTriangles : 0);
+        if (firstGeometrySeconds < 0.0 && drawnTriangles > 0) {
+            firstGeometrySeconds = secondsSince(loadStartTime);
+            std::cout << "First geometry visible after " << firstGeometrySeconds * 1000.0 << " ms" << std::endl;
+        }
+        if (loadedSeconds < 0.0 && loadStatus.stage == MeshLoadStage::Done) {
+            loadedSeconds = secondsSince(loadStartTime);
+            std::cout << "Mesh fully resident after " << loadedSeconds * 1000.0 << " ms" << std::endl;
+        }
+        if (modelReloading && (loadStatus.stage == MeshLoadStage::Done || loadStatus.stage == MeshLoadStage::Failed)) {
+            modelReloading = false;
+            if (!scene->lastReloadFailed) {
+                modelReloadMs = secondsSince(modelReloadChangeTime) * 1000.0;
+                std::cout << "Reloaded " << objPath << ": visible " << modelReloadMs << " ms after the change" << std::endl;
+            }
+        }
+
+        // 拾取: 射线变换到模型空间, 在实例 0 的网格的三角形 BVH 上求最近的交点
+        glm::mat4 modelViewProjection = projection * view * model;
+        glm::vec2 screenSize(io.DisplaySize.x, io.DisplaySize.y);
+        if (currentMesh != pickedMesh) {
+            pickedMesh = currentMesh;
+            lastPick = RayHit();
+            pickAttempted = false;
+            measurePoints.clear();
+        }
+        if (pickRequested) {
+            pickRequested = false;
+            if (currentMesh && !currentMesh->pickBvh.empty() && screenSize.x > 0.0f && screenSize.y > 0.0f) {
+                glm::vec2 pixel = screenSize * 0.5f;
+                if (glfwGetInputMode(window, GLFW_CURSOR) == GLFW_CURSOR_NORMAL) {
+                    double cursorX, cursorY;
+                    glfwGetCursorPos(window, &cursorX, &cursorY);
+                    pixel = glm::vec2((float)cursorX, (float)cursorY);
+                }
+                auto pickStart = std::chrono::steady_clock::now();
+                lastPick = currentMesh->pickBvh.intersect(screenRay(pixel, screenSize, modelViewProjection));
+                lastPickUs = secondsSince(pickStart) * 1.0e6;
+                pickAttempted = true;
+                if (lastPick.hit && measureMode) {
+                    if (measurePoints.size() == 2) measurePoints.clear();
+                    measurePoints.push_back(lastPick.position);
+                }
+            }
+        }
 
         //ImGui相关内容更新
+        int uiSection = profiler->beginSection("ImGui Build", false);
         {
             // 相机信息窗口
             ImGui::Begin("Camera Info");
@@ -226,6 +535,17 @@ int main()
                 ImGui::Text("Camera Speed: (%.2f)", cameraSpeed);
             }
 
+            // 视锥裁剪统计
+            ImGui::Separator();
+            ImGui::Checkbox("Frustum Culling", &scene->frustumCulling);
+            ImGui::Text("Visible Instances: %zu / %zu", scene->visibleInstances, scene->instances.size());
+            ImGui::Text("Visible Clusters: %zu, Culled: %zu", scene->visibleClusters, scene->culledClusters);
+            ImGui::Checkbox("Meshlet Culling", &scene->meshletCulling);
+            ImGui::SameLine();
+            ImGui::Checkbox("Backface", &scene->meshletBackfaceCulling);
+            ImGui::Text("Visible Meshlets: %zu, Culled: %zu frustum / %zu backface", scene->visibleMeshlets,
+                        scene->frustumCulledMeshlets, scene->backfaceCulledMeshlets);
+
             // 结束窗口
             ImGui::End();
         }
@@ -247,6 +567,11 @@ int main()
 
             // 编辑颜色
             ImGui::ColorEdit3("Light Color", glm::value_ptr(lightColor));
+
+            // 着色模式 (每种组合是一个单独编译的着色器版本)
+            ImGui::Checkbox("Flat Shading", &isFlatShading);
+            ImGui::SameLine();
+            ImGui::Checkbox("Wireframe", &isWireframe);
             
             // 结束窗口
             ImGui::End();
@@ -265,15 +590,256 @@ int main()
                 modelRotation = glm::vec3(0.0f);
                 modelScale    = glm::vec3(1.0f);
             }
+            ImGui::SameLine();
+            if (ImGui::Button("Fit to View")) {
+                if (pages) fitModelToBounds(pages->bounds());
+                else if (currentMesh && currentMesh->bounds.valid()) fitModelToBounds(currentMesh->bounds);
+            }
+            ImGui::Checkbox("Auto-fit on Load", &autoFit);
 
             ImGui::End();
         }
+        {   // 拾取和测量窗口
+            ImGui::Begin("Pick");
+            if (pages) {
+                ImGui::Text("Picking: not available for paged meshes");
+            } else if (currentMesh == nullptr) {
+                ImGui::Text("Picking: waiting for mesh");
+            } else if (currentMesh->pickBvhPending()) {
+                ImGui::Text("Picking: building BVH...");
+            } else if (currentMesh->pickBvh.empty()) {
+                ImGui::Text("Picking: off (run without --no-pick)");
+            } else {
+                ImGui::Text("BVH: built in %.1f ms, %.1f MB", currentMesh->pickBvhMs,
+                            currentMesh->pickBvh.memoryBytes() / (1024.0 * 1024.0));
+                ImGui::Text("Left click: pick at screen centre (hold Alt: under cursor)");
+                ImGui::Separator();
+                if (lastPick.hit) {
+                    ImGui::Text("Triangle: %u", lastPick.triangle);
+                    ImGui::Text("Position: %.4f, %.4f, %.4f", lastPick.position.x, lastPick.position.y, lastPick.position.z);
+                    ImGui::Text("Normal: %.3f, %.3f, %.3f", lastPick.normal.x, lastPick.normal.y, lastPick.normal.z);
+                    ImGui::Text("Ray: %.1f us", lastPickUs);
+                } else {
+                    ImGui::Text("%s", pickAttempted ? "No hit" : "Nothing picked");
+                }
+
+                // 两点测量: 打开后每次命中记一个点, 第三次从头开始
+                ImGui::Separator();
+                ImGui::Checkbox("Measure", &measureMode);
+                for (size_t i = 0; i < measurePoints.size(); ++i) {
+                    ImGui::Text("Point %c: %.4f, %.4f, %.4f", (char)('A' + i), measurePoints[i].x, measurePoints[i].y,
+                                measurePoints[i].z);
+                }
+                if (measurePoints.size() == 2) {
+                    // 模型单位为文件中的坐标; 场景单位包含 Model Transform 的缩放
+                    float modelDistance = glm::distance(measurePoints[0], measurePoints[1]);
+                    float sceneDistance = glm::distance(glm::vec3(model * glm::vec4(measurePoints[0], 1.0f)),
+                                                        glm::vec3(model * glm::vec4(measurePoints[1], 1.0f)));
+                    ImGui::Text("Distance: %.4f (model), %.4f (scene)", modelDistance, sceneDistance);
+                }
+                if (ImGui::Button("Clear Points")) measurePoints.clear();
+            }
+            ImGui::End();
+
+            // 拾取点和测量线画在最上层
+            ImDrawList* overlay = ImGui::GetForegroundDrawList();
+            const ImU32 pickColor = IM_COL32(255, 200, 0, 255);
+            glm::vec2 a, b;
+            if (lastPick.hit && projectToScreen(lastPick.position, screenSize, modelViewProjection, a)) {
+                overlay->AddCircle(ImVec2(a.x, a.y), 6.0f, pickColor, 0, 2.0f);
+            }
+            for (const glm::vec3& point : measurePoints) {
+                if (projectToScreen(point, screenSize, modelViewProjection, a)) overlay->AddCircleFilled(ImVec2(a.x, a.y), 4.0f, pickColor);
+            }
+            if (measurePoints.size() == 2 && projectToScreen(measurePoints[0], screenSize, modelViewProjection, a) &&
+                projectToScreen(measurePoints[1], screenSize, modelViewProjection, b)) {
+                overlay->AddLine(ImVec2(a.x, a.y), ImVec2(b.x, b.y), pickColor, 2.0f);
+            }
+            if (measureMode && glfwGetInputMode(window, GLFW_CURSOR) != GLFW_CURSOR_NORMAL) {
+                // 鼠标被捕捉时拾取屏幕中心, 画一个准星
+                glm::vec2 c = screenSize * 0.5f;
+                overlay->AddLine(ImVec2(c.x - 8.0f, c.y), ImVec2(c.x + 8.0f, c.y), pickColor);
+                overlay->AddLine(ImVec2(c.x, c.y - 8.0f), ImVec2(c.x, c.y + 8.0f), pickColor);
+            }
+        }
+        {   // 场景窗口
+            ImGui::Begin("Scene");
+
+            // 模型加载
+            ImGui::InputText("Model", openPath, sizeof(openPath));
+            ImGui::SameLine();
+            if (ImGui::Button("Open") && !scene->loading())
+            {
+                // 新模型替换所有实例 (和打开的分页网格); 旧网格连同几何池空间一起释放
+                watcher.unwatch(objPath);
+                objPath = openPath;
+                watcher.watch(objPath);
+                modelReloadRequested = false;
+                modelReloading = false;
+                pages.reset();
+                if (ourMesh != SIZE_MAX) scene->removeMesh(ourMesh);
+                ourMesh = SIZE_MAX;
+                scene->instances.clear();
+                // 新网格可能分配在旧网格的地址上, 不能只靠 pickedMesh 比较
+                pickedMesh = nullptr;
+                lastPick = RayHit();
+                pickAttempted = false;
+                measurePoints.clear();
+                if (isPageFile(objPath)) {
+                    pages = openPageFile(objPath, pageOptions);
+                    if (pages && autoFit) fitModelToBounds(pages->bounds());
+                } else {
+                    fitPending = autoFit;
+                    ourMesh = scene->addMeshAsync(objPath, loadOptions);
+                    scene->addInstance(ourMesh, glm::mat4(1.0f));
+                }
+                loadStartTime = std::chrono::steady_clock::now();
+                firstGeometrySeconds = -1.0;
+                loadedSeconds = -1.0;
+            }
+            if (loadStatus.stage != MeshLoadStage::Done) {
+                char overlay[64];
+                snprintf(overlay, sizeof(overlay), "%s %.0f%%", loadStageName(loadStatus.stage), loadStatus.progress * 100.0f);
+                ImGui::ProgressBar(loadStatus.stage == MeshLoadStage::Failed ? 0.0f : loadStatus.progress,
+                                   ImVec2(-1.0f, 0.0f), overlay);
+            }
+            ImGui::Text("First Frame: %.1f ms", firstFrameSeconds * 1000.0);
+            ImGui::Text("Shader Build: %.1f ms (%s), %zu variants", startupShader.buildMs,
+                        startupShader.fromProgramCache ? "program cache" : "compiled", shaders.size());
+            ImGui::Text("First Geometry: %.1f ms, Resident: %.1f ms", firstGeometrySeconds * 1000.0, loadedSeconds * 1000.0);
+
+            // 热重载: 从文件变化 (第一个事件) 到结果可见的时间, 包括 debounce
+            if (watcher.available()) {
+                ImGui::Text("Hot Reload: watching shaders and model");
+                ImGui::Text("Shader Reload: %.1f ms, Model Reload: %.1f ms%s", shaderReloadMs, modelReloadMs,
+                            scene->lastReloadFailed ? " (last failed)" : "");
+                if (scene->lastReloadMs >= 0.0) ImGui::Text("  parse + upload: %.1f ms", scene->lastReloadMs);
+            } else {
+                ImGui::Text("Hot Reload: unavailable (press R to reload shaders)");
+            }
+
+            ImGui::Separator();
+            ImGui::Text("Instances: %zu", scene->instances.size());
+            ImGui::Text("Triangles: %zu", drawnTriangles);
+            ImGui::Text("Draw Calls: %zu (%s)", scene->drawCalls,
+                        scene->useMultiDrawIndirect ? "MultiDrawIndirect" : "Instanced");
+
+            ImGui::SliderInt("Grid Size", &gridSize, 1, 100);
+            ImGui::DragFloat("Grid Spacing", &gridSpacing, 0.1f, 0.1f, 100.0f);
+
+            // 在 XZ 平面上追加 gridSize x gridSize 个副本 (分页网格没有副本)
+            if (ImGui::Button("Add Grid") && !scene->instances.empty())
+            {
+                float half = (float)(gridSize - 1) * 0.5f;
+                for (int x = 0; x < gridSize; ++x) {
+                    for (int z = 0; z < gridSize; ++z) {
+                        glm::vec3 offset(((float)x - half) * gridSpacing, 0.0f, ((float)z - half) * gridSpacing);
+                        scene->addInstance(ourMesh, glm::translate(glm::mat4(1.0f), offset));
+                    }
+                }
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Clear Copies") && !scene->instances.empty())
+            {
+                scene->instances.resize(1);
+            }
+
+            // LOD
+            ImGui::Separator();
+            const Mesh* loadedMesh = ourMesh < scene->meshes.size() ? scene->meshes[ourMesh].get() : nullptr;
+            if (pages) {
+                ImGui::Text("LOD: paged mesh (see Streaming)");
+            } else if (loadedMesh == nullptr || loadStatus.stage != MeshLoadStage::Done) {
+                ImGui::Text("LOD: waiting for mesh");
+            } else if (loadedMesh->lodsPending()) {
+                ImGui::Text("LOD: building...");
+            } else if (loadedMesh->lods.empty()) {
+                ImGui::Text("LOD: off (run with --lod)");
+            } else {
+                ImGui::Checkbox("Use LOD", &scene->useLods);
+                ImGui::SliderFloat("LOD Pixel Error", &scene->lodPixelError, 0.1f, 16.0f);
+                const Mesh& mesh = *loadedMesh;
+                ImGui::SliderInt("Force LOD", &scene->forceLod, -1, (int)mesh.lods.size());
+                for (int level = 0; level <= (int)mesh.lods.size(); ++level) {
+                    size_t triangles = level == 0 ? mesh.indexCount / 3 : mesh.lods[level - 1].indexCount / 3;
+                    ImGui::Text("LOD %d (%zu tris): %zu instances, %zu triangles drawn", level, triangles,
+                                scene->lodInstances[level], scene->lodTriangles[level]);
+                }
+            }
+
+            ImGui::End();
+        }
+        {   // 内存窗口: 每个网格的 CPU/GPU 占用和解析时的临时内存峰值
+            const double MB = 1024.0 * 1024.0;
+            ImGui::Begin("Memory");
+
+            const char* retentionNames[] = { "Drop", "Keep for picking", "Keep compressed" };
+            int retentionIndex = (int)loadOptions.retention;
+            if (ImGui::Combo("Host Retention", &retentionIndex, retentionNames, 3)) {
+                loadOptions.retention = (HostRetention)retentionIndex; // 下一次 Open 或重新加载时生效
+            }
+
+            size_t hostBytes = 0, gpuBytes = 0;
+            for (size_t m = 0; m < scene->meshes.size(); ++m) {
+                if (!scene->meshes[m]) continue;
+                MeshMemoryStats stats = scene->meshes[m]->memoryStats();
+                ImGui::Text("Mesh %zu (%s): host %.1f MB (kept %.1f), GPU %.1f MB, parse peak %.1f MB", m,
+                            hostRetentionName(scene->meshes[m]->retention), stats.hostBytes / MB, stats.retainedBytes / MB,
+                            stats.gpuBytes / MB, stats.parseScratchPeakBytes / MB);
+                hostBytes += stats.hostBytes;
+                gpuBytes += stats.gpuBytes;
+            }
+            ImGui::Separator();
+            ImGui::Text("Meshes: host %.1f MB, GPU %.1f MB", hostBytes / MB, gpuBytes / MB);
+            ImGui::Text("Scene GPU Buffers: %.1f MB (with pool headroom)", scene->gpuBufferBytes() / MB);
+            if (pages) ImGui::Text("Paged Mesh: host %.1f MB, GPU %.1f MB", pages->stats.hostBytes / MB, pages->stats.gpuBytes / MB);
+            ImGui::End();
+        }
+        if (pages) {   // 流式加载窗口
+            const PageStreamStats& stats = pages->stats;
+            ImGui::Begin("Streaming");
+            ImGui::Text("Pages: %zu (%llu source triangles)", pages->nodeCount(),
+                        (unsigned long long)pages->header().sourceTriangles);
+            ImGui::Text("Resident: %zu / %zu slots, wanted %zu, missing %zu", stats.residentPages, stats.slots,
+                        stats.wantedPages, stats.missingPages);
+            ImGui::Text("Drawn: %zu pages, %zu triangles", stats.drawnPages, stats.drawnTriangles);
+            ImGui::Text("Queued: %zu, Staged: %zu (%.1f MB)", stats.queuedPages, stats.stagedPages,
+                        (double)stats.stagedBytes / (1024.0 * 1024.0));
+            ImGui::Text("Memory: host %.1f MB, GPU %.1f MB", (double)stats.hostBytes / (1024.0 * 1024.0),
+                        (double)stats.gpuBytes / (1024.0 * 1024.0));
+            ImGui::Text("Read: %.1f MB/s, Upload: %.1f MB/s", stats.readMBps, stats.uploadMBps);
+            ImGui::Text("Pages Read: %llu, Evictions: %llu, Dropped: %llu", (unsigned long long)stats.pagesRead,
+                        (unsigned long long)stats.evictions, (unsigned long long)stats.droppedPages);
+            if (stats.poolFull) ImGui::Text("Page pool full: raise Pixel Error or --page-budget");
+            ImGui::SliderFloat("Pixel Error", &pages->options.pixelError, 0.25f, 16.0f);
+            int uploadMB = (int)(pages->options.uploadBytesPerFrame / (1024 * 1024));
+            if (ImGui::SliderInt("Upload MB / Frame", &uploadMB, 1, 64)) pages->options.uploadBytesPerFrame = (size_t)uploadMB * 1024 * 1024;
+            ImGui::Checkbox("Page Frustum Culling", &pages->frustumCulling);
+            ImGui::End();
+        }
+        // 帧分析窗口
+        profiler->drawWindow();
+        profiler->endSection(uiSection);
+
         // ImGui 渲染
-        ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        {
+            ProfileScope scope(*profiler, "ImGui Render", true);
+            ImGui::Render();
+            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        }
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        {
+            ProfileScope scope(*profiler, "Swap");
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+        profiler->endFrame();
+
+        if (firstFrameSeconds < 0.0) {
+            firstFrameSeconds = secondsSince(startTime);
+            std::cout << "Time to first frame: " << firstFrameSeconds * 1000.0 << " ms ("
+                      << (startupShader.fromProgramCache ? "warm" : "cold") << " shader start: " << startupShader.buildMs << " ms)" << std::endl;
+        }
     }
 
     ImGui_ImplOpenGL3_Shutdown();
@@ -281,7 +847,9 @@ int main()
     ImGui::DestroyContext();
 
 
-    // 清理
+    // 清理 (GL 对象需要在销毁上下文之前释放)
+    profiler.reset();
+    scene.reset();
     glfwTerminate();
     return 0;
 }
@@ -432,6 +1000,15 @@ void processInput(GLFWwindow *window)
             cameraPos += glm::normalize(glm::cross(cameraFront, cameraUp)) * speed;
     }
     
+    // 鼠标左键拾取 (在 ImGui 窗口上按下的不算, 拖出窗口也不算)
+    if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS) {
+        if (!isPickPressed && !ImGui::GetIO().WantCaptureMouse) pickRequested = true;
+        isPickPressed = true;
+    }
+    if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_RELEASE) {
+        isPickPressed = false;
+    }
+
     // R键重新加载
     if (glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS && !isReloadPressed)
     {
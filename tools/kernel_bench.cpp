@@ -0,0 +1,194 @@
+// 几何内核基准: 对比交错存放 (AoS) 的标量 glm 写法和 SoA 内核的各个指令集版本
+//
+//   kernel_bench [--count N] [--repeat R]
+//
+// 每个操作在 N 个随机向量上运行 R 次取最快的一次, 并报告与 glm 写法的最大误差 (ULP, 0 为逐位一致).
+// "vertex bounds" 为 Vertex 数组 (32 字节一个顶点) 上的 glm 循环, 作为交错存放时的参考.
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+#include <glm/gtc/matrix_transform.hpp>
+#include "SimdKernels.h"
+#include "Vertex.h"
+
+namespace {
+
+struct Soa {
+    std::vector<float> x, y, z;
+
+    explicit Soa(size_t count = 0) : x(count), y(count), z(count) {}
+    void fromAos(const std::vector<glm::vec3>& values) {
+        for (size_t i = 0; i < values.size(); ++i) {
+            x[i] = values[i].x;
+            y[i] = values[i].y;
+            z[i] = values[i].z;
+        }
+    }
+    // 与 values 的最大 ULP 差
+    uint32_t ulpsFrom(const std::vector<glm::vec3>& values) const {
+        uint32_t worst = 0;
+        for (size_t i = 0; i < values.size(); ++i) {
+            worst = std::max({ worst, ulps(x[i], values[i].x), ulps(y[i], values[i].y), ulps(z[i], values[i].z) });
+        }
+        return worst;
+    }
+
+    // 两个浮点数之间相隔的可表示数个数 (按有序整数比较)
+    static uint32_t ulps(float a, float b) {
+        int32_t ia, ib;
+        memcpy(&ia, &a, sizeof(ia));
+        memcpy(&ib, &b, sizeof(ib));
+        if (ia < 0) ia = INT32_MIN - ia;
+        if (ib < 0) ib = INT32_MIN - ib;
+        int64_t diff = (int64_t)ia - (int64_t)ib;
+        return (uint32_t)std::min<int64_t>(diff < 0 ? -diff : diff, UINT32_MAX);
+    }
+};
+
+// 运行 repeat 次, 返回最快一次的秒数; prepare 在每次计时前调用 (不计时)
+double bestOf(int repeat, const std::function<void()>& prepare, const std::function<void()>& run) {
+    double best = 1e30;
+    for (int r = 0; r < repeat; ++r) {
+        prepare();
+        auto start = std::chrono::steady_clock::now();
+        run();
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+void printRow(const char* op, const char* impl, size_t count, double seconds, double baseline, uint32_t ulps) {
+    printf("%-14s %-8s %9.2f %10.1f %8.2fx %8u\n", op, impl, seconds * 1000.0, (double)count / seconds / 1.0e6,
+           baseline / seconds, ulps);
+}
+
+uint32_t boxUlps(const Aabb& a, const Aabb& b) {
+    uint32_t worst = 0;
+    for (int axis = 0; axis < 3; ++axis) {
+        worst = std::max({ worst, Soa::ulps(a.min[axis], b.min[axis]), Soa::ulps(a.max[axis], b.max[axis]) });
+    }
+    return worst;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t count = 4000000;
+    int repeat = 5;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--count" && i + 1 < argc) {
+            count = (size_t)std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--repeat" && i + 1 < argc) {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        } else {
+            fprintf(stderr, "usage: kernel_bench [--count N] [--repeat R]\n");
+            return 1;
+        }
+    }
+
+    // 随机数据: a, b 为任意向量 (少量零向量检验 fallback), 矩阵为绕斜轴的旋转 + 缩放 + 平移
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<float> dist(-100.0f, 100.0f);
+    std::vector<glm::vec3> a(count), b(count);
+    for (size_t i = 0; i < count; ++i) {
+        a[i] = (i % 997 == 0) ? glm::vec3(0.0f) : glm::vec3(dist(rng), dist(rng), dist(rng));
+        b[i] = glm::vec3(dist(rng), dist(rng), dist(rng));
+    }
+    std::vector<Vertex> vertices(count);
+    for (size_t i = 0; i < count; ++i) vertices[i].Position = a[i];
+    glm::mat4 m = glm::translate(glm::mat4(1.0f), glm::vec3(3.0f, -2.0f, 7.0f)) *
+                  glm::rotate(glm::mat4(1.0f), 0.7f, glm::normalize(glm::vec3(1.0f, 2.0f, 3.0f))) *
+                  glm::scale(glm::mat4(1.0f), glm::vec3(1.5f));
+    const glm::vec3 up(0.0f, 0.0f, 1.0f);
+
+    std::vector<SimdLevel> levels = { SimdLevel::Scalar };
+    if (detectSimdLevel() >= SimdLevel::Sse2) levels.push_back(SimdLevel::Sse2);
+    if (detectSimdLevel() >= SimdLevel::Avx2) levels.push_back(SimdLevel::Avx2);
+
+    printf("kernel_bench: %zu vectors, best of %d, CPU supports %s\n", count, repeat, simdLevelName(detectSimdLevel()));
+    printf("%-14s %-8s %9s %10s %9s %8s\n", "op", "impl", "ms", "Mvec/s", "vs glm", "max ulp");
+
+    Soa soaA(count), soaB(count), soaOut(count);
+    soaB.fromAos(b);
+    std::vector<glm::vec3> expected(count);
+    auto noPrepare = []() {};
+
+    // 包围盒
+    Aabb glmBox;
+    double glmSeconds = bestOf(repeat, noPrepare, [&]() {
+        Aabb box;
+        for (const glm::vec3& p : a) box.grow(p);
+        glmBox = box;
+    });
+    printRow("bounds", "glm", count, glmSeconds, glmSeconds, 0);
+    soaA.fromAos(a);
+    for (SimdLevel level : levels) {
+        setSimdLevel(level);
+        Aabb box;
+        double seconds = bestOf(repeat, noPrepare, [&]() { box = simdBounds(soaA.x.data(), soaA.y.data(), soaA.z.data(), count); });
+        printRow("bounds", simdLevelName(level), count, seconds, glmSeconds, boxUlps(box, glmBox));
+    }
+    double vertexSeconds = bestOf(repeat, noPrepare, [&]() {
+        Aabb box;
+        for (const Vertex& v : vertices) box.grow(v.Position);
+        glmBox = box;
+    });
+    printRow("vertex bounds", "glm", count, vertexSeconds, glmSeconds, 0);
+
+    // 仿射变换 (就地, 每次计时前恢复输入)
+    std::vector<glm::vec3> work(count);
+    glmSeconds = bestOf(repeat, [&]() { work = a; }, [&]() {
+        for (glm::vec3& p : work) p = glm::vec3(m * glm::vec4(p, 1.0f));
+    });
+    expected = work;
+    printRow("transform", "glm", count, glmSeconds, glmSeconds, 0);
+    for (SimdLevel level : levels) {
+        setSimdLevel(level);
+        double seconds = bestOf(repeat, [&]() { soaA.fromAos(a); },
+                                [&]() { simdTransformPoints(m, soaA.x.data(), soaA.y.data(), soaA.z.data(), count); });
+        printRow("transform", simdLevelName(level), count, seconds, glmSeconds, soaA.ulpsFrom(expected));
+    }
+
+    // 归一化 (零向量取 fallback, 与 MeshNormals 的 normalizeOr 相同)
+    glmSeconds = bestOf(repeat, [&]() { work = a; }, [&]() {
+        for (glm::vec3& v : work) {
+            float length = glm::length(v);
+            v = length > 0.0f && std::isfinite(length) ? v / length : up;
+        }
+    });
+    expected = work;
+    printRow("normalize", "glm", count, glmSeconds, glmSeconds, 0);
+    for (SimdLevel level : levels) {
+        setSimdLevel(level);
+        double seconds = bestOf(repeat, [&]() { soaA.fromAos(a); },
+                                [&]() { simdNormalize(soaA.x.data(), soaA.y.data(), soaA.z.data(), count, up); });
+        printRow("normalize", simdLevelName(level), count, seconds, glmSeconds, soaA.ulpsFrom(expected));
+    }
+
+    // 叉积累加: out = b; out += a x b
+    glmSeconds = bestOf(repeat, [&]() { work = b; }, [&]() {
+        for (size_t i = 0; i < count; ++i) work[i] += glm::cross(a[i], b[i]);
+    });
+    expected = work;
+    printRow("cross += ", "glm", count, glmSeconds, glmSeconds, 0);
+    soaA.fromAos(a);
+    for (SimdLevel level : levels) {
+        setSimdLevel(level);
+        double seconds = bestOf(repeat, [&]() { soaOut.fromAos(b); }, [&]() {
+            simdAccumulateCross(soaA.x.data(), soaA.y.data(), soaA.z.data(), soaB.x.data(), soaB.y.data(), soaB.z.data(),
+                                soaOut.x.data(), soaOut.y.data(), soaOut.z.data(), count);
+        });
+        printRow("cross += ", simdLevelName(level), count, seconds, glmSeconds, soaOut.ulpsFrom(expected));
+    }
+    return 0;
+}
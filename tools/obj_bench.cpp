@@ -0,0 +1,206 @@
+// OBJ 解析器基准: 在内存中生成各种写法的合成 OBJ, 统计解析吞吐量和峰值内存
+//
+//   obj_bench [--faces N] [--threads T] [--repeat R] [--variant 名称]
+//
+// 每种写法分别用单线程和 T 个线程 (0 = 硬件线程数) 解析 R 次, 取最快的一次,
+// 并校验解析出的三角形数和顶点数. 没有法线的写法另外统计生成平滑法线的时间 (无折痕 / 30 度折痕)
+// 每次解析的堆分配次数和字节数通过替换全局 operator new 统计 (只在这个工具里)
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+#include "MeshNormals.h"
+#include "ObjParser.h"
+#include "SyntheticMesh.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+std::atomic<size_t> allocationCount{ 0 };
+std::atomic<size_t> allocationBytes{ 0 };
+
+} // namespace
+
+void* operator new(size_t bytes) {
+    ++allocationCount;
+    allocationBytes += bytes;
+    if (void* p = std::malloc(bytes > 0 ? bytes : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+struct Variant {
+    const char* name;
+    SyntheticObjOptions options;
+};
+
+// 进程的峰值常驻内存 (MB)
+double peakRssMB() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0.0;
+    return (double)counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0.0;
+#ifdef __APPLE__
+    return (double)usage.ru_maxrss / (1024.0 * 1024.0); // 字节
+#else
+    return (double)usage.ru_maxrss / 1024.0;            // KB
+#endif
+#endif
+}
+
+std::vector<Variant> makeVariants(size_t faces) {
+    std::vector<Variant> variants;
+    auto add = [&variants, faces](const char* name, ObjFaceFormat format) -> SyntheticObjOptions& {
+        Variant variant;
+        variant.name = name;
+        variant.options.minTriangles = faces;
+        variant.options.format = format;
+        variants.push_back(variant);
+        return variants.back().options;
+    };
+    add("v", ObjFaceFormat::Position);
+    add("v/vt", ObjFaceFormat::PositionTexCoord);
+    add("v//vn", ObjFaceFormat::PositionNormal);
+    add("v/vt/vn", ObjFaceFormat::PositionTexCoordNormal);
+    add("negative", ObjFaceFormat::PositionTexCoordNormal).negativeIndices = true;
+    add("quads", ObjFaceFormat::PositionTexCoordNormal).quads = true;
+    SyntheticObjOptions& messy = add("crlf+groups", ObjFaceFormat::PositionTexCoordNormal);
+    messy.crlf = true;
+    messy.comments = true;
+    messy.groups = true;
+    add("mixed", ObjFaceFormat::Mixed).comments = true;
+    return variants;
+}
+
+void usage() {
+    std::cout << "usage: obj_bench [--faces N] [--threads T] [--repeat R] [--variant NAME]" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t faces = 2000000;
+    unsigned int threads = 0;
+    int repeat = 3;
+    std::string only;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--faces" && i + 1 < argc) {
+            faces = (size_t)std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = (unsigned int)std::atoi(argv[++i]);
+        } else if (arg == "--repeat" && i + 1 < argc) {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--variant" && i + 1 < argc) {
+            only = argv[++i];
+        } else {
+            usage();
+            return arg == "--help" ? 0 : 2;
+        }
+    }
+
+    int failures = 0;
+    printf("%-12s %8s %10s %7s %9s %9s %10s %9s %9s %9s %10s %10s\n", "variant", "threads", "triangles", "MB", "ms",
+           "MB/s", "Mverts/s", "Mtris/s", "peak MB", "allocs", "alloc MB", "scratch MB");
+    for (const Variant& variant : makeVariants(faces)) {
+        if (!only.empty() && only != variant.name) continue;
+
+        std::string text;
+        SyntheticObjInfo info = generateSphereObj(variant.options, text);
+        double megabytes = (double)text.size() / (1024.0 * 1024.0);
+
+        const unsigned int threadCounts[] = { 1, threads };
+        double parseSeconds = 0.0;
+        for (unsigned int threadCount : threadCounts) {
+            double bestSeconds = 1e30;
+            size_t vertices = 0, triangles = 0, allocations = 0, allocatedBytes = 0, scratchBytes = 0;
+            bool parsed = true;
+            for (int r = 0; r < repeat && parsed; ++r) {
+                ObjParser parser;
+                parser.threadCount = threadCount;
+                size_t countBefore = allocationCount, bytesBefore = allocationBytes;
+                auto start = std::chrono::steady_clock::now();
+                parsed = parser.parse(text.data(), text.data() + text.size());
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                bestSeconds = std::min(bestSeconds, seconds);
+                allocations = allocationCount - countBefore;
+                allocatedBytes = allocationBytes - bytesBefore;
+                scratchBytes = parser.scratchPeakBytes;
+                vertices = parser.vertices.size();
+                triangles = parser.indices.size() / 3;
+            }
+
+            // 格式统一时去重后的顶点数就是 'v' 的行数; Mixed 的顶点数取决于各面的写法, 不校验
+            bool valid = parsed && triangles == info.triangles &&
+                         (variant.options.format == ObjFaceFormat::Mixed || vertices == info.positions);
+            if (!valid) {
+                std::cerr << "ERROR::OBJ_BENCH::" << variant.name << " with " << threadCount << " threads: parsed "
+                          << triangles << " triangles / " << vertices << " vertices, expected " << info.triangles
+                          << " / " << info.positions << std::endl;
+                ++failures;
+                continue;
+            }
+
+            std::string threadLabel = threadCount == 0 ? "auto" : std::to_string(threadCount);
+            printf("%-12s %8s %10zu %7.1f %9.1f %9.1f %10.2f %9.2f %9.1f %9zu %10.1f %10.1f\n", variant.name,
+                   threadLabel.c_str(), triangles, megabytes, bestSeconds * 1000.0, megabytes / bestSeconds,
+                   (double)vertices / bestSeconds / 1.0e6, (double)triangles / bestSeconds / 1.0e6, peakRssMB(), allocations,
+                   (double)allocatedBytes / (1024.0 * 1024.0), (double)scratchBytes / (1024.0 * 1024.0));
+            fflush(stdout);
+            parseSeconds = bestSeconds;
+        }
+
+        // 生成法线 (在 T 个线程的解析结果上), 与解析时间对比
+        bool withNormals = variant.options.format == ObjFaceFormat::PositionNormal ||
+                           variant.options.format == ObjFaceFormat::PositionTexCoordNormal;
+        if (withNormals || parseSeconds <= 0.0) continue;
+        ObjParser parser;
+        parser.threadCount = threads;
+        if (!parser.parse(text.data(), text.data() + text.size())) continue;
+        const float creaseAngles[] = { 0.0f, 30.0f };
+        for (float creaseAngle : creaseAngles) {
+            NormalOptions normalOptions;
+            normalOptions.creaseAngle = creaseAngle;
+            normalOptions.threads = threads;
+            NormalStats best;
+            best.seconds = 1e30;
+            for (int r = 0; r < repeat; ++r) {
+                std::vector<Vertex> vertices = parser.vertices;
+                std::vector<uint32_t> indices = parser.indices;
+                NormalStats stats = generateNormals(vertices, indices, normalOptions);
+                if (stats.seconds < best.seconds) best = stats;
+            }
+            printf("%-12s   normals (crease %2.0f deg): %8.1f ms, +%.0f%% of parse, %zu split vertices\n", variant.name,
+                   creaseAngle, best.seconds * 1000.0, best.seconds / parseSeconds * 100.0, best.splitVertices);
+            fflush(stdout);
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
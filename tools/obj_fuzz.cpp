@@ -0,0 +1,230 @@
+// OBJ 解析器的语料回放 / 模糊测试驱动
+//
+//   obj_fuzz <文件或目录>...                        回放语料
+//   obj_fuzz --mutate N [--seed S] [<文件或目录>...]  以语料 (和内置种子) 为起点随机变异 N 次
+//
+// 每个输入都检查:
+//   - 解析成功时索引数是 3 的倍数, 且都在顶点范围内
+//   - 切成很多小块的多线程解析与单线程解析结果完全一致 (包括是否失败)
+//   - 把 LF 换成 CRLF 不改变结果
+// 不满足时把输入写到 obj_fuzz_failure_<n>.obj 并返回非零.
+// 用 -DOBJ_VIEWER_LIBFUZZER=ON (clang) 编译时改为 libFuzzer 入口, 检查失败时 abort.
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "ObjParser.h"
+
+namespace {
+
+struct ParseResult {
+    bool parsed = false;
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    bool hasNormals = false;
+};
+
+ParseResult parseWith(const std::string& text, unsigned int threads, size_t minChunkBytes) {
+    ObjParser parser;
+    parser.threadCount = threads;
+    parser.minChunkBytes = minChunkBytes;
+
+    // 出错的输入是常态, 不打印解析错误
+    std::cerr.setstate(std::ios::failbit);
+    ParseResult result;
+    result.parsed = parser.parse(text.data(), text.data() + text.size());
+    std::cerr.clear();
+
+    result.vertices = std::move(parser.vertices);
+    result.indices = std::move(parser.indices);
+    result.hasNormals = parser.hasNormals;
+    return result;
+}
+
+// 逐字节比较 (NaN 也要一致)
+bool sameResult(const ParseResult& a, const ParseResult& b) {
+    if (a.parsed != b.parsed) return false;
+    if (!a.parsed) return true;
+    return a.hasNormals == b.hasNormals && a.indices == b.indices && a.vertices.size() == b.vertices.size() &&
+           (a.vertices.empty() || memcmp(a.vertices.data(), b.vertices.data(), a.vertices.size() * sizeof(Vertex)) == 0);
+}
+
+// 检查一个输入, 失败时返回原因
+const char* checkInput(const std::string& text) {
+    ParseResult single = parseWith(text, 1, 256 * 1024);
+    if (single.parsed) {
+        if (single.indices.size() % 3 != 0) return "index count is not a multiple of 3";
+        for (uint32_t index : single.indices) {
+            if (index >= single.vertices.size()) return "index out of range";
+        }
+    }
+
+    // 每块至少 1 字节: 即使很小的输入也会切成多块, 覆盖分块边界和相对索引的换算
+    ParseResult chunked = parseWith(text, 4, 1);
+    if (!sameResult(single, chunked)) return "chunked parse differs from single-threaded parse";
+
+    std::string crlf;
+    crlf.reserve(text.size() + text.size() / 8);
+    for (char c : text) {
+        if (c == '\n') crlf += '\r';
+        crlf += c;
+    }
+    if (!sameResult(single, parseWith(crlf, 1, 256 * 1024))) return "CRLF line endings change the result";
+    return nullptr;
+}
+
+} // namespace
+
+#ifdef OBJ_FUZZ_LIBFUZZER
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    const char* failure = checkInput(std::string((const char*)data, size));
+    if (failure) {
+        fprintf(stderr, "obj_fuzz: %s\n", failure);
+        abort();
+    }
+    return 0;
+}
+
+#else
+
+namespace {
+
+// 内置种子: 覆盖各种面写法, 负索引, 多边形和忽略的关键字
+const char* const BUILTIN_SEEDS[] = {
+    "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n",
+    "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nvt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\nf 1/1 2/2 3/3 4/4\n",
+    "v 0 0 0\nv 1 0 0\nv 0 1 0\nvn 0 0 1\nf 1//1 2//1 3//1\n",
+    "# comment\no obj\ng group\nusemtl mat\nv -1.5e-3 2 3.25\nv 4 5 6\nv 7 8 9\nvt 0.5 0.5\nvn 0 1 0\ns off\nf -3/-1/-1 -2/-1/-1 -1/-1/-1\n",
+    "v 0 0 0\r\nv 1 0 0\r\nv 0 1 0\r\nv 1 1 0\r\nf 1 2 4 3\r\n\r\nf 3 1 4\r\n",
+    "v 1 2\nv 3 4 5 6\nv 7 8 9\nf 1 2 3\nv 1 1 1\nf -1 -2 -3\n",
+};
+
+// 变异用的词典: OBJ 里有特殊含义的片段
+const char* const DICTIONARY[] = {
+    "v ", "vt ", "vn ", "f ", "/", "//", "-", "-1", "0", "1", "2147483648", "99999999999", "1e38", "1e-45",
+    "nan", "inf", ".", "e", "+", " ", "\t", "\n", "\r\n", "\r", "#", "o x\n", "g\n", "usemtl m\n", "\\\n",
+};
+
+bool readFile(const std::filesystem::path& path, std::string& text) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    text.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+void collectInputs(const std::string& argument, std::vector<std::string>& inputs) {
+    std::error_code error;
+    std::filesystem::path path(argument);
+    if (std::filesystem::is_directory(path, error)) {
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(path, error)) {
+            if (!entry.is_regular_file()) continue;
+            std::string text;
+            if (readFile(entry.path(), text)) inputs.push_back(std::move(text));
+        }
+    } else {
+        std::string text;
+        if (readFile(path, text)) {
+            inputs.push_back(std::move(text));
+        } else {
+            std::cerr << "ERROR::OBJ_FUZZ::Could not read: " << argument << std::endl;
+        }
+    }
+}
+
+// 随机施加 1..8 次变异
+std::string mutate(const std::string& seed, std::mt19937& random) {
+    std::string text = seed;
+    int steps = 1 + (int)(random() % 8);
+    for (int step = 0; step < steps; ++step) {
+        size_t position = text.empty() ? 0 : random() % (text.size() + 1);
+        switch (random() % 6) {
+        case 0: // 改一个字节
+            if (!text.empty()) text[std::min(position, text.size() - 1)] = (char)(random() % 256);
+            break;
+        case 1: // 插入词典片段
+            text.insert(position, DICTIONARY[random() % (sizeof(DICTIONARY) / sizeof(DICTIONARY[0]))]);
+            break;
+        case 2: // 删除一段
+            text.erase(position, random() % 16);
+            break;
+        case 3: { // 复制一段到别处
+            size_t length = std::min<size_t>(random() % 64, text.size() - std::min(position, text.size()));
+            std::string piece = text.substr(position, length);
+            text.insert(text.empty() ? 0 : random() % (text.size() + 1), piece);
+            break;
+        }
+        case 4: // 截断
+            text.resize(position);
+            break;
+        default: // 插入数字
+            text.insert(position, std::to_string((int)(random() % 2001) - 1000));
+            break;
+        }
+    }
+    return text;
+}
+
+int reportFailure(const std::string& text, const char* failure, int& failureCount) {
+    std::string path = "obj_fuzz_failure_" + std::to_string(failureCount++) + ".obj";
+    std::ofstream out(path, std::ios::binary);
+    out.write(text.data(), (std::streamsize)text.size());
+    std::cerr << "ERROR::OBJ_FUZZ::" << failure << " (input written to " << path << ")" << std::endl;
+    return 1;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    long long mutations = 0;
+    unsigned int seed = 1;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--mutate" && i + 1 < argc) {
+            mutations = std::atoll(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--help") {
+            std::cout << "usage: obj_fuzz [--mutate N] [--seed S] [file or directory]..." << std::endl;
+            return 0;
+        } else {
+            collectInputs(arg, inputs);
+        }
+    }
+    if (inputs.empty() && mutations == 0) {
+        std::cout << "usage: obj_fuzz [--mutate N] [--seed S] [file or directory]..." << std::endl;
+        return 2;
+    }
+    for (const char* builtin : BUILTIN_SEEDS) inputs.push_back(builtin);
+
+    // 回放语料
+    int failureCount = 0;
+    for (const std::string& text : inputs) {
+        if (const char* failure = checkInput(text)) reportFailure(text, failure, failureCount);
+    }
+    std::cout << "Checked " << inputs.size() << " corpus inputs" << std::endl;
+
+    // 变异 (固定种子, 结果可复现)
+    std::mt19937 random(seed);
+    for (long long m = 0; m < mutations && failureCount < 16; ++m) {
+        std::string text = mutate(inputs[random() % inputs.size()], random);
+        if (const char* failure = checkInput(text)) reportFailure(text, failure, failureCount);
+        if ((m + 1) % 10000 == 0) std::cout << "  " << m + 1 << " mutations" << std::endl;
+    }
+    if (mutations > 0) std::cout << "Ran " << mutations << " mutations with seed " << seed << std::endl;
+
+    if (failureCount > 0) {
+        std::cerr << "ERROR::OBJ_FUZZ::" << failureCount << " failing inputs" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+#endif
@@ -0,0 +1,88 @@
+// OBJ -> 分页网格 (.objpages) 离线转换, 供查看器流式加载比内存/显存大的模型
+//
+//   obj_pages input.obj [output.objpages] [--threads T] [--temp 目录] [--memory MB] [--quiet]
+//
+// 输出路径缺省为输入路径换成 .objpages 扩展名. 转换过程的内存占用由 --memory (三角形列表在内存中划分的上限)
+// 和解析分块大小决定, 与模型大小无关; 临时文件约为 OBJ 中属性和三角形的二进制大小, 默认写在输出文件旁边.
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include "PageBuilder.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+// 进程的峰值常驻内存 (MB)
+double peakRssMB() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0.0;
+    return (double)counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0.0;
+#ifdef __APPLE__
+    return (double)usage.ru_maxrss / (1024.0 * 1024.0); // 字节
+#else
+    return (double)usage.ru_maxrss / 1024.0;            // KB
+#endif
+#endif
+}
+
+void usage() {
+    std::cout << "usage: obj_pages input.obj [output.objpages] [--threads T] [--temp DIR] [--memory MB] [--quiet]" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string inputPath, outputPath;
+    PageBuildOptions options;
+    options.verbose = true;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            options.threads = (unsigned int)std::atoi(argv[++i]);
+        } else if (arg == "--temp" && i + 1 < argc) {
+            options.tempDir = argv[++i];
+        } else if (arg == "--memory" && i + 1 < argc) {
+            options.memoryBytes = (size_t)std::max(1ll, std::atoll(argv[++i])) * 1024 * 1024;
+        } else if (arg == "--quiet") {
+            options.verbose = false;
+        } else if (!arg.empty() && arg[0] != '-' && inputPath.empty()) {
+            inputPath = arg;
+        } else if (!arg.empty() && arg[0] != '-' && outputPath.empty()) {
+            outputPath = arg;
+        } else {
+            usage();
+            return arg == "--help" ? 0 : 2;
+        }
+    }
+    if (inputPath.empty()) {
+        usage();
+        return 2;
+    }
+    if (outputPath.empty()) outputPath = std::filesystem::path(inputPath).replace_extension(".objpages").string();
+
+    PageBuildStats stats;
+    if (!buildPageFile(inputPath, outputPath, options, stats)) return 1;
+
+    printf("%s: %zu triangles, %zu positions\n", outputPath.c_str(), stats.sourceTriangles, stats.positions);
+    printf("  %zu pages (%zu leaves, depth %zu, %zu clustered), %.1f MB\n", stats.nodes, stats.leaves, stats.depth,
+           stats.clusteredNodes, (double)stats.outputBytes / (1024.0 * 1024.0));
+    printf("  parse %.2f s, build %.2f s, %.1f MB temporary files, peak RSS %.1f MB\n", stats.parseSeconds,
+           stats.buildSeconds, (double)stats.tempBytes / (1024.0 * 1024.0), peakRssMB());
+    return 0;
+}